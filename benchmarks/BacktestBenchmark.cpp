@@ -0,0 +1,87 @@
+// Backtest suite: many instrument-days replayed through their own Books on one thread, then on every core, and the speedup.
+// Usage: backtestBenchmark [days] [orders in the longest day] [threads, all if 0]
+//        backtestBenchmark -f <flow files...>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "structures/Backtest.hpp"
+#include "structures/OrderFlow.hpp"
+#include "structures/TscClock.hpp"
+
+#include "Workload.hpp"
+
+const BookConfig dayBook{.maxOrders = 2'000'000, .maxLevels = 65'536};
+
+std::vector<BacktestInput> generateDays(const int days, const int longest){
+    // Day lengths spread log-uniformly from longest / 32 to longest, so a few long days dominate as in a real universe
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> scale(std::log(1.0 / 32), 0.0);
+    std::vector<BacktestInput> inputs;
+    for (int d = 0; d < days; ++d) {
+        const auto orders = static_cast<int>(longest * std::exp(scale(rng)));
+        const std::string path = (std::filesystem::temp_directory_path() / ("backtestDay" + std::to_string(d) + ".bin")).string();
+        const WorkloadSpec spec{};
+        WorkloadGen gen(spec, 0, static_cast<unsigned>(d));
+        FlowWriter out(path);
+        for (int i = 0; i < spec.preload; ++i) {out.write(gen.preload());}
+        for (int i = 0; i < orders; ++i) {out.write(gen.next());}
+        out.close();
+        inputs.push_back({path, dayBook});
+    }
+    return inputs;
+}
+
+double report(const std::string& label, const BacktestResult& r){
+    // Prints one run, returns its wall time in seconds
+    const BookStats& t = *r.total;
+    const double wall = std::chrono::duration<double>(r.wall).count();
+    const double busy = std::chrono::duration<double>(t.busy).count();
+    const auto ns = [](const uint64_t ticks) {return static_cast<double>(ticks) * TscClock::nsPerTick();};
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << label << ": " << r.books.size() << " books on " << r.threads << " threads, " << r.steals << " stolen\n";
+    std::cout << "Wall / Busy: " << wall << " / " << busy << " s, " << busy / wall << " threads busy on average\n";
+    std::cout << "Throughput: " << static_cast<double>(t.commands) / wall << " commands/sec\n";
+    std::cout << "Apply P50 / P99 / P99.9: " << ns(t.apply.percentile(50)) << " / " << ns(t.apply.percentile(99))
+              << " / " << ns(t.apply.percentile(99.9)) << " ns\n";
+    std::cout << "Totals: " << t.commands << " commands, " << t.fills << " fills, " << t.volume << " volume, "
+              << t.unapplied << " not applied, " << t.corrupt << " corrupt, " << t.resting << " resting at the close\n\n";
+    return wall;
+}
+
+int main(const int argc, char** argv){
+    const bool files = argc > 1 && std::string(argv[1]) == "-f";
+    std::vector<BacktestInput> inputs;
+    std::size_t threads = 0;
+    try {
+        if (files) {
+            for (int i = 2; i < argc; ++i) {inputs.push_back({argv[i], dayBook});}
+        } else {
+            const int days = argc > 1 ? std::atoi(argv[1]) : 32;
+            const int longest = argc > 2 ? std::atoi(argv[2]) : 2'000'000;
+            threads = argc > 3 ? static_cast<std::size_t>(std::atoll(argv[3])) : 0;
+            inputs = generateDays(days, longest);
+        }
+
+        const double one = report("1 thread", runBacktest(inputs, 1));
+        const BacktestResult all = runBacktest(inputs, threads);
+        const double many = report(std::to_string(all.threads) + " threads", all);
+        std::cout << "Speedup: " << one / many << "x on " << all.threads << " threads ("
+                  << std::thread::hardware_concurrency() << " hardware threads)\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    if (!files) {for (const auto& in : inputs) {std::filesystem::remove(in.path);}}
+}
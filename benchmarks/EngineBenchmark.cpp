@@ -0,0 +1,96 @@
+// Multi-symbol benchmark: one ShardedEngine across many instruments, aggregate matches/sec for 1, 2, 4 and 8 shards.
+// There are as many producer threads as shards, routing through MpscQs, so routing doesn't cap the shards
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "structures/Engine.hpp"
+#include "structures/MpscQ.hpp"
+
+constexpr int numInstruments = 256;
+constexpr int numOrders = 20'000'000;     // Commands routed per run, across all instruments
+constexpr int startingLimits = 2'000;     // Limit orders per instrument before the clock starts
+
+using Engine = ShardedEngine<DefaultPolicy, MpscQ<OrderCommand,16'384>>;
+
+std::vector<InstrumentSpec> makeInstruments(){
+    // Every instrument trades around 100 on a 0.01 tick, with a wide band
+    std::vector<InstrumentSpec> specs;
+    for (int i = 0; i < numInstruments; ++i) {
+        specs.push_back({.id = static_cast<uint16_t>(i), .tickSize = 0.01, .risk = {.minPrice = 1, .maxPrice = 10'000},
+                         .book = {.maxOrders = 16'384, .maxLevels = 4'096, .initialTicks = 1'024}});
+    }
+    return specs;
+}
+
+std::vector<OrderCommand> makeOrders(const int count, const int firstID, const double limitShare){
+    // Random commands spread evenly over the instruments.
+    //Chances:
+    //  50% Sell, 50% Buy
+    //  limitShare Limit, the rest Market
+    //  Price normal around 100 (sd 0.5), quantity 1 to 100
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution coinFlip(0.5);
+    std::bernoulli_distribution isLimit(limitShare);
+    std::normal_distribution<double> price(100.0,0.5);
+    std::uniform_int_distribution<int> qty(1,100);
+    std::uniform_int_distribution<uint16_t> instrument(0,numInstruments - 1);
+
+    std::vector<OrderCommand> orders(count);
+    for (int i = 0; i < count; ++i) {
+        const Side side = coinFlip(gen) ? Side::SELL : Side::BUY;
+        const uint16_t instr = instrument(gen);
+        orders[i] = isLimit(gen) ? OrderCommand::limit(firstID + i, side, qty(gen), price(gen), instr)
+                                 : OrderCommand::market(firstID + i, side, qty(gen), instr);
+    }
+    return orders;
+}
+
+double runEngine(const std::size_t shards, const std::vector<InstrumentSpec>& specs,
+                 const std::vector<OrderCommand>& preload, const std::vector<OrderCommand>& orders){
+    // Returns matches/sec across all shards, from the first routed command until the last is handled
+
+    Engine e(specs,shards);
+    e.start();
+    for (const OrderCommand& c : preload) {while (!e.route(c)) {}}
+    while (e.processed() < preload.size()) {std::this_thread::yield();}
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::jthread> producers;
+    for (std::size_t p = 0; p < shards; ++p) {
+        producers.emplace_back([&, p] {
+            for (std::size_t i = p; i < orders.size(); i += shards) {
+                while (!e.route(orders[i])) {}
+            }
+        });
+    }
+    for (auto& t : producers) {t.join();}
+    while (e.processed() < preload.size() + orders.size()) {}
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    e.stop();
+
+    return static_cast<double>(orders.size()) * 1'000'000'000.0 / static_cast<double>(ns);
+}
+
+int main(){
+    const std::vector<InstrumentSpec> specs = makeInstruments();
+    const std::vector<OrderCommand> preload = makeOrders(numInstruments * startingLimits, 0, 1.0);
+    const std::vector<OrderCommand> orders = makeOrders(numOrders, numInstruments * startingLimits, 0.5);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << numInstruments << " instruments, " << std::thread::hardware_concurrency() << " hardware threads\n";
+    double single = 0;
+    for (const std::size_t shards : {1, 2, 4, 8}) {
+        const double throughput = runEngine(shards, specs, preload, orders);
+        if (shards == 1) {single = throughput;}
+        std::cout << shards << " shards: " << throughput / 1e6 << " M matches/sec ("
+                  << throughput / single << "x)\n";
+    }
+}
@@ -0,0 +1,33 @@
+// Writes a binary flow file from the benchmark's random order generator, for replay by bookBenchmark
+// Usage: flowGen <file> <orders> [uniform|clustered]
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "structures/OrderFlow.hpp"
+
+#include "OrderGen.hpp"
+
+int main(const int argc, char** argv){
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <file> <orders> [uniform|clustered]\n";
+        return 1;
+    }
+    const std::string path = argv[1];
+    const long long numOrders = std::atoll(argv[2]);
+    const PriceDist pd = argc > 3 && std::string(argv[3]) == "clustered" ? PriceDist::CLUSTERED : PriceDist::UNIFORM;
+
+    try {
+        // One order at a time, memory use doesn't grow with the file
+        FlowWriter out(path);
+        OrderGen gen(pd);
+        for (long long i = 0; i < numOrders; ++i) {out.write(gen.next());}
+        out.close();
+        std::cout << "Wrote " << out.written() << " orders to " << path << "\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
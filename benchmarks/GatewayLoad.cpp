@@ -0,0 +1,120 @@
+// Load generator for the gateway: phases of more and more sessions streaming WorkloadGen orders over its Unix socket.
+// Prints what each phase sent, the gateway prints the wire to match latency as each phase disconnects.
+// Usage: gatewayLoad <socket path> [orders per phase] [orders/sec per phase, 0 unpaced] [session counts...]
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "structures/Gateway.hpp"
+#include "structures/TscClock.hpp"
+#include "structures/WireProtocol.hpp"
+
+#include "Workload.hpp"
+
+constexpr int batch = 8; // Orders per write
+
+bool writeAll(const int fd, const WireOrder* msgs, const std::size_t n){
+    const auto* p = reinterpret_cast<const char*>(msgs);
+    const std::size_t bytes = n * sizeof(WireOrder);
+    for (std::size_t sent = 0; sent < bytes;) {
+        const ssize_t w = ::write(fd, p + sent, bytes - sent);
+        if (w < 0 && errno == EINTR) {continue;}
+        if (w <= 0) {return false;}
+        sent += static_cast<std::size_t>(w);
+    }
+    return true;
+}
+
+void client(const std::vector<int>& fds, const int firstID, const long long orders, const double rate){
+    // Round robin over this thread's sessions, a batch at a time. Paced to rate orders/sec if it's above 0.
+    // Each order is stamped as its batch is written, so the latency covers the socket and the gateway
+    WorkloadGen gen({}, firstID, static_cast<unsigned>(firstID));
+    WireOrder msgs[batch];
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t next = 0;
+    for (long long sent = 0; sent < orders; sent += batch) {
+        if (rate > 0) {
+            const auto due = start + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::duration<double>(static_cast<double>(sent) / rate));
+            while (std::chrono::steady_clock::now() < due) {}
+        }
+        const int n = static_cast<int>(std::min<long long>(batch, orders - sent));
+        const uint32_t stamp = TscClock::stamp();
+        for (int i = 0; i < n; ++i) {
+            OrderCommand c = gen.next();
+            c.sent = stamp;
+            msgs[i] = toWire(c);
+        }
+        if (!writeAll(fds[next], msgs, static_cast<std::size_t>(n))) {
+            throw std::runtime_error("gatewayLoad: write failed, the gateway closed a session");
+        }
+        next = next + 1 == fds.size() ? 0 : next + 1;
+    }
+}
+
+int main(const int argc, char** argv){
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket path> [orders per phase] [orders/sec, 0 unpaced] [session counts...]\n";
+        return 1;
+    }
+    const std::string path = argv[1];
+    const long long orders = argc > 2 ? std::atoll(argv[2]) : 2'000'000;
+    const double rate = argc > 3 ? std::atof(argv[3]) : 0;
+    std::vector<std::size_t> phases;
+    for (int i = 4; i < argc; ++i) {phases.push_back(static_cast<std::size_t>(std::atoll(argv[i])));}
+    if (phases.empty()) {phases = {1, 16, 256, 1'024, 4'096};}
+
+    // Half the hardware threads send, leaving the rest for the gateway and the matcher
+    const std::size_t cores = std::max(1U, std::thread::hardware_concurrency() / 2);
+    long long nextID = 1;
+    try {
+        for (const std::size_t sessions : phases) {
+            const std::size_t threads = std::min(sessions, cores);
+            std::vector<std::vector<int>> fds(threads);
+            for (std::size_t s = 0; s < sessions; ++s) {fds[s % threads].push_back(connectUnix(path));}
+
+            // Each thread's generator gets its own ID range, and each phase a fresh one, so IDs never collide
+            const long long perThread = orders / static_cast<long long>(threads) + batch;
+            if (nextID + perThread * static_cast<long long>(threads) > INT_MAX) {nextID = 1;}
+            const auto start = std::chrono::steady_clock::now();
+            // An exception can't leave a thread, so each sender's is kept and the first rethrown once they've joined
+            std::vector<std::exception_ptr> failed(threads);
+            {
+                std::vector<std::jthread> senders;
+                for (std::size_t t = 0; t < threads; ++t) {
+                    const long long share = orders / static_cast<long long>(threads)
+                                          + (t < static_cast<std::size_t>(orders % static_cast<long long>(threads)));
+                    senders.emplace_back([&, t, share] {
+                        try {
+                            client(fds[t], static_cast<int>(nextID + static_cast<long long>(t) * perThread), share,
+                                   rate / static_cast<double>(threads));
+                        } catch (...) {failed[t] = std::current_exception();}
+                    });
+                }
+            }
+            const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            nextID += perThread * static_cast<long long>(threads);
+
+            for (const auto& group : fds) {for (const int fd : group) {::close(fd);}}
+            for (const std::exception_ptr& e : failed) {if (e) {std::rethrow_exception(e);}}
+            std::cout << sessions << " sessions on " << threads << " threads: " << orders << " orders in " << secs
+                      << " s, " << static_cast<double>(orders) / secs << " orders/sec sent\n" << std::flush;
+            // Lets the gateway drain and report before the next phase connects
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,136 @@
+// Order entry gateway: serves client sessions on a Unix socket into a Book, one gateway thread and one matching thread.
+// Prints the wire to match latency of each run of sessions once the last of them disconnects (e.g. each gatewayLoad phase).
+// With a journal path, the matching thread replays the journal into the Book first, then journals every command that
+// passes the pre-trade check before applying it.
+// Usage: gateway <socket path> [gateway cpu] [match cpu] [journal path]
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+
+#include "structures/Book.hpp"
+#include "structures/Gateway.hpp"
+#include "structures/Journal.hpp"
+#include "structures/LatencyHistogram.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/PreTrade.hpp"
+#include "structures/Runtime.hpp"
+#include "structures/SpscQ.hpp"
+#include "structures/TscClock.hpp"
+
+#include "Report.hpp"
+
+using Queue = SpscQ<OrderCommand,16'384>;
+
+int main(const int argc, char** argv){
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket path> [gateway cpu] [match cpu] [journal path]\n";
+        return 1;
+    }
+    const int gatewayCpu = argc > 2 ? std::atoi(argv[2]) : -1;
+    const int matchCpu = argc > 3 ? std::atoi(argv[3]) : -1;
+    const std::string journalPath = argc > 4 ? argv[4] : "";
+
+    // Only the main thread takes SIGINT and SIGTERM, the others inherit the blocked mask
+    sigset_t quit;
+    sigemptyset(&quit);
+    sigaddset(&quit, SIGINT);
+    sigaddset(&quit, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &quit, nullptr);
+
+    const GatewayConfig cfg{.path = argv[1]};
+    auto q = std::make_unique<Queue>();
+    std::unique_ptr<Gateway<Queue>> gw;
+    std::unique_ptr<Journal> journal;
+    try {
+        if (!journalPath.empty()) {journal = std::make_unique<Journal>(journalPath);}
+        gw = std::make_unique<Gateway<Queue>>(cfg, *q);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "Listening on " << argv[1] << "\n";
+
+    std::exception_ptr failed;
+    std::jthread gateway([&](const std::stop_token st) {
+        if (gatewayCpu >= 0 && !pinCurrentThread(gatewayCpu)) {std::cerr << "Gateway thread not pinned\n";}
+        try {gw->run(st);} catch (...) {failed = std::current_exception(); std::raise(SIGTERM);}
+    });
+
+    std::jthread matcher([&](const std::stop_token st) {
+        if (matchCpu >= 0 && !pinCurrentThread(matchCpu)) {std::cerr << "Matching thread not pinned\n";}
+        // Every session's slot is a participant the book counts, and the default limits screen out what a client
+        // could send that the book can't take: prices beyond int64 ticks, non positive quantities
+        Book b({.maxOrders = 4'000'000, .maxLevels = 262'144, .maxParticipants = cfg.maxSessions});
+        const PreTradeCheck risk;
+        if (journal) {
+            const uint64_t recovered = recover(journalPath, b);
+            std::cout << "Recovered " << recovered << " commands from " << journalPath << ", " << b.size()
+                      << " resting\n" << std::flush;
+        }
+        auto latency = std::make_unique<PipelineLatency>();
+        long long rejected = 0;
+        long long unapplied = 0;
+        uint64_t seenIdle = 0;
+        int phase = 0;
+        GatewayStats before = gw->stats();
+        auto first = std::chrono::steady_clock::now();
+        auto last = first;
+
+        while (!st.stop_requested()) {
+            if (const OrderCommand* c = q->peek()) {
+                const uint64_t picked = TscClock::now();
+                if (risk.check(*c, b) != RejectReason::NONE) {rejected++;}
+                else {
+                    if (journal) {journal->append(*c);}
+                    if (!b.apply(*c)) {unapplied++;}
+                }
+                latency->record(c->sent, picked, TscClock::now());
+                q->release();
+                last = std::chrono::steady_clock::now();
+                if (latency->endToEnd.count() == 1) {first = last;}
+                continue;
+            }
+            // Idle read before the ring: every order from sessions that have ended is in it by then
+            const uint64_t idle = gw->idlePeriods();
+            if (idle == seenIdle || q->peek() != nullptr) {continue;}
+            seenIdle = idle;
+            if (latency->endToEnd.count() == 0) {continue;}
+
+            const GatewayStats now = gw->stats();
+            const uint64_t receives = now.receives - before.receives;
+            const uint64_t syscalls = now.syscalls - before.syscalls;
+            printLatency("Run " + std::to_string(++phase) + ": " + std::to_string(now.accepted - before.accepted)
+                         + " sessions", *latency, last - first);
+            std::cout << "Gateway: " << now.messages - before.messages << " orders in " << receives << " receives and "
+                      << syscalls << " io_uring_enter calls, " << now.malformed - before.malformed << " malformed, "
+                      << now.refused - before.refused << " sessions refused\n";
+            std::cout << "Book: " << b.size() << " resting, " << rejected << " rejected pre-trade, " << unapplied
+                      << " not applied\n\n" << std::flush;
+            latency = std::make_unique<PipelineLatency>();
+            rejected = 0;
+            unapplied = 0;
+            before = now;
+        }
+    });
+
+    int sig = 0;
+    sigwait(&quit, &sig);
+    gateway.request_stop();
+    matcher.request_stop();
+    gateway.join();
+    matcher.join();
+    if (failed) {
+        try {std::rethrow_exception(failed);} catch (const std::runtime_error& e) {std::cerr << e.what() << "\n";}
+        return 1;
+    }
+}
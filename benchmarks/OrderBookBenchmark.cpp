@@ -1,28 +1,37 @@
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <chrono>
+#include <cstdio>
+#include <filesystem>
 #include <random>
+#include <span>
+#include <string>
 #include <thread>
 
 #include "structures/Book.hpp"
 #include "structures/Order.hpp"
+#include "structures/OrderCommand.hpp"
 #include "structures/SpscQ.hpp"
-
-int getRandInt(std::mt19937& gen, const int topBound){
-    // Gets a random integer from up to topBound
-
-    //Range of prices
-    std::uniform_int_distribution<int> dist(1,topBound);
-    return dist(gen);
-}
-
-
-void addLimits(Book& b, const int numOrders){
+#include "structures/MpscQ.hpp"
+#include "structures/FanInQ.hpp"
+#include "structures/OrderFlow.hpp"
+#include "structures/Journal.hpp"
+#include "structures/PreTrade.hpp"
+#include "structures/LatencyHistogram.hpp"
+#include "structures/TscClock.hpp"
+
+#include "OrderGen.hpp"
+#include "Report.hpp"
+
+void addLimits(Book& b, const int numOrders, const PriceDist pd){
     // Adds numOrders many Limit Orders to Book (b).
     // These limit orders are randomly generated.
     //Chances:
     //  50% Sell, 50% Buy
-    //  1 to 1M on Price (Uniform distribution)
+    //  Price from pd
     //  1 to 1M on Quantity (Uniform Distribution)
 
     //Generate random key
@@ -34,7 +43,7 @@ void addLimits(Book& b, const int numOrders){
 
     for (int i = 0;i<numOrders;i++){
 
-        const int randInt = getRandInt(gen,1'000'000);
+        const double randPrc = getRandPrice(gen,pd);
         const int randQty = getRandInt(gen,1'000'000);
 
         //Decide  if order is sell or buy
@@ -42,102 +51,248 @@ void addLimits(Book& b, const int numOrders){
         if (coinFlip(gen)){side = Side::SELL;}
         else {side  = Side::BUY;}
 
-        Order o = {i,side,OrderType::LIMIT,randQty,static_cast<double>(randInt)};
+        Order o = {i,side,OrderType::LIMIT,randQty,randPrc};
         b.addOrder(o);
     }
 }
 
-std::vector<Order> makeOrders(const int numOrders){
-    // Adds numOrders many Orders to a vector, which returned
-    // These orders are randomly generated.
-    //Chances:
-    //  50% Sell, 50% Buy
-    //  50% Limit, 50% Market
-    //  1 to 1M on Price (Uniform distribution)
-    //  1 to 1M on Quantity (Uniform Distribution)
+std::vector<OrderCommand> makeOrders(const int numOrders, const PriceDist pd){
+    // Adds numOrders many order commands to a vector, which returned
+    // These orders are randomly generated by OrderGen
 
-    //Generate random key
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    OrderGen gen(pd);
+    std::vector<OrderCommand> randOrders(numOrders);
+    for (int i = 0;i<numOrders;i++) {randOrders[i] = gen.next();}
+    return randOrders;
+}
 
-    std::bernoulli_distribution coinFlip(0.5);
+constexpr std::size_t maxBatch = 64; // Most commands the consumer takes off the ring at once
 
-    std::vector<Order> randOrders(numOrders);
+void runBenchmark(const PriceDist pd){
+    // Runs the producer/consumer pipeline end to end with prices drawn from pd, and prints the stats
+    constexpr int numOrders = 100'000'000; // Total number of orders to execute
+    constexpr int startingLimits = 1'000'000; //Initial number of Limit orders in the book
 
-    for (int i = 0;i<numOrders;i++) {
-        Side side;
-        OrderType ot;
-        int randQty = getRandInt(gen,1'000'000);
+    //Put some initial limit orders in the book, some of these will instantly cross the book
+    // Book storage is sized up front, no allocation while matching
+    Book b({.maxOrders = 2'000'000, .maxLevels = 1'000'000});
+    addLimits(b,startingLimits,pd);
 
-        //Pick order type
-        if (coinFlip(gen)){ot = OrderType::LIMIT;}
-        else {ot = OrderType::MARKET;}
+    //Make a vector of orders to be added
+    const std::vector<OrderCommand> orders = makeOrders(numOrders,pd);
 
-        //Pick side of Order
-        if (coinFlip(gen)){side = Side::SELL;}
-        else {side  = Side::BUY;}
+    //Setup SpscQ buffer, orders travel as 32 byte commands written and read in place
+    constexpr int buffSize = 16'384;
+    SpscQ<OrderCommand,buffSize> sq;
+
+    // Latency goes into fixed size histograms rather than per order time stamps
+    auto latency = std::make_unique<PipelineLatency>();
 
-        //If it's Limit it needs a price, if it's market it's just quantity
-        Order o;
-        if (ot == OrderType::LIMIT) {
-            auto prc = static_cast<double>(getRandInt(gen,1'000'000));
-            o = {i,side,ot,randQty,prc};
-        }else {
-            o = {i,side,ot,randQty};
+    const auto startBench = std::chrono::high_resolution_clock::now();
+    //Producer thread
+    std::jthread producer([&] {
+        for (int i = 0;i<numOrders;i++) {
+            OrderCommand* slot = sq.claim_wait();
+            *slot = orders[i];
+            slot->sent = TscClock::stamp();
+            sq.commit();
         }
+    });
 
-        randOrders[i] = o;
-    }
+    //Consumer thread, drains the ring in batches read in place
+    long long rejected = 0; // Limit orders that couldn't rest because the book was full. Only consumer accesses
+    std::jthread consumer([&] {
+        for (int received = 0; received < numOrders;) {
+            const std::span<const OrderCommand> batch = sq.peek_n_wait(maxBatch);
+            const uint64_t picked = TscClock::now();
+            b.apply(batch, [&](const OrderCommand& c, const bool applied) {
+                if (!applied) {rejected++;}
+                latency->record(c.sent, picked, TscClock::now());
+            });
+            sq.release_n(batch.size());
+            received += static_cast<int>(batch.size());
+        }
+    });
 
-    return randOrders;
-}
+    producer.join();
+    consumer.join();
+    const auto endBench = std::chrono::high_resolution_clock::now();
 
-int main(){
-    constexpr int numOrders = 100'000'000; // Total number of orders to execute
-    constexpr int startingLimits = 1'000'000; //Initial number of Limit orders in the book
+    printLatency(pd == PriceDist::UNIFORM ? "Uniform prices" : "Clustered prices", *latency, endBench - startBench);
+    std::cout << "Rejected (book full): " << rejected << "\n";
 
-    //Put some initial limit orders in the book, some of these will instantly cross the book
-    Book b;
-    addLimits(b,startingLimits);
+}
 
-    //Make a vector of orders to be added
-    const std::vector<Order> orders = makeOrders(numOrders);
+enum class Drain{
+    // How the matching thread takes commands off the ring
+    SINGLE, // peek, apply, release, one command at a time
+    BATCH   // peek_n up to maxBatch, Book::apply on the batch with prefetching, release_n
+};
+
+void runBurstBenchmark(const Drain drain){
+    // Orders arrive in bursts of burstSize back to back with a quiet gap between them, clustered prices.
+    // A batch's commands count as picked up when the batch is, so its queue wait and Book time include the
+    // commands ahead of it in the batch, end to end is comparable between the two drains
+    constexpr int numOrders = 10'000'000;
+    constexpr int startingLimits = 1'000'000;
+    constexpr int burstSize = 1'000;
+    const auto gap = static_cast<uint64_t>(50'000 / TscClock::nsPerTick()); // 50us
+
+    Book b({.maxOrders = 2'000'000, .maxLevels = 1'000'000});
+    addLimits(b,startingLimits,PriceDist::CLUSTERED);
+    const std::vector<OrderCommand> orders = makeOrders(numOrders,PriceDist::CLUSTERED);
 
-    //Setup SpscQ buffer
     constexpr int buffSize = 16'384;
-    SpscQ<Order,buffSize> sq;
+    auto sq = std::make_unique<SpscQ<OrderCommand,buffSize>>();
+    auto latency = std::make_unique<PipelineLatency>(); // Only consumer records
 
-    //Init the Vector to store Benchmark times, by id.
-    // 0 Represents the Order was not executed
-    // Vector rather than array due to being too big to go in cache
-    using Clock = std::chrono::time_point<std::chrono::high_resolution_clock>;
-    std::vector<Clock> startTimes(numOrders); //Only producer accesses
-    std::vector<Clock> endTimes(numOrders); // Only consumer accesses
-    std::vector<long long> matchTimes(numOrders);
+    const auto startBench = std::chrono::high_resolution_clock::now();
+    std::jthread producer([&] {
+        for (int i = 0; i < numOrders; i++) {
+            if (i % burstSize == 0) {
+                const uint64_t until = TscClock::now() + gap;
+                while (TscClock::now() < until) {}
+            }
+            OrderCommand* slot = sq->claim_wait();
+            *slot = orders[i];
+            slot->sent = TscClock::stamp();
+            sq->commit();
+        }
+    });
 
+    std::jthread consumer([&] {
+        for (int received = 0; received < numOrders;) {
+            if (drain == Drain::SINGLE) {
+                if (const OrderCommand* c = sq->peek()) {
+                    const uint64_t picked = TscClock::now();
+                    b.apply(*c);
+                    latency->record(c->sent, picked, TscClock::now());
+                    sq->release();
+                    ++received;
+                }
+            } else {
+                const std::span<const OrderCommand> batch = sq->peek_n_wait(maxBatch);
+                const uint64_t picked = TscClock::now();
+                b.apply(batch, [&](const OrderCommand& c, bool) {latency->record(c.sent, picked, TscClock::now());});
+                sq->release_n(batch.size());
+                received += static_cast<int>(batch.size());
+            }
+        }
+    });
 
-    const Clock startBench = std::chrono::high_resolution_clock::now();
-    //Producer thread
+    producer.join();
+    consumer.join();
+    const auto endBench = std::chrono::high_resolution_clock::now();
+
+    // Throughput is over wall time, gaps included, so it's only comparable between the two drains
+    printLatency(drain == Drain::SINGLE ? "Bursts, one command at a time" : "Bursts, batched drain with prefetch",
+                 *latency, endBench - startBench);
+}
+
+enum class Ingest{
+    // How several gateway threads reach the one matching thread
+    MPSC,  // One shared MpscQ
+    FAN_IN // One SpscQ per gateway, polled round robin
+};
+
+template<std::size_t Producers>
+void runGatewayBenchmark(const Ingest ingest){
+    // Runs the pipeline with several producer (gateway) threads and one consumer (matcher), clustered prices.
+    // Producer p sends every order whose index is p mod Producers
+    constexpr int numOrders = 10'000'000;
+    constexpr int startingLimits = 1'000'000;
+    constexpr std::size_t buffSize = 16'384; // Total ring space, split across the rings for fan-in
+
+    Book b({.maxOrders = 2'000'000, .maxLevels = 1'000'000});
+    addLimits(b,startingLimits,PriceDist::CLUSTERED);
+    const std::vector<OrderCommand> orders = makeOrders(numOrders,PriceDist::CLUSTERED);
+
+    // Rings are too big for the stack
+    auto mpsc = std::make_unique<MpscQ<OrderCommand,buffSize>>();
+    auto fanIn = std::make_unique<FanInQ<OrderCommand,buffSize / Producers,Producers>>();
+
+    auto latency = std::make_unique<PipelineLatency>(); // Only consumer records
+    const auto startBench = std::chrono::high_resolution_clock::now();
+    std::vector<std::jthread> producers;
+    for (std::size_t p = 0; p < Producers; ++p) {
+        producers.emplace_back([&, p] {
+            for (auto i = static_cast<int>(p); i < numOrders; i += static_cast<int>(Producers)) {
+                OrderCommand c = orders[i];
+                c.sent = TscClock::stamp();
+                if (ingest == Ingest::MPSC) {while (!mpsc->push(c)) {}}
+                else {while (!fanIn->push(p,c)) {}}
+            }
+        });
+    }
+
+    std::jthread consumer([&] {
+        for (int received = 0; received < numOrders;) {
+            auto c = ingest == Ingest::MPSC ? mpsc->pop() : fanIn->pop();
+            if (c.has_value()) {
+                const uint64_t picked = TscClock::now();
+                b.apply(*c);
+                latency->record(c->sent, picked, TscClock::now());
+                ++received;
+            }
+        }
+    });
+
+    for (auto& t : producers) {t.join();}
+    consumer.join();
+    const auto endBench = std::chrono::high_resolution_clock::now();
+
+    printLatency(std::string(ingest == Ingest::MPSC ? "MpscQ, " : "FanInQ, ") + std::to_string(Producers) + " producers",
+                 *latency, endBench - startBench);
+}
+
+enum class Journaling{
+    OFF,        // No journal
+    PAGE_CACHE, // Journal written by the background thread, no fdatasync
+    SYNC        // Journal written and fdatasync'd in groups
+};
+
+void runJournalBenchmark(const Journaling mode){
+    // End to end latency of the clustered pipeline with the consumer journaling every command that passes the
+    // pre-trade check before applying it
+    constexpr int numOrders = 10'000'000;
+    constexpr int startingLimits = 1'000'000;
+
+    Book b({.maxOrders = 2'000'000, .maxLevels = 1'000'000});
+    addLimits(b,startingLimits,PriceDist::CLUSTERED);
+    const std::vector<OrderCommand> orders = makeOrders(numOrders,PriceDist::CLUSTERED);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "bookBenchmark.journal").string();
+    std::remove(path.c_str());
+    const PreTradeCheck risk;
+    std::unique_ptr<Journal> journal;
+    if (mode != Journaling::OFF) {journal = std::make_unique<Journal>(path, mode == Journaling::SYNC);}
+
+    constexpr int buffSize = 16'384;
+    auto sq = std::make_unique<SpscQ<OrderCommand,buffSize>>();
+    auto latency = std::make_unique<PipelineLatency>(); // Only consumer records
+
+    const auto startBench = std::chrono::high_resolution_clock::now();
     std::jthread producer([&] {
-        for (int i = 0;i<numOrders;i++) {
-            while (!sq.push(orders[i])){}
-            const Clock insertTime = std::chrono::high_resolution_clock::now();
-            startTimes[i] = insertTime;
+        for (int i = 0; i < numOrders; i++) {
+            OrderCommand* slot = sq->claim_wait();
+            *slot = orders[i];
+            slot->sent = TscClock::stamp();
+            sq->commit();
         }
     });
 
-    //Consumer thread
     std::jthread consumer([&] {
-        int count = 0;
-        constexpr int maxSpinAttempts = 1'000;
-        while (count < maxSpinAttempts) {
-            auto popped = sq.pop();
-            if (popped.has_value()) {
-                count = 0;
-                Order o = popped.value();
-                b.addOrder(o);
-                endTimes[o.getID()] = std::chrono::high_resolution_clock::now();
-            }else{count++;}
+        for (int received = 0; received < numOrders;) {
+            if (const OrderCommand* c = sq->peek()) {
+                const uint64_t picked = TscClock::now();
+                if (risk.check(*c, b) == RejectReason::NONE) {
+                    if (journal) {journal->append(*c);}
+                    b.apply(*c);
+                }
+                latency->record(c->sent, picked, TscClock::now());
+                sq->release();
+                ++received;
+            }
         }
     });
 
@@ -145,42 +300,106 @@ int main(){
     consumer.join();
     const auto endBench = std::chrono::high_resolution_clock::now();
 
-    // Calculate latencies
-    for (int i = 0;i<numOrders;i++) {
-        if (endTimes[i] == Clock{}) {
-            continue;
-        }
-        matchTimes[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(endTimes[i] - startTimes[i]).count();
+    const char* labels[] = {"Journal off", "Journal on, page cache only", "Journal on, group fdatasync"};
+    printLatency(labels[static_cast<int>(mode)], *latency, endBench - startBench);
+
+    if (journal) {
+        journal->flush();
+        journal.reset();
+        std::remove(path.c_str());
     }
+}
+
+void runReplay(const std::string& path){
+    // Replays a flow file (see flowGen) through the ring into one Book.
+    // The producer decodes records from the mapping straight into ring slots, so memory use doesn't depend on the file
+    const FlowReader flow(path);
+    const uint64_t numOrders = flow.size();
 
-    // Calculate Performance statistics
+    Book b({.maxOrders = 2'000'000, .maxLevels = 1'000'000});
+    constexpr int buffSize = 16'384;
+    auto sq = std::make_unique<SpscQ<OrderCommand,buffSize>>();
+
+    const auto startBench = std::chrono::high_resolution_clock::now();
+    std::jthread producer([&] {flow.replay(*sq);});
 
-    // Calculate Average
-    long long total = 0;
-    size_t matchedCount = 0;
-    for (const auto& t : matchTimes) {
-        if (t != 0) {
-            total += t;
-            matchedCount++;
+    long long rejected = 0;
+    std::jthread consumer([&] {
+        for (uint64_t received = 0; received < numOrders;) {
+            if (const OrderCommand* c = sq->peek()) {
+                if (!b.apply(*c)) {rejected++;}
+                sq->release();
+                ++received;
+            }
         }
+    });
+
+    producer.join();
+    consumer.join();
+    const auto totalBenchmarkNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - startBench).count();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Replayed " << numOrders << " orders from " << path << "\n";
+    std::cout << "Throughput: " << static_cast<double>(numOrders) * 1'000'000'000.0 / static_cast<double>(totalBenchmarkNs)
+              << " matches/sec\n";
+    std::cout << "Rejected: " << rejected << "\n";
+}
+
+void runSweepBenchmark(const int levels, const int ordersPerLevel){
+    // Matching thread only: a market order that clears every level of the book, timed on its own. The same Book is
+    // refilled for each run so its storage stays warm and the time is the matching work rather than cold misses.
+    // Prints the median sweep and what that is per level and per resting order filled
+    constexpr int reps = 1'001;
+    std::vector<uint64_t> ticks;
+    ticks.reserve(reps);
+
+    Book b({.maxOrders = 65'536, .maxLevels = 4'096});
+    for (int r = 0; r < reps; ++r) {
+        int id = 0;
+        for (int l = 0; l < levels; ++l) {
+            for (int k = 0; k < ordersPerLevel; ++k) {b.apply(OrderCommand::limit(id++,Side::SELL,100,100.0 + 0.05 * l));}
+        }
+        const OrderCommand sweep = OrderCommand::market(id,Side::BUY,100 * levels * ordersPerLevel);
+        const uint64_t start = TscClock::now();
+        b.apply(sweep);
+        ticks.push_back(TscClock::now() - start);
     }
-    const double averageNs = static_cast<double>(total) /
-                             (static_cast<double>(matchedCount) * 1'000);
 
+    std::nth_element(ticks.begin(), ticks.begin() + reps / 2, ticks.end());
+    const double ns = TscClock::toNs(ticks[reps / 2]);
+    std::cout << std::fixed << std::setprecision(1) << "Sweep of " << levels << " levels x " << ordersPerLevel
+              << " orders: " << ns / 1'000 << " μs, " << ns / levels << " ns per level, "
+              << ns / (levels * ordersPerLevel) << " ns per order\n";
+}
 
-    // Calculate P99
-    std::sort(matchTimes.begin(), matchTimes.end());
-    const double p99Ns = static_cast<double>(matchTimes[static_cast<size_t>(0.99 * static_cast<double>(matchTimes.size()))]) /
-                    1'000;
+int main(const int argc, char** argv){
+    // With a flow file argument, replay it instead of generating orders
+    if (argc > 1) {
+        runReplay(argv[1]);
+        return 0;
+    }
 
-    // Throughput - matches per second
-    const auto totalBenchmarkNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endBench - startBench).count();
-    const double throughput = static_cast<double>(matchTimes.size()) * 1'000'000'000.0 / static_cast<double>(totalBenchmarkNs);
+    runBenchmark(PriceDist::UNIFORM);
+    runBenchmark(PriceDist::CLUSTERED);
 
-    // Print without scientific notation
-    std::cout << std::fixed << std::setprecision(2); // control number formatting
-    std::cout << "Average Match Latency: " << averageNs << " μs\n";
-    std::cout << "P99 Match Latency: " << p99Ns << " μs\n";
-    std::cout << "Throughput: " << throughput << " matches/sec\n";
+    // Single vs batched drain under bursts
+    runBurstBenchmark(Drain::SINGLE);
+    runBurstBenchmark(Drain::BATCH);
 
-}
\ No newline at end of file
+    // Large aggressive orders, cost against levels cleared
+    for (const int levels : {1, 4, 16, 64, 256}) {runSweepBenchmark(levels,10);}
+    runSweepBenchmark(64,1);
+
+    // Gateway scaling
+    for (const Ingest ingest : {Ingest::MPSC, Ingest::FAN_IN}) {
+        runGatewayBenchmark<2>(ingest);
+        runGatewayBenchmark<4>(ingest);
+        runGatewayBenchmark<8>(ingest);
+    }
+
+    // Journaling cost
+    for (const Journaling mode : {Journaling::OFF, Journaling::PAGE_CACHE, Journaling::SYNC}) {
+        runJournalBenchmark(mode);
+    }
+}
@@ -0,0 +1,58 @@
+// Random order generators shared by the benchmarks and the flow file converter
+
+#pragma once
+
+#include <algorithm>
+#include <random>
+
+#include "structures/OrderCommand.hpp"
+
+enum class PriceDist{
+    // How limit prices are drawn
+    UNIFORM,   // 1 to 1M, a sparse book with levels everywhere
+    CLUSTERED  // Normal around 1,000 (sd 5), a dense book near the touch
+};
+
+inline int getRandInt(std::mt19937& gen, const int topBound){
+    // Gets a random integer from up to topBound
+
+    //Range of prices
+    std::uniform_int_distribution<int> dist(1,topBound);
+    return dist(gen);
+}
+
+inline double getRandPrice(std::mt19937& gen, const PriceDist pd){
+    // Gets a random limit price from the chosen distribution
+    if (pd == PriceDist::CLUSTERED){
+        std::normal_distribution<double> dist(1'000.0,5.0);
+        return std::max(dist(gen),0.05);
+    }
+    return static_cast<double>(getRandInt(gen,1'000'000));
+}
+
+class OrderGen{
+// Streams random order commands one at a time, so a file of any length can be written in constant memory
+//Chances:
+//  50% Sell, 50% Buy
+//  50% Limit, 50% Market
+//  Price from pd
+//  1 to 1M on Quantity (Uniform Distribution)
+    std::mt19937 gen;
+    std::bernoulli_distribution coinFlip{0.5};
+    PriceDist pd;
+    int nextID;
+
+public:
+    explicit OrderGen(const PriceDist dist, const int firstID = 0, const unsigned seed = std::random_device{}())
+        : gen(seed), pd(dist), nextID(firstID) {}
+
+    OrderCommand next(){
+        const int randQty = getRandInt(gen,1'000'000);
+
+        //Pick order type then side, if it's Limit it needs a price, if it's market it's just quantity
+        const bool limit = coinFlip(gen);
+        const Side side = coinFlip(gen) ? Side::SELL : Side::BUY;
+        if (limit) {return OrderCommand::limit(nextID++,side,randQty,getRandPrice(gen,pd));}
+        return OrderCommand::market(nextID++,side,randQty);
+    }
+};
@@ -0,0 +1,27 @@
+// Result printing shared by the benchmarks
+
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "structures/LatencyHistogram.hpp"
+#include "structures/TscClock.hpp"
+
+inline void printLatency(const std::string& label, const PipelineLatency& latency, const std::chrono::nanoseconds elapsed){
+    // Prints the end to end latency distribution with its queue wait and Book parts, and throughput over elapsed
+    const auto us = [](const double ticks) {return ticks * TscClock::nsPerTick() / 1'000;};
+    const LatencyHistogram& e2e = latency.endToEnd;
+    const double throughput = static_cast<double>(e2e.count()) * 1'000'000'000.0 / static_cast<double>(elapsed.count());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << label << "\n";
+    std::cout << "Average Match Latency: " << us(e2e.mean()) << " μs\n";
+    std::cout << "P99 Match Latency: " << us(e2e.percentile(99)) << " μs\n";
+    std::cout << "P99.9 Match Latency: " << us(e2e.percentile(99.9)) << " μs\n";
+    std::cout << "P99 Queue Wait / Book: " << us(latency.queueWait.percentile(99)) << " / "
+              << us(latency.book.percentile(99)) << " μs\n";
+    std::cout << "Throughput: " << throughput << " matches/sec\n";
+}
@@ -0,0 +1,121 @@
+// Ring-only benchmark: SpscQ throughput with no matching behind it,
+// one order per push/pop versus batches through push_n/pop_n, and OrderCommands written and read in place
+
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <thread>
+
+#include "structures/Order.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/SpscQ.hpp"
+
+constexpr int numOrders = 20'000'000;  // Orders pushed through the ring per run
+constexpr int buffSize = 16'384;       // Same ring size as bookBenchmark
+
+using Queue = SpscQ<Order,buffSize>;
+using CommandQueue = SpscQ<OrderCommand,buffSize>;
+
+double runSingle(Queue& sq){
+    // One order per push and per pop. Returns orders/sec
+
+    const auto start = std::chrono::steady_clock::now();
+    std::jthread producer([&] {
+        Order o(0,Side::BUY,OrderType::LIMIT,10,5.0);
+        for (int i = 0; i < numOrders; ++i) {
+            while (!sq.push(o)) {}
+        }
+    });
+    std::jthread consumer([&] {
+        long long qty = 0;
+        for (int i = 0; i < numOrders;) {
+            if (auto popped = sq.pop()) {
+                qty += popped->getUnexecQty();
+                ++i;
+            }
+        }
+        if (qty != 10LL * numOrders) {std::cerr << "Lost orders\n";}
+    });
+    producer.join();
+    consumer.join();
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(numOrders) * 1'000'000'000.0 / static_cast<double>(ns);
+}
+
+template<std::size_t Batch>
+double runBatch(Queue& sq){
+    // Batch orders per push_n and pop_n. Returns orders/sec
+
+    const auto start = std::chrono::steady_clock::now();
+    std::jthread producer([&] {
+        std::array<Order,Batch> batch;
+        batch.fill(Order(0,Side::BUY,OrderType::LIMIT,10,5.0));
+        for (int i = 0; i < numOrders;) {
+            const auto want = std::min<std::size_t>(Batch, static_cast<std::size_t>(numOrders - i));
+            i += static_cast<int>(sq.push_n(std::span<const Order>(batch.data(), want)));
+        }
+    });
+    std::jthread consumer([&] {
+        std::array<Order,Batch> out;
+        long long qty = 0;
+        for (int i = 0; i < numOrders;) {
+            const auto got = sq.pop_n(out);
+            for (std::size_t j = 0; j < got; ++j) {qty += out[j].getUnexecQty();}
+            i += static_cast<int>(got);
+        }
+        if (qty != 10LL * numOrders) {std::cerr << "Lost orders\n";}
+    });
+    producer.join();
+    consumer.join();
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(numOrders) * 1'000'000'000.0 / static_cast<double>(ns);
+}
+
+double runInPlace(CommandQueue& sq){
+    // One OrderCommand per claim/commit and per peek/release, no copies through temporaries. Returns orders/sec
+
+    const auto start = std::chrono::steady_clock::now();
+    std::jthread producer([&] {
+        for (int i = 0; i < numOrders; ++i) {
+            OrderCommand* slot = nullptr;
+            while ((slot = sq.claim()) == nullptr) {}
+            *slot = OrderCommand::limit(i,Side::BUY,10,5.0);
+            sq.commit();
+        }
+    });
+    std::jthread consumer([&] {
+        long long qty = 0;
+        for (int i = 0; i < numOrders;) {
+            if (const OrderCommand* c = sq.peek()) {
+                qty += c->qty;
+                sq.release();
+                ++i;
+            }
+        }
+        if (qty != 10LL * numOrders) {std::cerr << "Lost orders\n";}
+    });
+    producer.join();
+    consumer.join();
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(numOrders) * 1'000'000'000.0 / static_cast<double>(ns);
+}
+
+int main(){
+    // Ring is too big for the stack
+    auto sq = std::make_unique<Queue>();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Single push/pop: " << runSingle(*sq) / 1e6 << " M orders/sec\n";
+    std::cout << "Batch of 8:      " << runBatch<8>(*sq) / 1e6 << " M orders/sec\n";
+    std::cout << "Batch of 32:     " << runBatch<32>(*sq) / 1e6 << " M orders/sec\n";
+    std::cout << "Batch of 128:    " << runBatch<128>(*sq) / 1e6 << " M orders/sec\n";
+
+    auto cq = std::make_unique<CommandQueue>();
+    std::cout << "In place command: " << runInPlace(*cq) / 1e6 << " M orders/sec\n";
+}
@@ -0,0 +1,96 @@
+// Placement suite: the pipeline with its threads left to the scheduler on 4K pages, against pinned threads with the
+// ring and Book on the matching thread's node and huge pages. Latency plus TLB misses, migrations and context switches.
+// Usage: runtimeBenchmark [ingest cpu] [match cpu] [orders]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "structures/Book.hpp"
+#include "structures/LatencyHistogram.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/PerfCounters.hpp"
+#include "structures/Runtime.hpp"
+#include "structures/TscClock.hpp"
+
+#include "Report.hpp"
+#include "Workload.hpp"
+
+constexpr std::size_t maxBatch = 64;
+
+void printCounters(const char* thread, const CounterValues& v){
+    const auto show = [](const int64_t n) {return n < 0 ? std::string("n/a") : std::to_string(n);};
+    std::cout << thread << " dTLB misses / migrations / context switches: " << show(v.dtlbMisses) << " / "
+              << show(v.migrations) << " / " << show(v.contextSwitches) << "\n";
+}
+
+void runPlacement(const char* label, const RuntimeConfig& cfg, const int numOrders){
+    // Bursts of 1000 commands 50us apart, drained in batches. The book is preloaded on the matching thread first
+
+    constexpr int burstSize = 1'000;
+    const auto gap = static_cast<uint64_t>(50'000 / TscClock::nsPerTick());
+    const WorkloadSpec spec{.depth = 2'000, .zipf = 0.6, .preload = 500'000};
+
+    WorkloadGen gen(spec);
+    std::vector<OrderCommand> preload(static_cast<std::size_t>(spec.preload));
+    for (auto& c : preload) {c = gen.preload();}
+    std::vector<OrderCommand> orders(static_cast<std::size_t>(numOrders));
+    for (auto& c : orders) {c = gen.next();}
+
+    PipelineRuntime rt(cfg);
+    auto latency = std::make_unique<PipelineLatency>(); // Only the matching thread records
+    std::atomic<bool> preloaded = false;
+
+    auto startBench = std::chrono::steady_clock::now();
+    const RuntimeReport report = rt.run(
+        [&](auto& q) {
+            while (!preloaded.load(std::memory_order_acquire)) {std::this_thread::yield();}
+            startBench = std::chrono::steady_clock::now();
+            for (int i = 0; i < numOrders; ++i) {
+                if (i % burstSize == 0) {
+                    const uint64_t until = TscClock::now() + gap;
+                    while (TscClock::now() < until) {}
+                }
+                OrderCommand* slot = q.claim_wait();
+                *slot = orders[static_cast<std::size_t>(i)];
+                slot->sent = TscClock::stamp();
+                q.commit();
+            }
+        },
+        [&](auto& q, Book& b) {
+            for (const OrderCommand& c : preload) {b.apply(c);}
+            preloaded.store(true, std::memory_order_release);
+            for (int received = 0; received < numOrders;) {
+                const auto batch = q.peek_n_wait(maxBatch);
+                const uint64_t picked = TscClock::now();
+                b.apply(batch, [&](const OrderCommand& c, bool) {latency->record(c.sent, picked, TscClock::now());});
+                q.release_n(batch.size());
+                received += static_cast<int>(batch.size());
+            }
+        });
+    const auto endBench = std::chrono::steady_clock::now();
+
+    printLatency(label, *latency, endBench - startBench);
+    std::cout << "Pinned ingest / match: " << (report.ingestPinned ? "yes" : "no") << " / "
+              << (report.matchPinned ? "yes" : "no") << ", node " << report.matchNode
+              << ", ring on " << toString(report.ringPages) << " pages\n";
+    printCounters("Ingest", report.ingest);
+    printCounters("Match ", report.match);
+    std::cout << "\n";
+}
+
+int main(const int argc, char** argv){
+    const auto cpus = static_cast<int>(std::thread::hardware_concurrency());
+    const int ingestCpu = argc > 1 ? std::atoi(argv[1]) : 0;
+    const int matchCpu = argc > 2 ? std::atoi(argv[2]) : (cpus > 1 ? 1 : 0);
+    const int numOrders = argc > 3 ? std::atoi(argv[3]) : 5'000'000;
+    const BookConfig book{.maxOrders = 4'000'000, .maxLevels = 262'144};
+
+    runPlacement("Scheduler placed, 4K pages", {.hugePages = false, .book = book}, numOrders);
+    runPlacement("Pinned, node local, huge pages",
+                 {.ingestCpu = ingestCpu, .matchCpu = matchCpu, .hugePages = true, .book = book}, numOrders);
+}
@@ -0,0 +1,117 @@
+// Cross-process suite: the producer in another process feeding the matching process through a SharedSpscQ,
+// against the same queue with the producer as a thread, latency under paced bursts for spinning and sleeping waits.
+// Usage: sharedQBenchmark [bursts per second] [orders per burst] [seconds per run]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "structures/Book.hpp"
+#include "structures/LatencyHistogram.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/SharedQ.hpp"
+#include "structures/TscClock.hpp"
+#include "structures/WaitStrategy.hpp"
+
+#include "Report.hpp"
+#include "Workload.hpp"
+
+constexpr std::size_t buffSize = 16'384;
+constexpr std::size_t maxBatch = 64;
+
+struct Pacing{
+    int burstsPerSec;
+    int burst;
+    int seconds;
+};
+
+template<typename Wait>
+void produce(const std::string& name, const std::vector<OrderCommand>& orders, const Pacing& p){
+    // Attaches as the producer and sends a burst, then sleeps to the next burst's start
+    SharedSpscQ<OrderCommand,buffSize,Wait> shared(name, SharedRole::PRODUCER);
+    auto& sq = shared.queue();
+    const std::chrono::nanoseconds gap(1'000'000'000 / p.burstsPerSec);
+    auto due = std::chrono::steady_clock::now();
+    for (std::size_t sent = 0; sent < orders.size();) {
+        std::this_thread::sleep_until(due);
+        due += gap;
+        for (int i = 0; i < p.burst && sent < orders.size(); ++i, ++sent) {
+            OrderCommand* slot = sq.claim_wait();
+            *slot = orders[sent];
+            slot->sent = TscClock::stamp();
+            sq.commit();
+        }
+    }
+}
+
+template<typename Wait>
+void runShared(const char* label, const Pacing& p, const bool otherProcess){
+    // The consumer attaches first, creating the segment, then the producer attaches from a child process or a thread
+
+    WorkloadGen gen({});
+    Book b({.maxOrders = 4'000'000, .maxLevels = 262'144});
+    for (int i = 0; i < WorkloadSpec{}.preload; ++i) {b.apply(gen.preload());}
+    std::vector<OrderCommand> orders(static_cast<std::size_t>(p.burstsPerSec * p.burst * p.seconds));
+    for (auto& c : orders) {c = gen.next();}
+
+    const std::string name = "sharedQBenchmark" + std::to_string(::getpid());
+    SharedSpscQ<OrderCommand,buffSize,Wait> shared(name, SharedRole::CONSUMER);
+    auto& sq = shared.queue();
+    auto latency = std::make_unique<PipelineLatency>();
+
+    const auto startBench = std::chrono::steady_clock::now();
+    pid_t child = -1;
+    std::jthread producer;
+    if (otherProcess) {
+        if ((child = ::fork()) < 0) {throw std::runtime_error("sharedQBenchmark: fork failed");}
+        if (child == 0) {
+            produce<Wait>(name, orders, p);
+            ::_exit(0);
+        }
+    } else {
+        producer = std::jthread([&] {produce<Wait>(name, orders, p);});
+    }
+
+    for (std::size_t received = 0; received < orders.size();) {
+        const auto batch = sq.peek_n_wait(maxBatch);
+        const uint64_t picked = TscClock::now();
+        for (const OrderCommand& c : batch) {
+            b.apply(c);
+            latency->record(c.sent, picked, TscClock::now());
+        }
+        sq.release_n(batch.size());
+        received += batch.size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - startBench;
+
+    if (otherProcess) {::waitpid(child, nullptr, 0);}
+    else {producer.join();}
+    printLatency(label, *latency, elapsed);
+    std::cout << "Producer after the run: " << toString(shared.peer()) << "\n\n";
+    SharedSegment::remove(name);
+}
+
+int main(const int argc, char** argv){
+    const Pacing p{.burstsPerSec = argc > 1 ? std::atoi(argv[1]) : 1'000,
+                   .burst = argc > 2 ? std::atoi(argv[2]) : 100,
+                   .seconds = argc > 3 ? std::atoi(argv[3]) : 3};
+    std::cout << p.burst << " orders every " << 1'000'000 / p.burstsPerSec << " μs\n\n";
+
+    try {
+        runShared<BusySpin>("Busy spin, producer thread", p, false);
+        runShared<BusySpin>("Busy spin, producer process", p, true);
+        runShared<SharedFutexWait<>>("Shared futex, producer thread", p, false);
+        runShared<SharedFutexWait<>>("Shared futex, producer process", p, true);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,109 @@
+// Wait strategy suite: the pipeline at a paced arrival rate under each SpscQ wait strategy, latency against CPU used.
+// At full rate every strategy spins, so orders arrive in bursts with idle gaps between them, as a real feed does.
+// Usage: waitBenchmark [bursts per second] [orders per burst] [seconds per strategy]
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "structures/Book.hpp"
+#include "structures/LatencyHistogram.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/SpscQ.hpp"
+#include "structures/TscClock.hpp"
+#include "structures/WaitStrategy.hpp"
+
+#include "Report.hpp"
+#include "Workload.hpp"
+
+constexpr std::size_t buffSize = 16'384;
+constexpr std::size_t maxBatch = 64;
+
+struct Pacing{
+    int burstsPerSec;
+    int burst;
+    int seconds;
+};
+
+std::chrono::nanoseconds threadCpu() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+template<typename Wait>
+void runWait(const char* label, const Pacing& p){
+    // Producer sends a burst, then sleeps to the next burst's start. Consumer blocks in peek_n_wait between bursts
+
+    WorkloadGen gen({});
+    Book b({.maxOrders = 4'000'000, .maxLevels = 262'144});
+    for (int i = 0; i < WorkloadSpec{}.preload; ++i) {b.apply(gen.preload());}
+
+    const int numOrders = p.burstsPerSec * p.burst * p.seconds;
+    std::vector<OrderCommand> orders(static_cast<std::size_t>(numOrders));
+    for (auto& c : orders) {c = gen.next();}
+
+    auto sq = std::make_unique<SpscQ<OrderCommand,buffSize,Wait>>();
+    auto latency = std::make_unique<PipelineLatency>(); // Only consumer records
+    std::chrono::nanoseconds producerCpu{}, consumerCpu{};
+
+    const auto startBench = std::chrono::steady_clock::now();
+    std::jthread producer([&] {
+        const std::chrono::nanoseconds gap(1'000'000'000 / p.burstsPerSec);
+        auto due = std::chrono::steady_clock::now();
+        for (int sent = 0; sent < numOrders;) {
+            std::this_thread::sleep_until(due);
+            due += gap;
+            for (int i = 0; i < p.burst && sent < numOrders; ++i, ++sent) {
+                OrderCommand* slot = sq->claim_wait();
+                *slot = orders[static_cast<std::size_t>(sent)];
+                slot->sent = TscClock::stamp();
+                sq->commit();
+            }
+        }
+        producerCpu = threadCpu();
+    });
+
+    std::jthread consumer([&] {
+        for (int received = 0; received < numOrders;) {
+            const auto batch = sq->peek_n_wait(maxBatch);
+            const uint64_t picked = TscClock::now();
+            for (const OrderCommand& c : batch) {
+                b.apply(c);
+                latency->record(c.sent, picked, TscClock::now());
+            }
+            sq->release_n(batch.size());
+            received += static_cast<int>(batch.size());
+        }
+        consumerCpu = threadCpu();
+    });
+
+    producer.join();
+    consumer.join();
+    const auto elapsed = std::chrono::steady_clock::now() - startBench;
+
+    printLatency(label, *latency, elapsed);
+    const auto share = [&](const std::chrono::nanoseconds cpu) {
+        return 100.0 * static_cast<double>(cpu.count()) / static_cast<double>(elapsed.count());
+    };
+    std::cout << std::fixed << std::setprecision(1) << "CPU used, consumer / producer: " << share(consumerCpu)
+              << "% / " << share(producerCpu) << "% of a core\n\n";
+}
+
+int main(const int argc, char** argv){
+    const Pacing p{.burstsPerSec = argc > 1 ? std::atoi(argv[1]) : 1'000,
+                   .burst = argc > 2 ? std::atoi(argv[2]) : 100,
+                   .seconds = argc > 3 ? std::atoi(argv[3]) : 3};
+    std::cout << p.burst << " orders every " << 1'000'000 / p.burstsPerSec << " μs\n\n";
+
+    runWait<BusySpin>("Busy spin", p);
+    runWait<PauseSpin>("Pause spin", p);
+    runWait<SpinThenYield<>>("Spin then yield", p);
+    runWait<FutexWait<>>("Futex after spinning", p);
+    runWait<FutexWait<0>>("Futex straight away", p);
+}
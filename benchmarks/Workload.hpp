@@ -0,0 +1,126 @@
+// Workload generator for the benchmark suite, order flow shaped like a real market rather than uniform noise
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "structures/OrderCommand.hpp"
+
+enum class SizeDist{
+    // How order quantities are drawn
+    UNIFORM,  // minQty to maxQty
+    LOGNORMAL // Mostly near medianQty with a long tail of big orders, clamped to minQty to maxQty
+};
+
+struct WorkloadSpec{
+// Knobs for WorkloadGen. The four order weights are relative, they needn't sum to 1
+    double startMid = 100.0;
+    double tickSize = 0.05;
+    double driftTicks = 0.05; // Standard deviation of the mid's random walk per order, in ticks
+    int depth = 50;           // Limits rest 0 to depth - 1 ticks behind the touch
+    double zipf = 1.2;        // Level popularity, P(k ticks behind) ~ 1 / (k + 1)^zipf. 0 spreads evenly over depth
+
+    double limitWeight = 0.60;
+    double marketWeight = 0.05;
+    double cancelWeight = 0.30; // Cancels and amends target a random limit this generator sent earlier
+    double amendWeight = 0.05;
+
+    SizeDist sizes = SizeDist::LOGNORMAL;
+    int minQty = 1;
+    int maxQty = 10'000;
+    int medianQty = 100;      // LOGNORMAL only
+    double sizeSigma = 1.0;   // LOGNORMAL only, spread of log(qty)
+
+    int preload = 10'000;     // Limits to rest before the measured flow, from preload()
+};
+
+class WorkloadGen{
+// Streams order commands for a WorkloadSpec.
+// The mid follows a random walk. Buys rest below it and sells above, a Zipf distributed number of ticks back from
+// the touch, so a few levels near the mid are busy and the rest thin out. When the mid drifts through resting
+// levels the next limits on the other side cross them
+    struct Live{int id; Side side;};
+
+    WorkloadSpec spec;
+    std::mt19937_64 gen;
+    std::bernoulli_distribution coinFlip{0.5};
+    std::normal_distribution<double> drift;
+    std::discrete_distribution<int> level; // Ticks behind the touch
+    std::discrete_distribution<int> kind;  // NEW limit, NEW market, CANCEL, AMEND
+    std::uniform_int_distribution<int> uniformQty;
+    std::lognormal_distribution<double> lognormalQty;
+    double mid;                            // In ticks
+    int nextID;
+    std::vector<Live> live;                // Limits sent that may still rest, cancels and amends pick from these
+
+    static constexpr std::size_t maxLive = 1 << 20;
+
+    static std::discrete_distribution<int> zipfLevels(const int depth, const double s) {
+        std::vector<double> w(static_cast<std::size_t>(std::max(depth, 1)));
+        for (std::size_t k = 0; k < w.size(); ++k) {w[k] = 1.0 / std::pow(static_cast<double>(k + 1), s);}
+        return {w.begin(), w.end()};
+    }
+
+    int qty() {
+        if (spec.sizes == SizeDist::UNIFORM) {return uniformQty(gen);}
+        const auto q = static_cast<int>(std::lround(lognormalQty(gen)));
+        return std::clamp(q, spec.minQty, spec.maxQty);
+    }
+
+    double price(const Side side) {
+        // A level behind the touch on side's half of the book
+        const auto touch = static_cast<long long>(std::floor(mid));
+        const long long k = level(gen);
+        const long long ticks = side == Side::BUY ? touch - k : touch + 1 + k;
+        return static_cast<double>(std::max(ticks, 1LL)) * spec.tickSize;
+    }
+
+    OrderCommand limit() {
+        const Side side = coinFlip(gen) ? Side::SELL : Side::BUY;
+        const int id = nextID++;
+        if (live.size() < maxLive) {live.push_back({id, side});}
+        else {live[std::uniform_int_distribution<std::size_t>(0, maxLive - 1)(gen)] = {id, side};}
+        return OrderCommand::limit(id, side, qty(), price(side));
+    }
+
+    std::size_t pickLive() {return std::uniform_int_distribution<std::size_t>(0, live.size() - 1)(gen);}
+
+public:
+    explicit WorkloadGen(const WorkloadSpec& s, const int firstID = 0, const unsigned seed = std::random_device{}())
+        : spec(s), gen(seed), drift(0.0, s.driftTicks),
+          level(zipfLevels(s.depth, s.zipf)),
+          kind({s.limitWeight, s.marketWeight, s.cancelWeight, s.amendWeight}),
+          uniformQty(s.minQty, s.maxQty),
+          lognormalQty(std::log(static_cast<double>(s.medianQty)), s.sizeSigma),
+          mid(s.startMid / s.tickSize), nextID(firstID) {
+        live.reserve(maxLive);
+    }
+
+    // A resting limit around the starting mid, to build the book before the measured flow
+    OrderCommand preload() {return limit();}
+
+    OrderCommand next() {
+        mid = std::max(mid + drift(gen), 1.0);
+
+        switch (live.empty() ? 0 : kind(gen)) {
+            case 1: return OrderCommand::market(nextID++, coinFlip(gen) ? Side::SELL : Side::BUY, qty());
+            case 2: {
+                // The order may have filled already, then the Book just reports it unknown
+                const std::size_t i = pickLive();
+                const int id = live[i].id;
+                live[i] = live.back();
+                live.pop_back();
+                return OrderCommand::cancel(id);
+            }
+            case 3: {
+                const Live& l = live[pickLive()];
+                return OrderCommand::amend(l.id, qty(), price(l.side));
+            }
+            default: return limit();
+        }
+    }
+};
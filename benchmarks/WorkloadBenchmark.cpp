@@ -0,0 +1,100 @@
+// Scenario suite: the producer/consumer pipeline run over WorkloadGen flows, throughput and latency per scenario.
+// Usage: workloadBenchmark [orders per scenario] [scenario names to run, all if none]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "structures/Book.hpp"
+#include "structures/LatencyHistogram.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/PreTrade.hpp"
+#include "structures/SpscQ.hpp"
+#include "structures/TscClock.hpp"
+
+#include "Report.hpp"
+#include "Workload.hpp"
+
+struct Scenario{
+    const char* name;
+    WorkloadSpec spec;
+};
+
+const Scenario scenarios[] = {
+    // Liquid instrument: most flow at the touch, a third of it cancels
+    {"baseline", {}},
+    // Many levels with popularity spread out, a large resting book
+    {"deep", {.depth = 2'000, .zipf = 0.6, .preload = 500'000}},
+    // Quote churn: a few levels, mostly cancels and replaces, small sizes
+    {"cancelHeavy", {.depth = 10, .zipf = 1.5, .limitWeight = 0.48, .marketWeight = 0.01, .cancelWeight = 0.42,
+                     .amendWeight = 0.09, .medianQty = 10}},
+    // Aggressive flow: a fifth market orders with uniform sizes up to 50K, sweeping several levels
+    {"sweeps", {.limitWeight = 0.55, .marketWeight = 0.20, .cancelWeight = 0.20, .sizes = SizeDist::UNIFORM,
+                .maxQty = 50'000}},
+    // Fast moving mid, limits keep crossing what rested behind it
+    {"trending", {.driftTicks = 0.5}},
+};
+
+void runScenario(const Scenario& sc, const int numOrders){
+    // Preloads the book, then streams numOrders commands through an SpscQ to the matching thread
+
+    WorkloadGen gen(sc.spec);
+    Book b({.maxOrders = 4'000'000, .maxLevels = 262'144, .tickSize = sc.spec.tickSize});
+    for (int i = 0; i < sc.spec.preload; ++i) {b.apply(gen.preload());}
+    const std::size_t preloaded = b.size();
+
+    std::vector<OrderCommand> orders(static_cast<std::size_t>(numOrders));
+    for (auto& c : orders) {c = gen.next();}
+
+    auto sq = std::make_unique<SpscQ<OrderCommand,16'384>>();
+    auto latency = std::make_unique<PipelineLatency>(); // Only consumer records
+
+    const auto startBench = std::chrono::steady_clock::now();
+    std::jthread producer([&] {
+        for (const OrderCommand& o : orders) {
+            OrderCommand* slot = sq->claim_wait();
+            *slot = o;
+            slot->sent = TscClock::stamp();
+            sq->commit();
+        }
+    });
+
+    // Pre-trade checks run on the matching thread ahead of the Book, as in the engine
+    const PreTradeCheck risk({.maxQty = 1'000'000, .band = 0.2});
+    long long rejected = 0;  // Failed pre-trade checks
+    long long unapplied = 0; // Cancels and amends of orders already filled, limits that didn't fit
+    std::jthread consumer([&] {
+        for (int received = 0; received < numOrders;) {
+            if (const OrderCommand* c = sq->peek()) {
+                const uint64_t picked = TscClock::now();
+                if (risk.check(*c, b) != RejectReason::NONE) {rejected++;}
+                else if (!b.apply(*c)) {unapplied++;}
+                latency->record(c->sent, picked, TscClock::now());
+                sq->release();
+                ++received;
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    const auto endBench = std::chrono::steady_clock::now();
+
+    printLatency(sc.name, *latency, endBench - startBench);
+    std::cout << "Book: " << preloaded << " resting before, " << b.size() << " after, " << rejected
+              << " rejected pre-trade, " << unapplied << " not applied\n\n";
+}
+
+int main(const int argc, char** argv){
+    const int numOrders = argc > 1 ? std::atoi(argv[1]) : 10'000'000;
+
+    for (const Scenario& sc : scenarios) {
+        bool chosen = argc <= 2;
+        for (int i = 2; i < argc; ++i) {chosen = chosen || std::string(argv[i]) == sc.name;}
+        if (chosen) {runScenario(sc, numOrders);}
+    }
+}
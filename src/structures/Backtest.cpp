@@ -0,0 +1,75 @@
+#include "Backtest.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <system_error>
+
+#include "OrderCommand.hpp"
+#include "OrderFlow.hpp"
+#include "TscClock.hpp"
+#include "WorkStealingPool.hpp"
+
+void BookStats::merge(const BookStats& other) noexcept {
+    commands += other.commands;
+    unapplied += other.unapplied;
+    corrupt += other.corrupt;
+    fills += other.fills;
+    volume += other.volume;
+    notional += other.notional;
+    resting += other.resting;
+    busy += other.busy;
+    apply.merge(other.apply);
+}
+
+void replayInto(const BacktestInput& in, BookStats& out) {
+    const auto start = std::chrono::steady_clock::now();
+    const FlowReader flow(in.path);
+    // The Book is built here, on the worker that replays into it, so its memory is faulted in on that worker's node
+    const auto book = std::make_unique<BacktestBook>(in.book);
+
+    OrderCommand c{};
+    for (uint64_t i = 0; i < flow.size(); ++i) {
+        if (!decode(flow[i], c)) {out.corrupt++; continue;}
+        const uint64_t before = TscClock::now();
+        if (!book->apply(c)) {out.unapplied++;}
+        out.apply.record(TscClock::now() - before);
+    }
+
+    out.commands += flow.size();
+    out.fills += book->sink().fills;
+    out.volume += book->sink().volume;
+    out.notional += book->sink().notional;
+    out.resting += book->size();
+    out.busy += std::chrono::steady_clock::now() - start;
+}
+
+BacktestResult runBacktest(const std::span<const BacktestInput> inputs, const std::size_t threads) {
+    BacktestResult result;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {result.books.push_back(std::make_unique<BookStats>());}
+    result.total = std::make_unique<BookStats>();
+
+    // Largest first. A file that can't be sized sorts last and fails properly when it's opened
+    std::vector<uintmax_t> bytes(inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        std::error_code ec;
+        bytes[i] = std::filesystem::file_size(inputs[i].path, ec);
+        if (ec) {bytes[i] = 0;}
+    }
+    std::vector<std::size_t> order(inputs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, [&](const std::size_t a, const std::size_t b) {return bytes[a] > bytes[b];});
+
+    WorkStealingPool pool(threads);
+    result.threads = pool.size();
+    const auto start = std::chrono::steady_clock::now();
+    pool.run(order.size(), [&](const std::size_t task, std::size_t) {
+        const std::size_t i = order[task];
+        replayInto(inputs[i], *result.books[i]);
+    });
+    result.wall = std::chrono::steady_clock::now() - start;
+    result.steals = pool.steals();
+
+    for (const auto& b : result.books) {result.total->merge(*b);}
+    return result;
+}
@@ -0,0 +1,86 @@
+// The backtest runner, replays many flow files at once, each through its own Book, and merges what they did
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Book.hpp"
+#include "LatencyHistogram.hpp"
+
+struct FillTally{
+// Event sink that counts what a Book matched
+    uint64_t fills = 0;  // One per maker an aggressor traded with
+    int64_t volume = 0;  // Quantity matched
+    double notional = 0; // Quantity x price matched
+
+    template<typename O>
+    void onFill(const O&, const O&, const typename O::Qty qty, const typename O::Price price) noexcept {
+        fills++;
+        volume += qty;
+        notional += static_cast<double>(qty) * static_cast<double>(price);
+    }
+
+    template<typename O>
+    void onRest(const O&, typename O::Price) noexcept {}
+
+    template<typename O>
+    void onComplete(const O&) noexcept {}
+
+    template<typename O>
+    void onReject(const O&, typename O::Price) noexcept {}
+};
+
+struct BacktestPolicy : DefaultPolicy{
+// The engine's types with the fills counted. Orders are stamped by a clock that's never moved,
+// so the same file matches the same way on every run and every thread
+    using Sink = FillTally;
+    using Clock = ManualClock;
+};
+
+using BacktestBook = BasicBook<BacktestPolicy>;
+
+struct BacktestInput{
+// One instrument-day: a flow file and the Book to replay it into
+    std::string path;
+    BookConfig book = {};
+};
+
+struct BookStats{
+// What one replay did, or several merged
+    uint64_t commands = 0;           // Records replayed
+    uint64_t unapplied = 0;          // Cancels and amends of orders no longer resting, limits that didn't fit
+    uint64_t corrupt = 0;            // Records that didn't decode, skipped
+    uint64_t fills = 0;
+    int64_t volume = 0;
+    double notional = 0;
+    uint64_t resting = 0;            // Orders left in the book at the end
+    std::chrono::nanoseconds busy{}; // Time spent replaying, summed over books when merged
+    LatencyHistogram apply;          // TscClock ticks per Book::apply
+
+    // Adds other's counts and latencies to these. Neither may be recording
+    void merge(const BookStats& other) noexcept;
+};
+
+struct BacktestResult{
+    std::vector<std::unique_ptr<BookStats>> books; // One per input, in the order given
+    std::unique_ptr<BookStats> total;              // Every book merged
+    std::chrono::nanoseconds wall{};               // From starting the first replay to finishing the last
+    std::size_t threads = 0;
+    uint64_t steals = 0;                           // Replays a worker took from another worker's queue
+};
+
+// Replays in into a new Book on the calling thread and adds what it did to out.
+// Throws std::runtime_error if the file can't be read
+void replayInto(const BacktestInput& in, BookStats& out);
+
+// Replays every input through its own Book on a WorkStealingPool of threads workers, all hardware threads if 0.
+// Inputs are dealt out largest file first, so the longest days start straight away and the short ones fill the gaps.
+// Each Book lives only on the worker replaying it, the stats are merged once every replay has finished.
+// If an input can't be read the rest still run, then its exception is rethrown
+BacktestResult runBacktest(std::span<const BacktestInput> inputs, std::size_t threads = 0);
@@ -1,40 +1,823 @@
 #pragma once
 
-#include <map>
-#include <queue>
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Order.hpp"
+#include "OrderCommand.hpp"
+#include "OrderIndex.hpp"
+#include "Policy.hpp"
+#include "Pool.hpp"
+#include "PriceLadder.hpp"
+#include "Snapshot.hpp"
+#include "Sweep.hpp"
 
 
-class Book{
+struct PriceLevel{
+// FIFO queue of the limit orders resting at a single price.
+// An intrusive doubly linked list through the Book's order nodes, so any order can be unlinked in O(1)
+// The level's total quantity and order count are kept up to date as orders rest, fill and leave,
+// so aggregated depth never has to walk the queue
+    static constexpr uint32_t nil = std::numeric_limits<uint32_t>::max();
+
+    uint32_t head = nil; // Oldest order, first to be filled
+    uint32_t tail = nil; // Newest order
+    int64_t quantity = 0; // Unexecuted quantity of every order resting here
+    uint32_t orders = 0;  // Number of orders resting here
+
+    [[nodiscard]] bool empty() const noexcept {return head == nil;}
+
+    void reset() noexcept {head = tail = nil; quantity = 0; orders = 0;}
+};
+
+struct BookConfig{
+// Sizes the Book's storage. Everything is allocated once, in the constructor
+    std::size_t maxOrders = 65'536;   // Most orders that can rest at once (across both sides)
+    std::size_t maxLevels = 16'384;   // Most price levels that can be occupied at once, per side
+    std::size_t initialTicks = 4'096; // Starting width of the price window on each side, it doubles as needed
+    std::size_t maxTicks = 16'777'216; // Widest the price window may grow, an order priced outside it is rejected
+    double tickSize = 0.0;            // Price increment of this instrument, 0 uses the Policy's tickSize
+    std::size_t maxParticipants = 256; // Participants 0 to maxParticipants - 1 get their resting orders counted
+};
+
+
+template<typename Policy = DefaultPolicy>
+class BasicBook{
 // The order book, which contains and manages the orders constructed by the Order class
+// Policy fixes the price and quantity types, tick size and event sink at compile time,
+// so the matching path has no virtual calls and each side gets its own matching kernel
+// Everything inside is in integer Ticks of this book's tick: orders, levels and the last trade. Prices are converted
+// from Price as commands come in and back to it for events, depth and getters
+public:
+    using Order = BasicOrder<Policy>;
+    using Price = typename Order::Price;
+    using Qty = typename Order::Qty;
+    using Sink = typename Policy::Sink;
+    using Clock = typename Policy::Clock;
+
+    struct DepthLevel{
+    // One aggregated price level, as filled in by depth
+        Price price;
+        Qty quantity;    // Total unexecuted quantity at price
+        uint32_t orders; // Orders resting at price
+    };
+
 private:
-    
-    // Creating an alias type for both sides of the order book
-    using LimitSellMap = std::map<double, std::deque<Order>, std::less<>>;
-    using LimitBuyMap  = std::map<double, std::deque<Order>,std::greater<>>;
-    
-    // Each side of the order book is a map organised price levels
+
+    struct OrderNode{
+    // A resting order, linked into the FIFO queue of its price level
+        Order order;
+        uint32_t prev = PriceLevel::nil; // Older order at the same price
+        uint32_t next = PriceLevel::nil; // Newer order at the same price
+    };
+
+    // Each side of the order book is a ladder of price levels indexed by tick
     // With each price level being FIFO queue.
-    LimitSellMap limitSell;
-    LimitBuyMap  limitBuy;
+    // Best ask is the lowest tick in limitSell, best bid the highest tick in limitBuy
+    using Ladder = PriceLadder<PriceLevel>;
+    Ladder limitSell;
+    Ladder limitBuy;
+
+    // Storage for resting orders, preallocated and recycled as orders fill or cancel
+    Pool<OrderNode> nodes;
+
+    // Order ID -> node of the resting order, for cancel and amend
+    OrderIndex index;
+
+    // Receives fills, rests, completions and rejects
+    [[no_unique_address]] Sink events;
+
+    // Stamps each order as it's accepted, along with the next sequence number
+    [[no_unique_address]] Clock time;
+    uint64_t sequence = 0; // Last sequence number handed out
+
+    // This instrument's price increment, fixed at construction
+    Price tick;
+
+    // Resting orders per participant, for open order limits
+    std::vector<uint32_t> open;
+
+    // Price of the most recent fill, 0 before the first
+    Ticks lastTrade = 0;
+
+    // Converts a price to the nearest tick
+    [[nodiscard]] Ticks toTick(Price price) const noexcept {return std::llround(price / tick);}
+
+    // Converts ticks back to a price
+    [[nodiscard]] Price toPrice(Ticks t) const noexcept {return static_cast<Price>(t) * tick;}
+
+    // Side of the book an order rests on
+    Ladder& sideOf(const Order& o) noexcept {return o.side == Side::BUY ? limitBuy : limitSell;}
+
+    // addOrder for an order already in this book's ticks: stamps it, matches it and rests what's left
+    bool enter(Order& o);
+
+    // What an incoming order or command is going to touch, worked out ahead of it in a batch
+    struct Touch{
+        Ticks tick;    // Where it would rest, if priced
+        int orderID;
+        Side side;
+        bool priced;   // A new limit order, it may rest at tick on side's ladder
+        bool existing; // A cancel or amend, it looks orderID up in the index
+        bool taker;    // A new order that may take liquidity from the other side's best level
+    };
+    [[nodiscard]] Touch touchOf(const Order& o) const noexcept;
+    [[nodiscard]] Touch touchOf(const OrderCommand& c) const noexcept;
+
+    // Three prefetch stages, each only reading lines the one before brought in: ladder handle and index slot,
+    // then the level (or the resting order for a cancel or amend), then the orders queued next to it.
+    // The other side's best level is in cache from matching, only its first order is fetched
+    void prefetchSlots(const Touch& t) const noexcept;
+    void prefetchLevel(const Touch& t) const noexcept;
+    void prefetchOrders(const Touch& t) const noexcept;
+
+    // Calls step on each item in order, with the prefetch stages running a few items ahead of it
+    template<typename T, typename Step>
+    void inBatch(std::span<T> items, Step&& step);
+
+    // Copies a limit order into a node at the back of its price level.
+    // Returns false if the order or level pool is exhausted
+    bool rest(const Order& o);
+
+    // Links node n onto the back of level's queue and adds it to the level's totals
+    void append(PriceLevel& level, uint32_t n);
+
+    // Takes a resting order out of its price level and frees its node
+    void remove(uint32_t n);
+
+    // Bulk loads one side of a snapshot, orders already in priority order
+    void loadSide(std::span<const SnapshotOrder> records, Side side);
+
+    // Drops a node that's no longer in any level from the index and recycles it
+    void retire(uint32_t n);
 
     // Prints out the limit orders on one side of the book
-    template <typename Comparator>
-    void showLimit(const std::map<double, std::deque<Order>,Comparator>& limitBook);
+    void showLimit(const Ladder& limitBook) const;
 
     // Market matching logic. For crossing two orders
-    virtual void marketMatch(Order& o);
+    void marketMatch(Order& o);
+
+    // Matching kernel for one aggressor side, market orders skip the price check
+    template<Side S, bool IsLimit>
+    void match(Order& o);
+
+    // Bulk path of match for an order that clears whole levels, up to stop on the opposite side
+    template<Side S>
+    void sweep(Order& o, Ladder& ladder, Ticks stop);
+
+    // Fills every order at level, which is at tick, against o in full. Leaves the level for the caller to vacate
+    void clearLevel(Order& o, const PriceLevel& level, Ticks tick);
 
 public:
 
-    virtual ~Book() = default;
+    explicit BasicBook(const BookConfig& cfg = {}, Sink sink = {}, Clock clock = {})
+        : limitSell(cfg.initialTicks, cfg.maxLevels, cfg.maxTicks), limitBuy(cfg.initialTicks, cfg.maxLevels, cfg.maxTicks),
+          nodes(cfg.maxOrders), index(cfg.maxOrders), events(std::move(sink)), time(std::move(clock)),
+          tick(cfg.tickSize > 0 ? static_cast<Price>(cfg.tickSize) : Policy::tickSize), open(cfg.maxParticipants) {}
 
     friend struct BookTestHelper; //Helper for unit testing
 
-    void addOrder(Order& o); //Adds an order to the Limit book.
+    //Adds an order to the Limit book. The order is stamped with the next sequence number and the clock's time first.
+    //Orders are built on the Policy's tick, on a book with its own tick a limit price is moved to the nearest of its ticks.
+    //Returns false if a limit order's remainder couldn't rest because the book is full.
+    //The order keeps its unexecuted quantity and isn't in the book, nothing is allocated
+    bool addOrder(Order& o);
+
+    //Adds each order in turn, exactly as calling addOrder on them one by one, prefetching the price levels, index slots
+    //and resting orders the next few will touch while one matches. Returns how many addOrder calls returned true
+    std::size_t addOrders(std::span<Order> orders);
+
+    // Removes a resting order. Returns false if no order with that ID is resting
+    bool cancel(int orderID);
+
+    // Changes a resting order's unexecuted quantity and price. Returns false if no order with that ID is resting,
+    // or if the book was too full for the moved order to rest again (it's then cancelled)
+    // A quantity reduce at the same price keeps time priority,
+    // any other change sends the order to the back of the queue at its (new) price, crossing the book first if it can
+    bool amend(int orderID, Qty newQty, Price newPrice);
+
+    // Applies a command read off the ingestion ring: addOrder, cancel or amend.
+    // Returns what that call returned. c is only read, so it can be a ring slot read in place
+    bool apply(const OrderCommand& c);
+
+    // Applies a batch of commands, e.g. a run of ring slots from peek_n, exactly as calling apply on each in turn,
+    // with the same prefetching as addOrders. after(c, applied) runs once each command is done, e.g. to record its
+    // latency. Returns how many apply calls returned true
+    std::size_t apply(std::span<const OrderCommand> cmds);
+    template<typename After>
+    std::size_t apply(std::span<const OrderCommand> cmds, After&& after);
+
+    // Fills out with the best out.size() levels on side, best first, and returns how many there were.
+    // Costs O(levels written), however many orders rest behind each one, and doesn't allocate
+    std::size_t depth(Side side, std::span<DepthLevel> out) const;
+
+    // Writes every resting order, with its executed and unexecuted quantity, to a snapshot file at path:
+    // sells then buys, each best price first and in time priority. seq goes in the header, e.g. the journal
+    // sequence number this book reflects. The file is on disk when this returns.
+    // Throws std::runtime_error if the file can't be created or synced
+    void snapshot(const std::string& path, uint64_t seq = 0) const;
+
+    // Rebuilds this book from a snapshot without matching, queues and levels are filled in bulk from the mapped file.
+    // Returns the snapshot's seq. Throws std::runtime_error if the book isn't empty, the snapshot was taken on a different
+    // tick, or the book's pools are too small for it (the book may then be partly loaded)
+    uint64_t load(const std::string& path);
+
+    // Number of resting orders
+    [[nodiscard]] std::size_t size() const noexcept {return nodes.inUse();}
+
+    // Price increment this book matches on
+    [[nodiscard]] Price tickSize() const noexcept {return tick;}
+
+    // The event sink, e.g. to read what it has collected
+    Sink& sink() noexcept {return events;}
+
+    // The clock orders are stamped with, e.g. to set a ManualClock
+    Clock& clock() noexcept {return time;}
+
+    // Sequence number of the last order accepted, 0 if none. A loaded snapshot carries on from its orders
+    [[nodiscard]] uint64_t lastSeq() const noexcept {return sequence;}
+
+    // Price of the most recent fill, 0 if there hasn't been one
+    [[nodiscard]] Price lastPrice() const noexcept {return toPrice(lastTrade);}
+
+    // Orders participant has resting. Participants from maxParticipants up aren't counted and read 0
+    [[nodiscard]] uint32_t openOrders(const uint16_t participant) const noexcept {
+        return participant < open.size() ? open[participant] : 0;
+    }
+    [[nodiscard]] std::size_t participants() const noexcept {return open.size();}
 
     void showOrders(); // Prints orders on both side of the book
     
 };
+
+// The engine's default book
+using Book = BasicBook<DefaultPolicy>;
+
+
+template<typename Policy>
+bool BasicBook<Policy>::addOrder(Order& o){
+    // The only place an Order's ticks can be on another tick, apply and amend build theirs on this book's
+
+    if (o.orderType == OrderType::LIMIT && tick != Policy::tickSize) {
+        o.tgtPrice = toTick(static_cast<Price>(o.tgtPrice) * Policy::tickSize);
+    }
+    return enter(o);
+}
+
+template<typename Policy>
+bool BasicBook<Policy>::enter(Order& o){
+    // Adds an Order to the Order Book.
+    // Limit orders, either go into the book or instantly cross
+    // Market orders, either are rejected (no liquidity) or are executed
+
+    o.seq = ++sequence;
+    o.timestamp = time.now();
+
+    switch (o.orderType){
+    case (OrderType::MARKET):
+        //Market order, needs to be executed immediately
+
+        this->marketMatch(o);
+        events.onComplete(o);
+        return true;
+    case OrderType::LIMIT:
+        // Limit order, needs to either instantly cross the book or be added
+
+        this->marketMatch(o); // Attempts to cross the book
+        if (o.unexecQuantity != 0) {
+            // Didn't cross the book
+            if (rest(o)) {return true;}
+            events.onReject(o, toPrice(o.tgtPrice));
+            return false;
+        }
+        events.onComplete(o);
+    }
+    return true;
+}
+
+template<typename Policy>
+std::size_t BasicBook<Policy>::addOrders(const std::span<Order> orders){
+    std::size_t added = 0;
+    inBatch(orders, [&](Order& o){added += addOrder(o);});
+    return added;
+}
+
+template<typename Policy>
+std::size_t BasicBook<Policy>::apply(const std::span<const OrderCommand> cmds){
+    return apply(cmds, [](const OrderCommand&, bool){});
+}
+
+template<typename Policy>
+template<typename After>
+std::size_t BasicBook<Policy>::apply(const std::span<const OrderCommand> cmds, After&& after){
+    std::size_t applied = 0;
+    inBatch(cmds, [&](const OrderCommand& c){
+        const bool ok = apply(c);
+        applied += ok;
+        after(c, ok);
+    });
+    return applied;
+}
+
+template<typename Policy>
+template<typename T, typename Step>
+void BasicBook<Policy>::inBatch(const std::span<T> items, Step&& step){
+    // A level lookup is a chain of dependent misses (handle, level, order), so each item's chain is started three
+    // stages early, one link per stage, and the lines are in cache by the time the item matches.
+    // Only hints: nothing is written ahead, so state an earlier item changes is read as it is when the item runs
+
+    constexpr std::size_t far = 8;  // Ladder handle and index slot
+    constexpr std::size_t mid = 4;  // Level, or resting order
+    constexpr std::size_t near = 1; // Orders queued at the level
+    std::array<Touch, far> ahead;   // Touches of the next far items, item j at j % far
+
+    const std::size_t n = items.size();
+    for (std::size_t j = 0; j < std::min(n, far); ++j) {
+        ahead[j] = touchOf(items[j]);
+        prefetchSlots(ahead[j]);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i + mid < n) {prefetchLevel(ahead[(i + mid) % far]);}
+        if (i + near < n) {prefetchOrders(ahead[(i + near) % far]);}
+        step(items[i]);
+        if (i + far < n) {
+            ahead[i % far] = touchOf(items[i + far]);
+            prefetchSlots(ahead[i % far]);
+        }
+    }
+}
+
+template<typename Policy>
+inline typename BasicBook<Policy>::Touch BasicBook<Policy>::touchOf(const Order& o) const noexcept {
+    // Orders are on the Policy's tick until addOrder moves them, near enough for a hint
+    return Touch{o.tgtPrice, o.orderID, o.side, o.orderType == OrderType::LIMIT, false, true};
+}
+
+template<typename Policy>
+inline typename BasicBook<Policy>::Touch BasicBook<Policy>::touchOf(const OrderCommand& c) const noexcept {
+    const bool priced = c.command == CommandType::NEW && c.type == OrderType::LIMIT;
+    const bool isNew = c.command == CommandType::NEW;
+    return Touch{priced ? toTick(static_cast<Price>(c.price)) : 0, c.orderID, c.side, priced, !isNew, isNew};
+}
+
+template<typename Policy>
+inline void BasicBook<Policy>::prefetchSlots(const Touch& t) const noexcept {
+    // A new limit order may rest, which also inserts its ID into the index
+    if (t.priced) {(t.side == Side::BUY ? limitBuy : limitSell).prefetch(t.tick);}
+    if (t.priced || t.existing) {index.prefetch(t.orderID);}
+}
+
+template<typename Policy>
+inline void BasicBook<Policy>::prefetchLevel(const Touch& t) const noexcept {
+    if (t.existing) {
+        const uint32_t n = index.find(t.orderID);
+        if (n != OrderIndex::npos) {__builtin_prefetch(&nodes[n]);}
+    } else if (t.priced) {
+        if (const PriceLevel* level = (t.side == Side::BUY ? limitBuy : limitSell).find(t.tick)) {
+            __builtin_prefetch(level);
+        }
+    }
+}
+
+template<typename Policy>
+inline void BasicBook<Policy>::prefetchOrders(const Touch& t) const noexcept {
+    if (t.existing) {
+        // A cancel unlinks the order from its neighbours, an amend may too
+        const uint32_t n = index.find(t.orderID);
+        if (n == OrderIndex::npos) {return;}
+        const OrderNode& node = nodes[n];
+        if (node.prev != PriceLevel::nil) {__builtin_prefetch(&nodes[node.prev]);}
+        if (node.next != PriceLevel::nil) {__builtin_prefetch(&nodes[node.next]);}
+        return;
+    }
+    if (t.taker) {
+        // First order a fill would take
+        const Ladder& other = t.side == Side::BUY ? limitSell : limitBuy;
+        if (!other.empty()) {
+            const PriceLevel* best = other.find(t.side == Side::BUY ? other.lowest() : other.highest());
+            if (best != nullptr && !best->empty()) {__builtin_prefetch(&nodes[best->head]);}
+        }
+    }
+    if (t.priced) {
+        // Where it would be linked on if it rests
+        const PriceLevel* level = (t.side == Side::BUY ? limitBuy : limitSell).find(t.tick);
+        if (level != nullptr && !level->empty()) {__builtin_prefetch(&nodes[level->tail]);}
+    }
+}
+
+template<typename Policy>
+bool BasicBook<Policy>::rest(const Order& o){
+    // Links a copy of the order onto the back of its price level, and indexes it by ID
+
+    if (nodes.full()) {return false;}
+    PriceLevel* lvl = sideOf(o).occupy(o.tgtPrice);
+    if (lvl == nullptr) {return false;}
+    PriceLevel& level = *lvl;
+
+    const uint32_t n = nodes.acquire();
+    nodes[n].order = o;
+    append(level,n);
+
+    index.insert(o.orderID,n);
+    if (o.participant < open.size()) {++open[o.participant];}
+    events.onRest(nodes[n].order, toPrice(o.tgtPrice));
+    return true;
+}
+
+template<typename Policy>
+void BasicBook<Policy>::append(PriceLevel& level, const uint32_t n){
+    // Back of the queue is the newest order
+    OrderNode& node = nodes[n];
+    node.prev = level.tail;
+    node.next = PriceLevel::nil;
+    if (level.empty()) {level.head = n;}
+    else {nodes[level.tail].next = n;}
+    level.tail = n;
+    level.quantity += node.order.unexecQuantity;
+    ++level.orders;
+}
+
+template<typename Policy>
+void BasicBook<Policy>::remove(const uint32_t n){
+    // Unlinks a resting order from anywhere in its level's queue
+
+    OrderNode& node = nodes[n];
+    Ladder& ladder = sideOf(node.order);
+    const Ticks tick = node.order.tgtPrice;
+    PriceLevel& level = ladder.at(tick);
+
+    if (node.prev == PriceLevel::nil) {level.head = node.next;}
+    else {nodes[node.prev].next = node.next;}
+    if (node.next == PriceLevel::nil) {level.tail = node.prev;}
+    else {nodes[node.next].prev = node.prev;}
+    level.quantity -= node.order.unexecQuantity;
+    --level.orders;
+
+    if (level.empty()) {ladder.vacate(tick);}
+    retire(n);
+}
+
+template<typename Policy>
+void BasicBook<Policy>::retire(const uint32_t n){
+    // Only drop the index entry if it still points here, a later order may have reused the ID
+    const Order& o = nodes[n].order;
+    index.erase(o.orderID,n);
+    if (o.participant < open.size()) {--open[o.participant];}
+    nodes.release(n);
+}
+
+template<typename Policy>
+bool BasicBook<Policy>::cancel(const int orderID){
+    // Removes a resting order from the book, whatever its place in the queue
+
+    const uint32_t n = index.find(orderID);
+    if (n == OrderIndex::npos) {return false;}
+    remove(n);
+    return true;
+}
+
+template<typename Policy>
+bool BasicBook<Policy>::amend(const int orderID, const Qty newQty, const Price newPrice){
+    // Two flows:
+    // - Quantity reduce at the same price, done in place so the order keeps its time priority
+    // - Anything else, the order is pulled and re-entered as if it had just arrived
+
+    if (newQty <= 0){
+        throw std::logic_error("Invalid Input: Amended quantity is negative or zero, cancel instead");
+    }
+
+    const uint32_t n = index.find(orderID);
+    if (n == OrderIndex::npos) {return false;}
+
+    Order& o = nodes[n].order;
+    const Ticks prc = toTick(newPrice);
+
+    if (prc == o.tgtPrice && newQty <= o.unexecQuantity){
+        sideOf(o).at(o.tgtPrice).quantity -= o.unexecQuantity - newQty;
+        o.tgtQuantity -= o.unexecQuantity - newQty;
+        o.unexecQuantity = newQty;
+        return true;
+    }
+
+    Order amended = o;
+    remove(n);
+    amended.tgtPrice = prc;
+    amended.tgtQuantity = amended.execQuantity + newQty;
+    amended.unexecQuantity = newQty;
+    return enter(amended);
+}
+
+template<typename Policy>
+bool BasicBook<Policy>::apply(const OrderCommand& c){
+    // Dispatches on the command type, a NEW becomes an Order here rather than in the producer.
+    // Limit prices are converted to this book's ticks, which may differ from the Policy's
+
+    switch (c.command){
+    case CommandType::NEW: {
+        Order o(c.orderID, c.side, c.type, static_cast<Qty>(c.qty));
+        o.participant = c.participant;
+        if (c.type == OrderType::LIMIT) {o.tgtPrice = toTick(static_cast<Price>(c.price));}
+        return enter(o);
+    }
+    case CommandType::CANCEL:
+        return cancel(c.orderID);
+    case CommandType::AMEND:
+        return amend(c.orderID, static_cast<Qty>(c.qty), static_cast<Price>(c.price));
+    }
+    return false;
+}
+
+template<typename Policy>
+void BasicBook<Policy>::snapshot(const std::string& path, const uint64_t seq) const{
+    // Each level's queue is a linked list through nodes scattered across the pool, so one walk at a time
+    // stalls on every node. Knowing each level's order count, every level gets its own range of the file,
+    // and a few levels are walked at once with the next node of each prefetched, keeping several misses in flight
+
+    struct Walk{uint32_t node; SnapshotOrder* out;};
+    std::vector<Walk> walks;
+    walks.reserve(limitSell.size() + limitBuy.size());
+
+    std::size_t sells = 0;
+    std::size_t buys = 0;
+    limitSell.forEachAscending([&](long long, const PriceLevel& level){
+        walks.push_back({level.head, nullptr});
+        sells += level.orders;
+    });
+    limitBuy.forEachDescending([&](long long, const PriceLevel& level){
+        walks.push_back({level.head, nullptr});
+        buys += level.orders;
+    });
+
+    SnapshotWriter out(path, static_cast<double>(tick), seq, sequence, lastTrade, sells, buys);
+
+    // Levels are laid out back to back in priority order, sells first
+    SnapshotOrder* next = out.sells().data();
+    {
+        std::size_t w = 0;
+        const auto place = [&](long long, const PriceLevel& level){walks[w++].out = next; next += level.orders;};
+        limitSell.forEachAscending(place);
+        limitBuy.forEachDescending(place);
+    }
+
+    constexpr std::size_t lanes = 16;
+    std::array<Walk, lanes> lane;
+    std::size_t started = 0;
+    std::size_t active = 0;
+    for (Walk& l : lane) {
+        l = started < walks.size() ? walks[started++] : Walk{PriceLevel::nil, nullptr};
+        if (l.node != PriceLevel::nil) {++active;}
+    }
+
+    while (active != 0) {
+        for (Walk& l : lane) {
+            if (l.node == PriceLevel::nil) {continue;}
+            const OrderNode& node = nodes[l.node];
+            const Order& o = node.order;
+            *l.out++ = SnapshotOrder{o.tgtPrice, o.notional,
+                                     static_cast<int64_t>(o.execQuantity), static_cast<int64_t>(o.unexecQuantity),
+                                     o.timestamp, o.seq, o.orderID, o.participant};
+            l.node = node.next;
+            if (l.node == PriceLevel::nil && started < walks.size()) {l = walks[started++];}
+            if (l.node != PriceLevel::nil) {__builtin_prefetch(&nodes[l.node]);}
+            else {--active;}
+        }
+    }
+    out.close();
+}
+
+template<typename Policy>
+uint64_t BasicBook<Policy>::load(const std::string& path){
+    const SnapshotFile file(path);
+    const SnapshotHeader& h = file.info();
+
+    if (size() != 0) {throw std::runtime_error("Book::load: book isn't empty");}
+    if (std::abs(h.tickSize - static_cast<double>(tick)) > static_cast<double>(tick) * 1e-9) {
+        throw std::runtime_error("Book::load: snapshot was taken on a different tick size");
+    }
+    if (h.sellOrders + h.buyOrders > nodes.capacity()) {
+        throw std::runtime_error("Book::load: snapshot has more orders than maxOrders");
+    }
+
+    loadSide(file.sells(), Side::SELL);
+    loadSide(file.buys(), Side::BUY);
+    sequence = std::max(sequence, h.lastSeq);
+    lastTrade = h.lastTrade;
+    return h.seq;
+}
+
+template<typename Policy>
+void BasicBook<Policy>::loadSide(const std::span<const SnapshotOrder> records, const Side side){
+    // Each order goes straight onto the back of its level, no matching and no events.
+    // The index insert is the only random access, so its slots are prefetched a few orders ahead
+
+    constexpr std::size_t ahead = 16;
+    Ladder& ladder = side == Side::BUY ? limitBuy : limitSell;
+
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        if (i + ahead < records.size()) {index.prefetch(records[i + ahead].orderID);}
+        const SnapshotOrder& r = records[i];
+
+        PriceLevel* level = ladder.occupy(r.price);
+        if (level == nullptr) {throw std::runtime_error("Book::load: snapshot has more price levels than maxLevels, or wider than maxTicks");}
+
+        const uint32_t n = nodes.acquire();
+        Order& o = nodes[n].order;
+        o = Order();
+        o.side = side;
+        o.tgtPrice = r.price;
+        o.notional = r.notional;
+        o.timestamp = r.timestamp;
+        o.seq = r.seq;
+        sequence = std::max(sequence, r.seq);
+        o.orderID = r.orderID;
+        o.participant = static_cast<uint16_t>(r.participant);
+        o.execQuantity = static_cast<Qty>(r.execQty);
+        o.unexecQuantity = static_cast<Qty>(r.unexecQty);
+        o.tgtQuantity = o.execQuantity + o.unexecQuantity;
+        append(*level,n);
+        index.insert(o.orderID,n);
+        if (o.participant < open.size()) {++open[o.participant];}
+    }
+}
+
+template<typename Policy>
+void BasicBook<Policy>::showOrders(){
+    // Mainly for debugging
+    //Prints the current limit orders in the book to terminal
+
+    std::cout << "Limit Orders Sell:\n";
+    showLimit(limitSell);
+    std::cout << "Limit Orders Buy:\n";
+    showLimit(limitBuy);
+
+}
+
+template<typename Policy>
+std::size_t BasicBook<Policy>::depth(const Side side, std::span<DepthLevel> out) const{
+    // Walks the occupied ticks from the touch, asks from the lowest up and bids from the highest down
+
+    std::size_t written = 0;
+    const auto visit = [&](const long long t, const PriceLevel& level){
+        if (written == out.size()) {return false;}
+        out[written++] = DepthLevel{toPrice(t), static_cast<Qty>(level.quantity), level.orders};
+        return true;
+    };
+    if (side == Side::SELL) {limitSell.forEachAscending(visit);}
+    else {limitBuy.forEachDescending(visit);}
+    return written;
+}
+
+template<typename Policy>
+void BasicBook<Policy>::showLimit(const Ladder& limitBook) const{
+    //Mainly for debugging
+    //Prints one side of the limit book to console, lowest price first
+
+    std::cout << "ID\t\tPrice\t\tSize\n";
+    limitBook.forEachAscending([this](long long, const PriceLevel& level){
+        for (uint32_t n = level.head; n != PriceLevel::nil; n = nodes[n].next) {
+            const Order& order = nodes[n].order;
+            std::cout << order.orderID<< "\t\t" << toPrice(order.tgtPrice) << "\t\t" << order.unexecQuantity << "\n";
+        }
+    });
+}
+
+template<typename Policy>
+void BasicBook<Policy>::marketMatch(Order& o){
+    // Picks the matching kernel once per order, rather than testing side and type for every resting order
+
+    if (o.side == Side::BUY){
+        if (o.orderType == OrderType::LIMIT) {match<Side::BUY,true>(o);}
+        else {match<Side::BUY,false>(o);}
+    } else {
+        if (o.orderType == OrderType::LIMIT) {match<Side::SELL,true>(o);}
+        else {match<Side::SELL,false>(o);}
+    }
+}
+
+template<typename Policy>
+template<Side S, bool IsLimit>
+void BasicBook<Policy>::match(Order& o){
+    //Two main flows of logic
+    //  - Matches a market order with a limit order
+    //  - tries to match two limit orders, if it doesn't skip forward
+
+    //Buys take liquidity from the sell side, from the lowest price up. Sells the reverse
+    Ladder& ladder = (S == Side::BUY) ? limitSell : limitBuy;
+
+    //Market orders cross at every price, limit orders only up to their own tick
+    [[maybe_unused]] const Ticks limitTick = o.tgtPrice;
+
+    //Iterates through the price levels, best first
+    while (!ladder.empty()){
+        const long long tick = (S == Side::BUY) ? ladder.lowest() : ladder.highest();
+
+        // Checks if it can cross the book instantly (for limit orders)
+        if constexpr (IsLimit){
+            const bool canCross = (S == Side::BUY) ? limitTick >= tick : limitTick <= tick;
+            if (!canCross){return;}
+        }
+
+        PriceLevel& level = ladder.at(tick);
+
+        // Reaches past the best level: sweep every level it takes in full, then fill the one it stops in
+        if (o.unexecQuantity > level.quantity){
+            if constexpr (IsLimit) {sweep<S>(o,ladder,limitTick);}
+            else {sweep<S>(o,ladder,(S == Side::BUY) ? std::numeric_limits<Ticks>::max() : std::numeric_limits<Ticks>::lowest());}
+            if (o.unexecQuantity == 0) return;
+            continue;
+        }
+
+        //Iterates through the orders at the price level, removing them as they're filled
+        while (!level.empty()){
+            const uint32_t n = level.head;
+            Order& limit = nodes[n].order;
+
+            // Amount of quantity that can be executed with this limit order
+            const Qty qtyToExec = std::min(o.unexecQuantity,limit.unexecQuantity);
+            limit.exec(qtyToExec,limit.tgtPrice);
+            o.exec(qtyToExec,limit.tgtPrice);
+            events.onFill(o,limit,qtyToExec,toPrice(limit.tgtPrice));
+            lastTrade = limit.tgtPrice;
+            level.quantity -= qtyToExec;
+
+            //If the limit order full executed, it leaves the front of the queue
+            if (limit.unexecQuantity == 0) {
+                level.head = nodes[n].next;
+                if (level.empty()) {level.tail = PriceLevel::nil;}
+                else {nodes[level.head].prev = PriceLevel::nil;}
+                --level.orders;
+                events.onComplete(limit);
+                retire(n);
+            }
+
+            //If the liqudity searching order is fully executed, end matching
+            if (o.unexecQuantity == 0) break;
+        }
+
+        //If no more orders at price level, remove the price level
+        if (level.empty()) {ladder.vacate(tick);}
+        if (o.unexecQuantity == 0) return;
+    }
+    // Failed execution. Liquidity exhausted
+}
+
+template<typename Policy>
+template<Side S>
+void BasicBook<Policy>::sweep(Order& o, Ladder& ladder, const Ticks stop){
+    // Gathers the best levels a block at a time, and a prefix sum of their quantities says how many o clears.
+    // Those are emptied without the per order size checks and relinking of the matching loop.
+    // Returns at the first level o would only part fill, or when it runs out of levels up to stop
+
+    constexpr std::size_t block = 8;
+    std::array<long long,block> ticks;
+    std::array<const PriceLevel*,block> levels;
+    std::array<int64_t,block> quantities;
+    for (;;){
+        const std::size_t n = ladder.template bestTicks<S == Side::BUY>(ticks,stop);
+        for (std::size_t i = 0; i < n; ++i){
+            levels[i] = &ladder.at(ticks[i]);
+            quantities[i] = levels[i]->quantity;
+        }
+
+        const std::size_t cleared = levelsCleared(std::span<const int64_t>(quantities.data(),n),o.unexecQuantity);
+        if (cleared == 0) return;
+        // Each cleared level's queue is a pointer chase, start its first load now
+        for (std::size_t i = 0; i < cleared; ++i) {__builtin_prefetch(&nodes[levels[i]->head]);}
+        for (std::size_t i = 0; i < cleared; ++i) {clearLevel(o,*levels[i],ticks[i]);}
+        lastTrade = ticks[cleared - 1];
+        ladder.template vacateBest<S == Side::BUY>(std::span<const long long>(ticks.data(),cleared));
+        if (cleared < block) return;
+    }
+}
+
+template<typename Policy>
+void BasicBook<Policy>::clearLevel(Order& o, const PriceLevel& level, const Ticks tick){
+    // Every maker fills in full, so there's no size check per order and the queue isn't relinked as it empties.
+    // Events go out exactly as the matching loop would send them
+
+    const Price price = toPrice(tick);
+    for (uint32_t n = level.head; n != PriceLevel::nil;){
+        const uint32_t next = nodes[n].next;
+        if (next != PriceLevel::nil) {__builtin_prefetch(&nodes[next]);}
+        Order& limit = nodes[n].order;
+        const Qty qtyToExec = limit.unexecQuantity;
+        limit.exec(qtyToExec,tick);
+        o.exec(qtyToExec,tick);
+        events.onFill(o,limit,qtyToExec,price);
+        events.onComplete(limit);
+        retire(n);
+        n = next;
+    }
+}
+
+// Instantiated once, in Book.cpp
+extern template class BasicBook<DefaultPolicy>;
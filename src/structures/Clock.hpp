@@ -0,0 +1,32 @@
+// Clock sources the Book stamps accepted orders with, picked by Policy::Clock
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "TscClock.hpp"
+
+// A clock is anything with a uint64_t now(). The Book holds one by value and reads it once per accepted order.
+// TscClock (TscClock.hpp) is the cheapest, raw cycle counter ticks
+
+struct SteadyClock{
+// Nanoseconds on std::chrono::steady_clock. Portable, a vDSO call per read
+    [[nodiscard]] static uint64_t now() noexcept {
+        using namespace std::chrono;
+        return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+class ManualClock{
+// Reads whatever it was last set to, so tests and replays get the same timestamps every run
+    uint64_t t = 0;
+
+public:
+    ManualClock() noexcept = default;
+    explicit ManualClock(const uint64_t start) noexcept : t(start) {}
+
+    [[nodiscard]] uint64_t now() const noexcept {return t;}
+    void set(const uint64_t v) noexcept {t = v;}
+    void advance(const uint64_t by = 1) noexcept {t += by;}
+};
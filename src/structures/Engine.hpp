@@ -0,0 +1,177 @@
+// The ShardedEngine class, many instruments' Books spread across shard threads, each fed by its own ring
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Book.hpp"
+#include "LatencyHistogram.hpp"
+#include "OrderCommand.hpp"
+#include "OrderIndex.hpp"
+#include "PreTrade.hpp"
+#include "Ring.hpp"
+#include "SpscQ.hpp"
+#include "TscClock.hpp"
+
+struct InstrumentSpec{
+// One tradeable instrument and its matching parameters
+    uint16_t id;
+    double tickSize;      // Price increment, limit prices are rounded to it
+    RiskLimits risk = {}; // Pre-trade limits, commands that break them are rejected before the Book
+    BookConfig book = {}; // Storage for this instrument's Book. Its tickSize is replaced by the one above
+};
+
+template<typename Policy = DefaultPolicy, typename Queue = SpscQ<OrderCommand, 16'384>>
+class ShardedEngine{
+// Owns one Book per instrument, split across shards. Each shard is one matching thread with its own input queue,
+// and only that thread touches its Books, so matching needs no locks and Books on different shards never share lines.
+// Instruments are dealt to shards round robin in the order they're given.
+// The router (route) runs on the producer side: with the default SpscQ there must be a single producer thread,
+// an MpscQ Queue allows several.
+public:
+    using Book = BasicBook<Policy>;
+
+private:
+
+    struct Instrument{
+        InstrumentSpec spec;
+        PreTradeCheck check;
+        std::unique_ptr<Book> book;
+    };
+
+    struct alignas(cacheLine) Shard{
+        Queue queue;                          // Commands for the instruments this shard owns
+        std::vector<Instrument> instruments;
+        OrderIndex local;                     // Instrument ID -> position in instruments
+        std::atomic<uint64_t> processed = 0;  // Commands handled, including rejects. Written by the shard thread only
+        std::atomic<uint64_t> rejected = 0;   // Failed pre-trade checks and unknown instruments
+        PipelineLatency latency;              // Every command this shard handled, rejects included
+        std::jthread thread;
+
+        explicit Shard(const std::size_t expected) : local(expected) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shardList;
+    OrderIndex routes; // Instrument ID -> shard
+
+    static void handle(Shard& s, const OrderCommand& c) {
+        // Pre-trade checks then the Book, on the shard's thread
+
+        const uint64_t picked = TscClock::now();
+        const uint32_t i = s.local.find(static_cast<int>(c.instrument));
+        if (i == OrderIndex::npos) {
+            s.rejected.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            Instrument& in = s.instruments[i];
+            if (in.check.check(c, *in.book) != RejectReason::NONE) {
+                s.rejected.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                in.book->apply(c);
+            }
+        }
+        s.latency.record(c.sent, picked, TscClock::now());
+        s.processed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void run(const std::stop_token& stop, Shard& s) {
+        // Shard thread. Drains whatever is queued before it exits
+
+        while (!stop.stop_requested()) {
+            if (auto c = s.queue.pop()) {handle(s, *c);}
+            else {std::this_thread::yield();}
+        }
+        while (auto c = s.queue.pop()) {handle(s, *c);}
+    }
+
+public:
+
+    // Throws std::invalid_argument if shards is 0 or two specs share an id
+    ShardedEngine(std::span<const InstrumentSpec> specs, const std::size_t shards)
+        : routes(specs.size()) {
+        if (shards == 0) {throw std::invalid_argument("ShardedEngine: needs at least one shard");}
+        for (std::size_t i = 0; i < shards; ++i) {
+            shardList.push_back(std::make_unique<Shard>(specs.size() / shards + 1));
+        }
+        for (std::size_t i = 0; i < specs.size(); ++i) {
+            if (routes.find(static_cast<int>(specs[i].id)) != OrderIndex::npos) {
+                throw std::invalid_argument("ShardedEngine: instrument " + std::to_string(specs[i].id) + " listed twice");
+            }
+            Shard& s = *shardList[i % shards];
+            BookConfig cfg = specs[i].book;
+            cfg.tickSize = specs[i].tickSize;
+            s.local.insert(static_cast<int>(specs[i].id), static_cast<uint32_t>(s.instruments.size()));
+            s.instruments.push_back({specs[i], PreTradeCheck(specs[i].risk), std::make_unique<Book>(cfg)});
+            routes.insert(static_cast<int>(specs[i].id), static_cast<uint32_t>(i % shards));
+        }
+    }
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    ~ShardedEngine() {stop();}
+
+    // Starts one matching thread per shard
+    void start() {
+        for (auto& s : shardList) {
+            s->thread = std::jthread([&shard = *s](const std::stop_token& st) {run(st, shard);});
+        }
+    }
+
+    // Stops the shard threads once their queues are drained
+    void stop() {
+        for (auto& s : shardList) {s->thread.request_stop();}
+        for (auto& s : shardList) {
+            if (s->thread.joinable()) {s->thread.join();}
+        }
+    }
+
+    bool route(const OrderCommand& c) {
+        // Producer side. Stamps c and queues it on the shard that owns its instrument.
+        // Returns false if the instrument is unknown or that shard's queue is full
+        const uint32_t s = routes.find(static_cast<int>(c.instrument));
+        if (s == OrderIndex::npos) {return false;}
+        OrderCommand stamped = c;
+        stamped.sent = TscClock::stamp();
+        return shardList[s]->queue.push(stamped);
+    }
+
+    [[nodiscard]] std::size_t shards() const noexcept {return shardList.size();}
+
+    [[nodiscard]] std::size_t shardOf(const uint32_t instrument) const noexcept {
+        // Shard owning instrument, or OrderIndex::npos
+        return routes.find(static_cast<int>(instrument));
+    }
+
+    // Commands handled and rejected across all shards. Safe to read while running
+    [[nodiscard]] uint64_t processed() const noexcept {
+        uint64_t n = 0;
+        for (const auto& s : shardList) {n += s->processed.load(std::memory_order_relaxed);}
+        return n;
+    }
+    [[nodiscard]] uint64_t rejected() const noexcept {
+        uint64_t n = 0;
+        for (const auto& s : shardList) {n += s->rejected.load(std::memory_order_relaxed);}
+        return n;
+    }
+
+    // Queue wait, Book and end to end latency of one shard's commands, in TscClock ticks.
+    // Percentiles can be read from any thread while the engine runs
+    [[nodiscard]] const PipelineLatency& latency(const std::size_t shard) const noexcept {return shardList[shard]->latency;}
+
+    Book* book(const uint32_t instrument) noexcept {
+        // The instrument's Book, or nullptr. Only safe to use while the engine is stopped
+        const uint32_t s = routes.find(static_cast<int>(instrument));
+        if (s == OrderIndex::npos) {return nullptr;}
+        Shard& shard = *shardList[s];
+        return shard.instruments[shard.local.find(static_cast<int>(instrument))].book.get();
+    }
+};
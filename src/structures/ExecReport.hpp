@@ -0,0 +1,116 @@
+// Execution reports out of the matching engine, published into a preallocated ring for another thread to drain
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "Order.hpp"
+#include "SpscQ.hpp"
+
+enum class ExecType : uint8_t{
+    FILL,         // Order fully filled by this execution
+    PARTIAL_FILL, // Order executed, with quantity still outstanding
+    REST,         // Limit order (remainder) added to the book
+    REJECT        // Order (remainder) dropped: market order out of liquidity, or the book is full
+};
+
+struct ExecEvent{
+// One execution report, from the point of view of orderID.
+// For fills, contraID is the order on the other side and qty/price are this execution's.
+// For rests and rejects, contraID is -1 and qty is the quantity resting or rejected.
+    double price;
+    int64_t qty;
+    int orderID;
+    int contraID;
+    ExecType type;
+    Side side;
+};
+
+static_assert(std::is_trivially_copyable_v<ExecEvent>, "ExecEvent is copied straight into the ring");
+static_assert(sizeof(ExecEvent) == 32, "ExecEvent should stay two to a cache line");
+
+enum class Overflow{
+    // What the matching thread does when the report ring is full
+    BACKPRESSURE, // Spin until the consumer frees a slot. No reports are lost, matching stalls
+    DROP          // Discard the report and count it. Matching never waits
+};
+
+template<std::size_t N>
+class ExecReportStream{
+// Owns the report ring and the drop counter, shared between the Book's sink (producer) and a drain thread (consumer)
+    SpscQ<ExecEvent, N> queue;
+    std::atomic<uint64_t> dropped = 0;
+
+    template<std::size_t, Overflow>
+    friend class ExecReportSink;
+
+public:
+    // Consumer side
+    std::optional<ExecEvent> pop() {return queue.pop();}
+
+    // Reports discarded because the ring was full (Overflow::DROP only). Safe to read from any thread
+    [[nodiscard]] uint64_t droppedCount() const noexcept {return dropped.load(std::memory_order_relaxed);}
+};
+
+template<std::size_t N, Overflow O = Overflow::DROP>
+class ExecReportSink{
+// Book event sink that turns fills, rests and rejects into ExecEvents on an ExecReportStream.
+// Each publish is one 32 byte copy into the ring, there's no allocation
+    ExecReportStream<N>* stream;
+
+    void publish(const ExecEvent& e) noexcept {
+        if constexpr (O == Overflow::BACKPRESSURE) {
+            stream->queue.push_wait(e);
+        } else {
+            if (!stream->queue.push(e)) {stream->dropped.fetch_add(1, std::memory_order_relaxed);}
+        }
+    }
+
+    template<typename Ord>
+    static ExecEvent fillFor(const Ord& o, const Ord& contra, const int64_t qty, const double price) noexcept {
+        const ExecType t = o.getUnexecQty() == 0 ? ExecType::FILL : ExecType::PARTIAL_FILL;
+        return ExecEvent{price, qty, o.getID(), contra.getID(), t, o.getSide()};
+    }
+
+public:
+    // Always bound to a stream, so a Book can't be built with a sink that has nowhere to publish
+    ExecReportSink() = delete;
+    explicit ExecReportSink(ExecReportStream<N>& s) noexcept : stream(&s) {}
+
+    template<typename Ord>
+    void onFill(const Ord& taker, const Ord& maker, const typename Ord::Qty qty, const typename Ord::Price price) noexcept {
+        // One report for each side of the execution
+        const auto q = static_cast<int64_t>(qty);
+        const auto p = static_cast<double>(price);
+        publish(fillFor(taker, maker, q, p));
+        publish(fillFor(maker, taker, q, p));
+    }
+
+    template<typename Ord>
+    void onRest(const Ord& o, const typename Ord::Price price) noexcept {
+        publish(ExecEvent{static_cast<double>(price), static_cast<int64_t>(o.getUnexecQty()),
+                          o.getID(), -1, ExecType::REST, o.getSide()});
+    }
+
+    template<typename Ord>
+    void onComplete(const Ord& o) noexcept {
+        // Fully filled orders were reported by their last fill. A market order that ran out of liquidity is rejected
+        if (o.getType() == OrderType::MARKET && o.getUnexecQty() != 0) {onReject(o, typename Ord::Price{0});}
+    }
+
+    template<typename Ord>
+    void onReject(const Ord& o, const typename Ord::Price price) noexcept {
+        const auto p = static_cast<double>(price);
+        publish(ExecEvent{p, static_cast<int64_t>(o.getUnexecQty()), o.getID(), -1, ExecType::REJECT, o.getSide()});
+    }
+};
+
+template<std::size_t N, Overflow O = Overflow::DROP>
+struct ReportingPolicy : DefaultPolicy{
+// The default engine, publishing execution reports to an ExecReportStream<N>
+    using Sink = ExecReportSink<N, O>;
+};
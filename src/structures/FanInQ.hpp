@@ -0,0 +1,45 @@
+// The FanInQ class, merges one SPSC ring per producer into a single consumer
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include "SpscQ.hpp"
+
+// FanInQ class
+// P producers, each with its own SpscQ, so producers never contend with each other.
+// The consumer polls the rings round robin, starting after the ring it last took from,
+// so a busy gateway can't starve a quiet one: any ring holding orders is served within P pops.
+// Each ring holds up to N - 1 orders
+template<typename O, std::size_t N, std::size_t P>
+class FanInQ {
+    static_assert(P != 0, "FanInQ needs at least one producer");
+
+    std::array<SpscQ<O, N>, P> rings;
+    std::size_t next = 0; // Ring the consumer polls first, only the consumer touches it
+
+public:
+
+    static constexpr std::size_t producers = P;
+
+    // Producer p's ring. Each producer thread must only use its own
+    SpscQ<O, N>& producer(const std::size_t p) noexcept {return rings[p];}
+
+    bool push(const std::size_t p, const O& o) {
+        // Producer p only. Returns false if its ring is full
+        return rings[p].push(o);
+    }
+
+    std::optional<O> pop() {
+        // Consumer thread only. Takes the next order from the first non-empty ring in round robin order
+
+        for (std::size_t i = 0; i < P; ++i) {
+            const std::size_t r = next;
+            next = next + 1 == P ? 0 : next + 1;
+            if (auto o = rings[r].pop()) {return o;}
+        }
+        return std::nullopt;
+    }
+};
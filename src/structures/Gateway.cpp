@@ -0,0 +1,46 @@
+#include "Gateway.hpp"
+
+#include <sys/un.h>
+
+namespace {
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Gateway: socket path empty or too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+std::runtime_error failure(const std::string& what, const std::string& path) {
+    return std::runtime_error("Gateway: " + what + " " + path + ": " + std::strerror(errno));
+}
+
+}
+
+int listenUnix(const std::string& path, const int backlog) {
+    const sockaddr_un addr = unixAddress(path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {throw failure("can't create a socket for", path);}
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, backlog) != 0) {
+        const std::runtime_error e = failure("can't listen on", path);
+        ::close(fd);
+        throw e;
+    }
+    return fd;
+}
+
+int connectUnix(const std::string& path) {
+    const sockaddr_un addr = unixAddress(path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {throw failure("can't create a socket for", path);}
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const std::runtime_error e = failure("can't connect to", path);
+        ::close(fd);
+        throw e;
+    }
+    return fd;
+}
@@ -0,0 +1,244 @@
+// The order entry Gateway, client sessions over Unix domain sockets decoded into the ingestion ring on one thread
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "OrderCommand.hpp"
+#include "Uring.hpp"
+#include "WireProtocol.hpp"
+
+// Listening Unix stream socket at path, replacing any file already there. Throws std::runtime_error on failure
+int listenUnix(const std::string& path, int backlog);
+
+// Connects to the Unix stream socket at path. Throws std::runtime_error on failure
+int connectUnix(const std::string& path);
+
+struct GatewayConfig{
+    std::string path;              // Unix socket path to listen on
+    std::size_t maxSessions = 4'096; // Sessions open at once, more are closed as they connect. At most 65536
+    unsigned ringEntries = 1'024;  // io_uring submission queue entries
+    unsigned buffers = 4'096;      // Receive buffers shared by every session, a power of 2 up to 32768
+    unsigned bufferSize = 4'096;   // Bytes in each
+};
+
+struct GatewayStats{
+// Counts since the Gateway was built
+    uint64_t accepted = 0;   // Sessions that connected
+    uint64_t refused = 0;    // Sessions closed on connect because maxSessions were already open
+    uint64_t closed = 0;     // Sessions that have ended
+    uint64_t messages = 0;   // Orders pushed into the ring
+    uint64_t malformed = 0;  // Messages that failed to decode, each ends its session
+    uint64_t bytes = 0;      // Received
+    uint64_t receives = 0;   // Receive completions, each one buffer of one or more messages
+    uint64_t syscalls = 0;   // io_uring_enter calls, each submitting a batch and reaping completions
+};
+
+template<typename Q>
+class Gateway{
+// Accepts client sessions and pushes every order they send into q, the matching thread's ring, from whichever
+// thread calls run(). Built on io_uring so that thread serves thousands of sessions with a handful of syscalls:
+//  - one multishot accept stays armed for every connection
+//  - each session has one multishot receive, armed once, that fills buffers from a shared BufferRing as data arrives,
+//    so idle sessions hold no buffer
+//  - everything queued while handling a batch of completions (new receives, closes) is submitted together with the
+//    wait for the next batch, one io_uring_enter per loop
+// Messages can straddle receives, the partial one is carried in the session. A message that doesn't decode ends its
+// session, the stream can't be trusted past it. The session's slot number is its participant ID.
+// When q is full, run() waits on it (q's claim_wait), the sockets fill and clients block: backpressure, nothing dropped
+    enum Op : uint64_t{ACCEPT, RECV, CLOSE};
+
+    struct Session{
+        int fd = -1;
+        bool broken = false;   // Sent a malformed message, shut down and waiting for its receive to end
+        uint32_t carried = 0;  // Bytes of a partial message held over from the last receive
+        std::array<std::byte, sizeof(WireOrder)> partial{};
+    };
+
+    GatewayConfig cfg;
+    Q& queue;
+    int listener = -1;
+    std::vector<Session> sessions;
+    std::vector<uint32_t> freeSlots;
+
+    // Written by run() only, readable from any thread
+    std::atomic<uint64_t> open = 0;
+    std::atomic<uint64_t> idle = 0;
+    std::atomic<uint64_t> accepted = 0, refused = 0, closed = 0, messages = 0, malformed = 0, bytes = 0, receives = 0;
+    std::atomic<uint64_t> enters = 0;
+
+    static void bump(std::atomic<uint64_t>& a, const uint64_t by = 1) noexcept {
+        a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static uint64_t tag(const Op op, const uint32_t slot) noexcept {return (uint64_t{op} << 32) | slot;}
+
+    void armAccept(Uring& ring) {
+        io_uring_sqe& e = ring.sqe();
+        e.opcode = IORING_OP_ACCEPT;
+        e.fd = listener;
+        e.ioprio = IORING_ACCEPT_MULTISHOT;
+        e.accept_flags = SOCK_CLOEXEC;
+        e.user_data = tag(ACCEPT, 0);
+    }
+
+    void armRecv(Uring& ring, const BufferRing& bufs, const uint32_t slot) {
+        io_uring_sqe& e = ring.sqe();
+        e.opcode = IORING_OP_RECV;
+        e.fd = sessions[slot].fd;
+        e.ioprio = IORING_RECV_MULTISHOT;
+        e.flags = IOSQE_BUFFER_SELECT;
+        e.buf_group = bufs.id();
+        e.user_data = tag(RECV, slot);
+    }
+
+    void closeSession(Uring& ring, const uint32_t slot) {
+        // Called once the session's receive has ended, so no completion can name the slot after it's reused
+        io_uring_sqe& e = ring.sqe();
+        e.opcode = IORING_OP_CLOSE;
+        e.fd = sessions[slot].fd;
+        e.user_data = tag(CLOSE, slot);
+        sessions[slot] = Session{};
+        freeSlots.push_back(slot);
+        bump(closed);
+        const uint64_t left = open.load(std::memory_order_relaxed) - 1;
+        open.store(left, std::memory_order_release);
+        if (left == 0) {idle.store(idle.load(std::memory_order_relaxed) + 1, std::memory_order_release);}
+    }
+
+    void deliver(Session& s, const uint32_t slot, const std::byte* msg) {
+        if (s.broken) {return;}
+        WireOrder m;
+        std::memcpy(&m, msg, sizeof(m));
+        OrderCommand c;
+        if (!fromWire(m, static_cast<uint16_t>(slot), c)) {
+            bump(malformed);
+            s.broken = true;
+            ::shutdown(s.fd, SHUT_RDWR); // Its receive completes with end of stream and the session closes
+            return;
+        }
+        *queue.claim_wait() = c;
+        queue.commit();
+        bump(messages);
+    }
+
+    void consume(const uint32_t slot, const std::byte* data, std::size_t n) {
+        // Cuts a received buffer into messages, finishing the one carried over first and carrying any partial one
+        Session& s = sessions[slot];
+        if (s.carried != 0) {
+            const std::size_t take = std::min<std::size_t>(sizeof(WireOrder) - s.carried, n);
+            std::memcpy(s.partial.data() + s.carried, data, take);
+            s.carried += static_cast<uint32_t>(take);
+            data += take;
+            n -= take;
+            if (s.carried < sizeof(WireOrder)) {return;}
+            deliver(s, slot, s.partial.data());
+            s.carried = 0;
+        }
+        for (; n >= sizeof(WireOrder); data += sizeof(WireOrder), n -= sizeof(WireOrder)) {deliver(s, slot, data);}
+        std::memcpy(s.partial.data(), data, n);
+        s.carried = static_cast<uint32_t>(n);
+    }
+
+    void onAccept(Uring& ring, const BufferRing& bufs, const io_uring_cqe& c) {
+        if ((c.flags & IORING_CQE_F_MORE) == 0) {armAccept(ring);}
+        if (c.res < 0) {return;}
+        bump(accepted);
+        if (freeSlots.empty()) {
+            bump(refused);
+            ::close(c.res);
+            return;
+        }
+        const uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        sessions[slot].fd = c.res;
+        open.store(open.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        armRecv(ring, bufs, slot);
+    }
+
+    void onRecv(Uring& ring, BufferRing& bufs, const io_uring_cqe& c) {
+        const auto slot = static_cast<uint32_t>(c.user_data);
+        const bool more = (c.flags & IORING_CQE_F_MORE) != 0;
+        if (c.res > 0) {
+            const auto bid = static_cast<uint16_t>(c.flags >> IORING_CQE_BUFFER_SHIFT);
+            bump(receives);
+            bump(bytes, static_cast<uint64_t>(c.res));
+            consume(slot, bufs.buffer(bid), static_cast<std::size_t>(c.res));
+            bufs.recycle(bid);
+            if (!more) {armRecv(ring, bufs, slot);}
+        } else if (c.res == -ENOBUFS) {
+            // Every buffer was in use. The ones recycled in this batch are published before the rearm is submitted
+            armRecv(ring, bufs, slot);
+        } else if (!more) {
+            closeSession(ring, slot);
+        }
+    }
+
+public:
+    Gateway(const GatewayConfig& c, Q& q) : cfg(c), queue(q), sessions(c.maxSessions) {
+        // Listens straight away, so clients can connect before run() starts. Throws std::runtime_error if it can't
+        if (cfg.maxSessions == 0 || cfg.maxSessions > 65'536) {
+            throw std::runtime_error("Gateway: maxSessions must be 1 to 65536");
+        }
+        if (cfg.bufferSize < sizeof(WireOrder)) {throw std::runtime_error("Gateway: bufferSize below one message");}
+        listener = listenUnix(cfg.path, 4'096);
+        freeSlots.reserve(cfg.maxSessions);
+        for (std::size_t i = cfg.maxSessions; i > 0; --i) {freeSlots.push_back(static_cast<uint32_t>(i - 1));}
+    }
+
+    ~Gateway() {
+        for (const Session& s : sessions) {if (s.fd >= 0) {::close(s.fd);}}
+        ::close(listener);
+        ::unlink(cfg.path.c_str());
+    }
+
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    void run(const std::stop_token stop) {
+        // Serves sessions until stop is requested, checked at least every 10ms. The ring and buffers are built
+        // here, on the thread that uses them. Throws std::runtime_error if io_uring isn't available
+        Uring ring(cfg.ringEntries);
+        BufferRing bufs(ring, 0, cfg.buffers, cfg.bufferSize);
+        armAccept(ring);
+
+        while (!stop.stop_requested()) {
+            ring.submitAndWait(1, std::chrono::milliseconds(10));
+            ring.drain([&](const io_uring_cqe& c) {
+                switch (static_cast<Op>(c.user_data >> 32)) {
+                case ACCEPT: onAccept(ring, bufs, c); break;
+                case RECV:   onRecv(ring, bufs, c); break;
+                case CLOSE:  break;
+                }
+            });
+            bufs.publish();
+            enters.store(ring.syscalls(), std::memory_order_relaxed);
+        }
+    }
+
+    // Sessions connected right now
+    [[nodiscard]] uint64_t openSessions() const noexcept {return open.load(std::memory_order_acquire);}
+
+    // Times the last open session closed. Every order those sessions sent is in the ring by the time this counts it
+    [[nodiscard]] uint64_t idlePeriods() const noexcept {return idle.load(std::memory_order_acquire);}
+
+    [[nodiscard]] GatewayStats stats() const noexcept {
+        const auto get = [](const std::atomic<uint64_t>& a) {return a.load(std::memory_order_relaxed);};
+        return {get(accepted), get(refused), get(closed), get(messages), get(malformed), get(bytes), get(receives),
+                get(enters)};
+    }
+};
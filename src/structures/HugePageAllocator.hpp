@@ -0,0 +1,47 @@
+// Allocator for large, randomly accessed arrays (e.g. the PriceLadder tick window)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+template<typename T>
+struct HugePageAllocator {
+// Backs allocations of 2MB or more with 2MB aligned memory and asks the kernel for transparent huge pages.
+// A sparse price window touches a different 4K page on almost every lookup, so the TLB misses
+// cost more than the cache misses. Smaller allocations fall through to the default allocator.
+    using value_type = T;
+
+    static constexpr std::size_t hugePage = std::size_t{1} << 21;
+
+    HugePageAllocator() noexcept = default;
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    T* allocate(const std::size_t n) {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes < hugePage) {return std::allocator<T>{}.allocate(n);}
+
+        const std::size_t rounded = (bytes + hugePage - 1) & ~(hugePage - 1);
+        void* p = std::aligned_alloc(hugePage, rounded);
+        if (p == nullptr) {throw std::bad_alloc();}
+#ifdef MADV_HUGEPAGE
+        madvise(p, rounded, MADV_HUGEPAGE); // Only a hint, fine if it fails
+#endif
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, const std::size_t n) noexcept {
+        if (n * sizeof(T) < hugePage) {std::allocator<T>{}.deallocate(p, n); return;}
+        std::free(p);
+    }
+
+    template<typename U>
+    bool operator==(const HugePageAllocator<U>&) const noexcept {return true;}
+};
@@ -0,0 +1,241 @@
+#include "Journal.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+struct JournalHeader{
+    char magic[8];      // journalMagic
+    uint32_t version;   // journalVersion
+    uint32_t entrySize; // sizeof(JournalEntry)
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(JournalHeader) == 32, "JournalHeader is the on-disk layout");
+
+constexpr std::size_t groupMax = 65'536; // Most entries written between two syncs
+constexpr std::size_t batch = 1'024;     // Entries drained from the ring per write
+
+constexpr std::array<uint32_t, 256> crcTable = [] {
+    // Reflected CRC-32C (Castagnoli) table, for when the SSE4.2 instruction isn't available
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {c = (c & 1U) ? (c >> 1) ^ 0x82F63B78U : c >> 1;}
+        t[i] = c;
+    }
+    return t;
+}();
+
+uint32_t entryCrc(const JournalEntry& e) noexcept {
+    // Covers everything before the crc field
+    return crc32c(&e, offsetof(JournalEntry, crc));
+}
+
+bool writeAll(const int fd, const void* data, std::size_t len) noexcept {
+    // write(2) until everything is out, or an error. A signal landing mid-write isn't one
+    const auto* p = static_cast<const char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {continue;}
+            return false;
+        }
+        p += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool syncData(const int fd) noexcept {
+    // fdatasync(2), retried if a signal interrupts it
+    int r = 0;
+    do {r = ::fdatasync(fd);} while (r != 0 && errno == EINTR);
+    return r == 0;
+}
+
+#if defined(__x86_64__)
+// The crc32 instruction is SSE4.2. Only this function is built for it, and only called when the CPU has it,
+// so the rest of the binary still runs on any x86-64
+__attribute__((target("sse4.2")))
+uint32_t crc32cWords(const unsigned char*& p, std::size_t& len, const uint32_t crc) noexcept {
+    // Folds in whole 8 byte words, leaving p and len at the tail
+    uint64_t c = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    return static_cast<uint32_t>(c);
+}
+
+const bool hasCrc32 = [] {
+    __builtin_cpu_init(); // May run before the CPU model is read at startup
+    return __builtin_cpu_supports("sse4.2") != 0;
+}();
+#endif
+
+}
+
+uint32_t crc32c(const void* data, std::size_t len) noexcept {
+    const auto* p = static_cast<const unsigned char*>(data);
+    uint32_t crc = 0xFFFFFFFFU;
+#if defined(__x86_64__)
+    if (hasCrc32) {crc = crc32cWords(p, len, crc);}
+#endif
+    for (; len > 0; --len, ++p) {crc = crcTable[(crc ^ *p) & 0xFFU] ^ (crc >> 8);}
+    return ~crc;
+}
+
+JournalReader::JournalReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {throw std::runtime_error("JournalReader: can't open " + path);}
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(JournalHeader)) {
+        ::close(fd);
+        throw std::runtime_error("JournalReader: " + path + " is too short for a journal");
+    }
+    bytes = static_cast<std::size_t>(st.st_size);
+
+    void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {throw std::runtime_error("JournalReader: can't map " + path);}
+    base = static_cast<const std::byte*>(p);
+    ::madvise(p, bytes, MADV_SEQUENTIAL);
+
+    JournalHeader h{};
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, journalMagic, sizeof(journalMagic)) != 0 || h.version != journalVersion ||
+        h.entrySize != sizeof(JournalEntry)) {
+        ::munmap(p, bytes);
+        throw std::runtime_error("JournalReader: " + path + " isn't a version " + std::to_string(journalVersion) + " journal");
+    }
+
+    // Valid prefix: in sequence, with a matching checksum
+    const std::size_t entries = (bytes - sizeof(JournalHeader)) / sizeof(JournalEntry);
+    while (count < entries) {
+        const JournalEntry& e = (*this)[count];
+        if (e.seq != count + 1 || e.crc != entryCrc(e)) {break;}
+        ++count;
+    }
+}
+
+JournalReader::~JournalReader() {
+    ::munmap(const_cast<std::byte*>(base), bytes);
+}
+
+std::size_t JournalReader::validBytes() const noexcept {
+    return sizeof(JournalHeader) + count * sizeof(JournalEntry);
+}
+
+const JournalEntry& JournalReader::operator[](const std::size_t i) const noexcept {
+    return reinterpret_cast<const JournalEntry*>(base + sizeof(JournalHeader))[i];
+}
+
+Journal::Journal(const std::string& path, const bool syncWrites)
+    : ring(std::make_unique<SpscQ<OrderCommand, ringSize>>()), sync(syncWrites) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {throw std::runtime_error("Journal: can't open " + path);}
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Journal: can't stat " + path);
+    }
+
+    if (st.st_size == 0) {
+        JournalHeader h{};
+        std::memcpy(h.magic, journalMagic, sizeof(journalMagic));
+        h.version = journalVersion;
+        h.entrySize = sizeof(JournalEntry);
+        if (!writeAll(fd, &h, sizeof(h))) {
+            ::close(fd);
+            throw std::runtime_error("Journal: can't write header to " + path);
+        }
+    } else {
+        // Continue after the last valid entry, cutting off anything a crash left half written
+        std::size_t valid = 0;
+        try {
+            const JournalReader existing(path);
+            first = existing.size() + 1;
+            valid = existing.validBytes();
+        } catch (const std::runtime_error&) {
+            ::close(fd);
+            throw;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(valid)) != 0 || ::lseek(fd, 0, SEEK_END) < 0) {
+            ::close(fd);
+            throw std::runtime_error("Journal: can't truncate " + path);
+        }
+    }
+    durable.store(first - 1, std::memory_order_relaxed);
+
+    writer = std::jthread([this](const std::stop_token& st) {run(st);});
+}
+
+Journal::~Journal() {
+    // The writer drains the ring before it exits
+    writer.request_stop();
+    queued.notify();
+    writer.join();
+    ::close(fd);
+}
+
+void Journal::flush() const noexcept {
+    const uint64_t target = nextSeq() - 1;
+    synced.await([&] {return durableSeq() >= target || failed();});
+}
+
+void Journal::run(const std::stop_token& stop) {
+    // Writer thread. Each pass writes everything queued (up to groupMax entries) then syncs once
+
+    std::vector<OrderCommand> cmds(batch);
+    std::vector<JournalEntry> out(batch);
+    uint64_t seq = first - 1; // Last sequence number written
+
+    for (;;) {
+        std::size_t group = 0;
+        while (group < groupMax) {
+            const std::size_t n = ring->pop_n(cmds);
+            if (n == 0) {break;}
+            for (std::size_t i = 0; i < n; ++i) {
+                JournalEntry& e = out[i];
+                e = JournalEntry{++seq, encode(cmds[i]), 0, 0};
+                e.crc = entryCrc(e);
+            }
+            if (!writeAll(fd, out.data(), n * sizeof(JournalEntry))) {
+                error.store(true, std::memory_order_release);
+                synced.notify();
+                return;
+            }
+            group += n;
+        }
+
+        if (group == 0) {
+            if (stop.stop_requested()) {return;}
+            queued.await([&] {return ring->peek() != nullptr || stop.stop_requested();});
+            continue;
+        }
+        if (sync && !syncData(fd)) {
+            error.store(true, std::memory_order_release);
+            synced.notify();
+            return;
+        }
+        durable.store(seq, std::memory_order_release);
+        synced.notify();
+    }
+}
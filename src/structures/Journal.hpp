@@ -0,0 +1,135 @@
+// Write-ahead journal of the commands applied to a Book, for rebuilding it after a crash
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "Book.hpp"
+#include "OrderCommand.hpp"
+#include "OrderFlow.hpp"
+#include "SpscQ.hpp"
+#include "WaitStrategy.hpp"
+
+struct JournalEntry{
+// One command on disk. seq counts up from 1 with no gaps, crc covers seq and record
+    uint64_t seq;
+    FlowRecord record;
+    uint32_t crc;
+    uint32_t pad;
+};
+
+static_assert(std::is_trivially_copyable_v<JournalEntry> && sizeof(JournalEntry) == 48, "JournalEntry is the on-disk layout");
+
+inline constexpr char journalMagic[8] = {'O','B','J','R','N','L','\0','\0'};
+inline constexpr uint32_t journalVersion = 1;
+
+// CRC-32C of len bytes
+uint32_t crc32c(const void* data, std::size_t len) noexcept;
+
+class JournalReader{
+// Maps a journal read only and finds its valid prefix: entries in sequence whose checksum matches.
+// A crash mid-write leaves a torn or garbage tail, which is ignored. Throws std::runtime_error if the file
+// can't be mapped or isn't a journal
+    const std::byte* base = nullptr;
+    std::size_t bytes = 0;
+    uint64_t count = 0;
+
+public:
+    explicit JournalReader(const std::string& path);
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // Number of valid entries, which is also the last valid sequence number
+    [[nodiscard]] uint64_t size() const noexcept {return count;}
+
+    // File length covering the header and the valid entries
+    [[nodiscard]] std::size_t validBytes() const noexcept;
+
+    [[nodiscard]] const JournalEntry& operator[](std::size_t i) const noexcept;
+
+    template<typename Policy>
+    uint64_t replay(BasicBook<Policy>& b) const {
+        // Applies every valid entry to b in sequence order. Returns how many were applied
+        OrderCommand c{};
+        uint64_t applied = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!decode((*this)[i].record, c)) {continue;}
+            b.apply(c);
+            ++applied;
+        }
+        return applied;
+    }
+};
+
+// Rebuilds b from the journal at path, returns the number of commands replayed.
+// Matching is deterministic, so b ends up with the same levels, queue order, quantities and sequence numbers as after
+// the last durable command. Timestamps aren't journaled: replayed orders are stamped by b's clock as they're applied
+template<typename Policy>
+uint64_t recover(const std::string& path, BasicBook<Policy>& b) {
+    return JournalReader(path).replay(b);
+}
+
+class Journal{
+// Appends the commands the matching thread applies to a journal file. Append after the pre-trade check passes, in the
+// same stage that applies, so a rejected command is never replayed.
+// append only copies the command into a ring, a background writer thread drains the ring, checksums and writes
+// the entries, and syncs them to disk in groups: everything that arrived while the last sync ran goes in the next one.
+// The matching thread never waits on disk unless the ring fills up. An idle writer sleeps on a futex rather than
+// spinning, so each append pays a fence to check for it.
+// Opening an existing journal drops any torn tail and continues its sequence
+public:
+    static constexpr std::size_t ringSize = std::size_t{1} << 16;
+
+    // sync false skips fdatasync, so entries are only as durable as the page cache
+    explicit Journal(const std::string& path, bool sync = true);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    void append(const OrderCommand& c) noexcept {
+        // Matching thread only. Spins if the writer has fallen a whole ring behind, unless it has failed
+        OrderCommand* slot = nullptr;
+        while ((slot = ring->claim()) == nullptr) {
+            if (failed()) {return;}
+        }
+        *slot = c;
+        ring->commit();
+        queued.notify();
+        ++appended;
+    }
+
+    // Sequence number the next append will get
+    [[nodiscard]] uint64_t nextSeq() const noexcept {return first + appended;}
+
+    // Highest sequence number that's written (and synced, if sync is on). Safe to read from any thread
+    [[nodiscard]] uint64_t durableSeq() const noexcept {return durable.load(std::memory_order_acquire);}
+
+    // Matching thread only. Blocks until everything appended so far is durable, or the writer has failed
+    void flush() const noexcept;
+
+    // True once a write or sync has failed. durableSeq stops advancing and the journal should be treated as lost
+    [[nodiscard]] bool failed() const noexcept {return error.load(std::memory_order_acquire);}
+
+private:
+    std::unique_ptr<SpscQ<OrderCommand, ringSize>> ring;
+    int fd = -1;
+    bool sync;
+    uint64_t first = 1;    // Sequence number of the first append through this object
+    uint64_t appended = 0; // Matching thread only
+    alignas(cacheLine) std::atomic<uint64_t> durable = 0;
+    std::atomic<bool> error = false;
+    FutexWait<> queued;        // The writer sleeps here while the ring is empty
+    mutable FutexWait<> synced; // flush sleeps here until the writer catches up
+    std::jthread writer;
+
+    void run(const std::stop_token& stop);
+};
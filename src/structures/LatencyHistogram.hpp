@@ -0,0 +1,117 @@
+// The LatencyHistogram class, fixed memory latency distributions the matching thread records into as it runs
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "TscClock.hpp"
+
+class LatencyHistogram{
+// HDR style log-linear histogram. Values below 2^subBits get a bucket each, above that every power of two is split
+// into 2^(subBits - 1) buckets, so any value is held to within 1/128 and the whole uint64 range fits in ~7.4K
+// counters (59KB). Nothing is allocated or clamped while recording.
+// One thread records. The counters are atomics bumped with a relaxed load and store rather than a locked add,
+// so any other thread can read counts and percentiles while recording goes on, each counter as of some recent moment
+
+public:
+    static constexpr unsigned subBits = 8;
+    static constexpr std::size_t buckets = (64 - subBits) * (std::size_t{1} << (subBits - 1)) + (std::size_t{1} << subBits);
+
+private:
+    std::array<std::atomic<uint64_t>, buckets> counts{};
+    std::atomic<uint64_t> total = 0;
+    std::atomic<uint64_t> sum = 0;
+    std::atomic<uint64_t> largest = 0;
+
+    static void bump(std::atomic<uint64_t>& a, const uint64_t by) noexcept {
+        // Single writer, so no read-modify-write needed
+        a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+public:
+    [[nodiscard]] static constexpr std::size_t bucketOf(const uint64_t v) noexcept {
+        if (v < (uint64_t{1} << subBits)) {return static_cast<std::size_t>(v);}
+        const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - subBits;
+        return (std::size_t{shift} << (subBits - 1)) + static_cast<std::size_t>(v >> shift);
+    }
+
+    [[nodiscard]] static constexpr uint64_t highestIn(const std::size_t bucket) noexcept {
+        // Largest value that lands in bucket
+        if (bucket < (std::size_t{1} << subBits)) {return bucket;}
+        const unsigned shift = static_cast<unsigned>(bucket >> (subBits - 1)) - 1;
+        const uint64_t mantissa = bucket - (std::size_t{shift} << (subBits - 1));
+        return ((mantissa + 1) << shift) - 1; // Wraps to the uint64 max for the top bucket
+    }
+
+    // Recording thread only
+    void record(const uint64_t v) noexcept {
+        bump(counts[bucketOf(v)], 1);
+        bump(total, 1);
+        bump(sum, v);
+        if (v > largest.load(std::memory_order_relaxed)) {largest.store(v, std::memory_order_relaxed);}
+    }
+
+    // Adds other's values to this one, as if they'd been recorded here too.
+    // Recording thread only, and other must not be recording
+    void merge(const LatencyHistogram& other) noexcept {
+        for (std::size_t b = 0; b < buckets; ++b) {bump(counts[b], other.counts[b].load(std::memory_order_relaxed));}
+        bump(total, other.count());
+        bump(sum, other.sum.load(std::memory_order_relaxed));
+        if (other.max() > max()) {largest.store(other.max(), std::memory_order_relaxed);}
+    }
+
+    // Recording thread only, or while nothing records
+    void reset() noexcept {
+        for (auto& c : counts) {c.store(0, std::memory_order_relaxed);}
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        largest.store(0, std::memory_order_relaxed);
+    }
+
+    // Safe from any thread
+    [[nodiscard]] uint64_t count() const noexcept {return total.load(std::memory_order_relaxed);}
+    [[nodiscard]] uint64_t max() const noexcept {return largest.load(std::memory_order_relaxed);}
+    [[nodiscard]] double mean() const noexcept {
+        const uint64_t n = count();
+        return n == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(n);
+    }
+
+    [[nodiscard]] uint64_t percentile(const double p) const noexcept {
+        // Smallest bucket top that at least p percent of the values are at or below, capped at max. 0 when empty.
+        // Safe from any thread: counts only grow, so a concurrent record can only end the scan early
+        uint64_t n = 0;
+        for (const auto& c : counts) {n += c.load(std::memory_order_relaxed);}
+        if (n == 0) {return 0;}
+
+        const auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(n) + 0.5);
+        uint64_t seen = 0;
+        for (std::size_t b = 0; b < buckets; ++b) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen >= rank && seen != 0) {
+                const uint64_t top = highestIn(b);
+                const uint64_t m = max();
+                return top < m ? top : m;
+            }
+        }
+        return max();
+    }
+};
+
+struct PipelineLatency{
+// Where a command's time goes on the matching thread, in TscClock ticks
+    LatencyHistogram queueWait; // From the producer's stamp to the matching thread picking the command up
+    LatencyHistogram book;      // Applying it to the Book
+    LatencyHistogram endToEnd;  // From the stamp to applied
+
+    void record(const uint32_t stamp, const uint64_t picked, const uint64_t done) noexcept {
+        // Matching thread only. picked and done are TscClock::now() either side of the Book call
+        const uint64_t waited = TscClock::since(stamp, picked);
+        queueWait.record(waited);
+        book.record(done - picked);
+        endToEnd.record(waited + (done - picked));
+    }
+};
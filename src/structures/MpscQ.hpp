@@ -0,0 +1,83 @@
+// The MpscQ class, a bounded queue for several producer threads (gateways) feeding one consumer (the matcher)
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+#include "Ring.hpp"
+
+template<typename, std::size_t>
+class TestMpscHelper;
+
+// MpscQ class
+// Multi Producer Single Consumer Queue, same push/pop interface as SpscQ.
+// Each slot carries a sequence number saying whose turn it is: producers race for a position with a CAS on tail,
+// write the slot, then publish it by bumping its sequence. The single consumer needs no CAS at all.
+// Holds up to N orders. N must be a power of two
+template<typename O, std::size_t N>
+class MpscQ {
+    static_assert(N != 0 && (N & (N - 1)) == 0, "MpscQ size must be a power of two");
+
+    friend class TestMpscHelper<O,N>; // Helper class for unit tests
+
+    struct Slot {
+        std::atomic<std::size_t> seq; // == position when free for that producer, position + 1 once written
+        O value;
+    };
+
+    //Producers' shared cache line
+    alignas(cacheLine) std::atomic<std::size_t> tail = 0;
+
+    //Consumer's cache line, only it touches head so it isn't atomic
+    alignas(cacheLine) std::size_t head = 0;
+
+    alignas(cacheLine) std::array<Slot, N> buffer;
+
+public:
+
+    MpscQ() {
+        for (std::size_t i = 0; i < N; ++i) {buffer[i].seq.store(i, std::memory_order_relaxed);}
+    }
+
+    MpscQ(const MpscQ&) = delete;
+    MpscQ& operator=(const MpscQ&) = delete;
+
+    bool push(const O& o) {
+        // Any thread. Returns false if the queue is full
+
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = buffer[pos & (N - 1)];
+            const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                // Slot is free for this position, try to take it. On failure pos is reloaded
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = o;
+                    slot.seq.store(pos + 1, std::memory_order_release); // Publishes the slot to the consumer
+                    return true;
+                }
+            } else if (seq < pos) {
+                // Still holds the entry from a lap ago, the consumer hasn't reached it
+                return false;
+            } else {
+                // Another producer took this position first
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::optional<O> pop() {
+        // Consumer thread only. Returns nullopt if the queue is empty, or the next entry is claimed but not yet written
+
+        Slot& slot = buffer[head & (N - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != head + 1) {return std::nullopt;}
+
+        O o = slot.value;
+        slot.seq.store(head + N, std::memory_order_release); // Frees the slot for the producer a lap ahead
+        ++head;
+        return o;
+    }
+};
@@ -1,69 +1,172 @@
 #pragma once
 
 #include <iostream>
-#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
-enum class Side{
+#include "Policy.hpp"
+
+enum class Side : uint8_t{
     //Whether the instrument is being bought or sold
     BUY,
     SELL
 };
 
-enum class OrderType{
+enum class OrderType : uint8_t{
     // Two types of orders we're defining
     LIMIT,
     MARKET
 };
 
-class Order{
+template<typename Policy>
+class BasicBook;
+
+template<typename Policy = DefaultPolicy>
+class BasicOrder{
 // Defines my data structure for the orders
+// Price and quantity types and the tick size come from Policy. No virtual functions, so there's no vtable
+// and the Book can inline exec into its matching loop
+// Prices are held as fixed point Ticks, whole multiples of the tick, and executions accumulate an integer notional,
+// so matching compares and adds integers. Policy::Price is only what prices are converted from and to
 
+public:
+    using Price = typename Policy::Price;
+    using Qty = typename Policy::Qty;
+
+    static_assert(std::is_floating_point_v<Price>, "Price must be a floating point type, it's rounded to whole ticks");
 
 private:
     OrderType orderType;
     Side side;
-    double tgtPrice;
-    double execPrice; 
-    long long timestamp;
-    static constexpr double tickSize = 0.05;
+    uint16_t participant; // Who sent it, the Book counts each participant's resting orders
+    Ticks tgtPrice;     // Market orders hold the extreme of their side, so they cross every level
+    int64_t notional;   // Sum of quantity x price in ticks over every execution. Exact, the average price is
+                        // notional / execQuantity. Fits int64 while the value executed stays under 2^63 ticks
+    uint64_t timestamp; // The Book's clock when it accepted the order, 0 until then
+    uint64_t seq;       // Order the Book accepted it in, from 1. 0 until accepted
+    static constexpr Price tickSize = Policy::tickSize;
     int orderID;
-    int tgtQuantity;
-    int execQuantity;
-    int unexecQuantity;
-
+    Qty tgtQuantity;
+    Qty execQuantity;
+    Qty unexecQuantity;
 
-    static long long getCurrentTimestamp() noexcept;
 
-    static double roundToTickSize(double price) noexcept;
+    static Ticks toTicks(Price price) noexcept;
 
-    virtual void exec(int qty, double p);
-
-    virtual void notify() const;
+    void exec(Qty qty, Ticks p) noexcept;
 
 public: 
     friend class OrderTestHelper; //Gives my unit tests for Order class access
-    friend class Book; //Gives orderbook access to all attributes
+    friend class BasicBook<Policy>; //Gives orderbook access to all attributes
 
     //Default Constructor
-    Order()
-        : orderType(OrderType::LIMIT), side(Side::BUY), tgtPrice(0.0), execPrice(0.0),
-          timestamp(0), orderID(-1), tgtQuantity(0), execQuantity(0), unexecQuantity(0) {}
-
-    //Destructor
-    virtual ~Order() = default;
+    BasicOrder()
+        : orderType(OrderType::LIMIT), side(Side::BUY), participant(0), tgtPrice(0), notional(0),
+          timestamp(0), seq(0), orderID(-1), tgtQuantity(0), execQuantity(0), unexecQuantity(0) {}
 
     //Main Constructor
-    Order(int id, Side s, OrderType type,
-        int tgtQ, double tgtPrice = 0.0);
+    BasicOrder(int id, Side s, OrderType type,
+        Qty tgtQ, Price tgtPrice = 0, uint16_t participant = 0);
 
     // Getters
-    [[nodiscard]] double getPrice() const noexcept;
-    [[nodiscard]] int getUnexecQty() const noexcept;
+    // Prices are converted on the Policy's tick. Orders inside a Book on its own tick (BookConfig::tickSize) are in that
+    // Book's ticks, the Book passes converted prices to its sink
+    [[nodiscard]] Price getPrice() const noexcept;
+    [[nodiscard]] Ticks getTicks() const noexcept {return tgtPrice;}
+    [[nodiscard]] Price getExecPrice() const noexcept; // Average execution price, 0 before the first
+    [[nodiscard]] Qty getUnexecQty() const noexcept;
     [[nodiscard]] int getID() const noexcept;
+    [[nodiscard]] Side getSide() const noexcept {return side;}
+    [[nodiscard]] OrderType getType() const noexcept {return orderType;}
+    [[nodiscard]] uint16_t getParticipant() const noexcept {return participant;}
+    [[nodiscard]] uint64_t getTimestamp() const noexcept {return timestamp;}
+    [[nodiscard]] uint64_t getSeq() const noexcept {return seq;}
         
     //Prints for debugging
     void printOrder() const noexcept;
 
 };
 
-
+// The engine's default order type
+using Order = BasicOrder<DefaultPolicy>;
+
+
+template<typename Policy>
+inline Ticks BasicOrder<Policy>::toTicks(const Price price) noexcept {
+    // Used to round all order prices to the nearest tick, defined by tick size
+
+    return std::llround(price/tickSize);
+}
+
+template<typename Policy>
+inline void BasicOrder<Policy>::exec(const Qty qty, const Ticks prc) noexcept {
+    // Execution (full or partial) that updates the notional and quantities.
+    // Unchecked: the Book only calls it with 0 < qty <= unexecQuantity at a price the order accepts, and orders are
+    // screened before they reach the Book (PreTradeCheck), so the fill loop carries no validation branches.
+    // The Book reports completed orders through its event sink
+
+    // No division, the average price is only worked out when it's asked for
+    notional += static_cast<int64_t>(qty)*prc;
+    execQuantity += qty;
+    unexecQuantity -= qty;
+
+}
+
+// Constructor. Reads no clock, the Book stamps the order with a timestamp and sequence number when it accepts it
+template<typename Policy>
+BasicOrder<Policy>::BasicOrder(const int id, const Side s, const OrderType type,
+        const Qty tgtQ,const Price tgtP, const uint16_t participantID)
+    : orderType(type),
+    side(s),
+    participant(participantID),
+    tgtPrice(toTicks(tgtP)),
+    notional(0),
+    timestamp(0),
+    seq(0),
+    orderID(id),
+    tgtQuantity(tgtQ),
+    execQuantity(0),
+    unexecQuantity(tgtQ){
+        if (type == OrderType::MARKET){
+            //Market orders provide liquidity at all prices, this ensures that
+            if (s == Side::BUY){tgtPrice = std::numeric_limits<Ticks>::max();}
+            if (s == Side::SELL){tgtPrice = std::numeric_limits<Ticks>::lowest();}
+        }
+    }
+
+//Getters
+template<typename Policy>
+inline typename BasicOrder<Policy>::Price BasicOrder<Policy>::getPrice() const noexcept {
+    return static_cast<Price>(tgtPrice)*tickSize;
+}
+template<typename Policy>
+inline typename BasicOrder<Policy>::Price BasicOrder<Policy>::getExecPrice() const noexcept {
+    if (execQuantity == 0) {return 0;}
+    return static_cast<Price>(notional)/static_cast<Price>(execQuantity)*tickSize;
+}
+template<typename Policy>
+inline typename BasicOrder<Policy>::Qty BasicOrder<Policy>::getUnexecQty() const noexcept {return unexecQuantity;}
+template<typename Policy>
+inline int BasicOrder<Policy>::getID() const noexcept {return orderID;}
+
+//Prints the order for debugging
+template<typename Policy>
+void BasicOrder<Policy>::printOrder() const noexcept{
+
+    std::cout << "OrderID: " << orderID << "\n"
+              << "Side: " << (side == Side::BUY ? "Buy" : "Sell") << "\n"
+              << "Participant: " << participant << "\n"
+              << "Order Type: " << (orderType == OrderType::LIMIT ? "Limit" : "Market") << "\n"
+              << "Target Price: " << getPrice() << "\n"
+              << "Target Quantity: " << tgtQuantity << "\n"
+              << "Execution Price: " << getExecPrice() << "\n"
+              << "Execution Quantity: " << execQuantity << "\n"
+              << "Timestamp: " << timestamp << "\n"
+              << "Seq: " << seq << "\n"
+              << "---------------------------\n";
+}
+
+// Instantiated once, in Order.cpp. Members marked inline can still be inlined by callers
+extern template class BasicOrder<DefaultPolicy>;
@@ -0,0 +1,46 @@
+// The OrderCommand struct, what a producer sends the matching engine through the ingestion ring
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Order.hpp"
+
+enum class CommandType : uint8_t{
+    NEW,    // Add an order (limit or market)
+    CANCEL, // Pull a resting order
+    AMEND   // Change a resting order's quantity and price
+};
+
+struct alignas(32) OrderCommand{
+// Only what matching needs, so it's written into a ring slot and read back out in place.
+// The Book turns a NEW into an Order when it applies the command, there are no execution fields in flight.
+    double price;     // Limit price (NEW limit, AMEND). Ignored for market orders and cancels
+    int64_t qty;      // Order quantity (NEW), new unexecuted quantity (AMEND)
+    int orderID;
+    uint16_t instrument;  // Which Book, for an engine with several. A single Book ignores it
+    uint16_t participant; // Who sent it (NEW only), for per participant risk limits
+    CommandType command;
+    OrderType type;
+    Side side;
+    uint32_t sent = 0;   // TscClock::stamp() as the producer queued it, for the latency histograms. Fits the padding
+
+    static constexpr OrderCommand limit(const int id, const Side s, const int64_t q, const double p,
+                                        const uint16_t instr = 0, const uint16_t participant = 0) noexcept {
+        return {p, q, id, instr, participant, CommandType::NEW, OrderType::LIMIT, s};
+    }
+    static constexpr OrderCommand market(const int id, const Side s, const int64_t q, const uint16_t instr = 0,
+                                         const uint16_t participant = 0) noexcept {
+        return {0.0, q, id, instr, participant, CommandType::NEW, OrderType::MARKET, s};
+    }
+    static constexpr OrderCommand cancel(const int id, const uint16_t instr = 0) noexcept {
+        return {0.0, 0, id, instr, 0, CommandType::CANCEL, OrderType::LIMIT, Side::BUY};
+    }
+    static constexpr OrderCommand amend(const int id, const int64_t q, const double p, const uint16_t instr = 0) noexcept {
+        return {p, q, id, instr, 0, CommandType::AMEND, OrderType::LIMIT, Side::BUY};
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<OrderCommand>, "OrderCommand is copied straight into the ring");
+static_assert(sizeof(OrderCommand) == 32, "OrderCommand should stay two to a cache line");
@@ -0,0 +1,91 @@
+#include "OrderFlow.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t writeBuffer = std::size_t{1} << 20;
+
+FlowHeader makeHeader(const uint64_t count) noexcept {
+    FlowHeader h{};
+    std::memcpy(h.magic, flowMagic, sizeof(flowMagic));
+    h.version = flowVersion;
+    h.recordSize = sizeof(FlowRecord);
+    h.count = count;
+    return h;
+}
+
+}
+
+FlowWriter::FlowWriter(const std::string& path) : file(std::fopen(path.c_str(), "wb")) {
+    if (file == nullptr) {throw std::runtime_error("FlowWriter: can't open " + path);}
+    std::setvbuf(file, nullptr, _IOFBF, writeBuffer);
+
+    // Placeholder, the count is only known at close
+    const FlowHeader h = makeHeader(0);
+    if (std::fwrite(&h, sizeof(h), 1, file) != 1) {
+        std::fclose(file);
+        throw std::runtime_error("FlowWriter: can't write header to " + path);
+    }
+}
+
+FlowWriter::~FlowWriter() {
+    // Destructors can't throw, a failed close here just leaves an unfinished file
+    try {close();} catch (const std::runtime_error&) {}
+}
+
+void FlowWriter::write(const OrderCommand& c) {
+    const FlowRecord r = encode(c);
+    if (std::fwrite(&r, sizeof(r), 1, file) != 1) {throw std::runtime_error("FlowWriter: write failed");}
+    ++count;
+}
+
+void FlowWriter::close() {
+    if (file == nullptr) {return;}
+    const FlowHeader h = makeHeader(count);
+    const bool ok = std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, file) == 1;
+    const bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    if (!ok || !closed) {throw std::runtime_error("FlowWriter: can't finish file");}
+}
+
+FlowReader::FlowReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {throw std::runtime_error("FlowReader: can't open " + path);}
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FlowHeader)) {
+        ::close(fd);
+        throw std::runtime_error("FlowReader: " + path + " is too short for a flow file");
+    }
+    bytes = static_cast<std::size_t>(st.st_size);
+
+    void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file open
+    if (p == MAP_FAILED) {throw std::runtime_error("FlowReader: can't map " + path);}
+    base = static_cast<const std::byte*>(p);
+
+    // Replay reads front to back, let the kernel read ahead aggressively
+    ::madvise(p, bytes, MADV_SEQUENTIAL);
+
+    FlowHeader h{};
+    std::memcpy(&h, base, sizeof(h));
+    const bool valid = std::memcmp(h.magic, flowMagic, sizeof(flowMagic)) == 0 && h.version == flowVersion &&
+                       h.recordSize == sizeof(FlowRecord) &&
+                       h.count <= (bytes - sizeof(FlowHeader)) / sizeof(FlowRecord);
+    if (!valid) {
+        ::munmap(p, bytes);
+        throw std::runtime_error("FlowReader: " + path + " isn't a version " + std::to_string(flowVersion) + " flow file");
+    }
+    count = h.count;
+}
+
+FlowReader::~FlowReader() {
+    ::munmap(const_cast<std::byte*>(base), bytes);
+}
@@ -0,0 +1,130 @@
+// Binary order-flow files: a fixed record per order event, written by FlowWriter and replayed by FlowReader through mmap
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+#include "OrderCommand.hpp"
+
+enum class FlowEvent : uint8_t{
+    ADD,    // Limit order
+    MARKET, // Market order
+    CANCEL, // Cancel a resting order
+    AMEND   // Amend a resting order's quantity and price
+};
+
+struct FlowHeader{
+// Start of every flow file. Records follow straight after it
+    char magic[8];       // flowMagic
+    uint32_t version;    // flowVersion
+    uint32_t recordSize; // sizeof(FlowRecord), so a reader can reject files from a different layout
+    uint64_t count;      // Number of records
+    uint64_t reserved;
+};
+
+struct FlowRecord{
+// One order event on disk. Fixed width, little endian, with no pointers or enums wider than a byte,
+// so the file is read in place through the mapping
+    double price;        // Limit price for ADD and AMEND, 0 otherwise
+    int64_t qty;         // Order quantity for ADD and MARKET, new quantity for AMEND
+    int32_t orderID;
+    uint32_t instrument;
+    FlowEvent event;
+    uint8_t side;        // 0 buy, 1 sell
+    uint16_t participant;
+    uint8_t pad[4];
+};
+
+inline constexpr char flowMagic[8] = {'O','B','F','L','O','W','\0','\0'};
+inline constexpr uint32_t flowVersion = 1;
+
+static_assert(std::is_trivially_copyable_v<FlowRecord> && sizeof(FlowRecord) == 32, "FlowRecord is the on-disk layout");
+static_assert(sizeof(FlowHeader) == 32, "FlowHeader is the on-disk layout");
+
+inline FlowRecord encode(const OrderCommand& c) noexcept {
+    // Command to its on-disk record
+    FlowEvent e = FlowEvent::ADD;
+    if (c.command == CommandType::CANCEL) {e = FlowEvent::CANCEL;}
+    else if (c.command == CommandType::AMEND) {e = FlowEvent::AMEND;}
+    else if (c.type == OrderType::MARKET) {e = FlowEvent::MARKET;}
+    return FlowRecord{c.price, c.qty, c.orderID, c.instrument, e, static_cast<uint8_t>(c.side == Side::SELL),
+                      c.participant, {}};
+}
+
+[[nodiscard]] inline bool decode(const FlowRecord& r, OrderCommand& c) noexcept {
+    // Record straight into a command, e.g. a claimed ring slot.
+    // False, leaving c untouched, if the record is corrupt: an unknown event or side
+    if (r.side > 1) {return false;}
+    const Side s = r.side ? Side::SELL : Side::BUY;
+    const auto instr = static_cast<uint16_t>(r.instrument);
+    switch (r.event) {
+    case FlowEvent::ADD:    c = OrderCommand::limit(r.orderID, s, r.qty, r.price, instr, r.participant); return true;
+    case FlowEvent::MARKET: c = OrderCommand::market(r.orderID, s, r.qty, instr, r.participant); return true;
+    case FlowEvent::CANCEL: c = OrderCommand::cancel(r.orderID, instr); return true;
+    case FlowEvent::AMEND:  c = OrderCommand::amend(r.orderID, r.qty, r.price, instr); return true;
+    default:                return false;
+    }
+}
+
+class FlowWriter{
+// Appends records to a new flow file through a fixed size stdio buffer, so memory use doesn't grow with the file.
+// The header's record count is filled in by close (or the destructor). Throws std::runtime_error on I/O failure
+    std::FILE* file = nullptr;
+    uint64_t count = 0;
+
+public:
+    explicit FlowWriter(const std::string& path);
+    ~FlowWriter();
+
+    FlowWriter(const FlowWriter&) = delete;
+    FlowWriter& operator=(const FlowWriter&) = delete;
+
+    void write(const OrderCommand& c);
+
+    // Writes the final header and closes the file
+    void close();
+
+    [[nodiscard]] uint64_t written() const noexcept {return count;}
+};
+
+class FlowReader{
+// Maps a flow file read only. Records are decoded straight out of the page cache,
+// so replaying a file of any size uses constant memory. Throws std::runtime_error if the file can't be mapped
+// or its header doesn't match this build's format
+    const std::byte* base = nullptr;
+    std::size_t bytes = 0;
+    uint64_t count = 0;
+
+public:
+    explicit FlowReader(const std::string& path);
+    ~FlowReader();
+
+    FlowReader(const FlowReader&) = delete;
+    FlowReader& operator=(const FlowReader&) = delete;
+
+    [[nodiscard]] uint64_t size() const noexcept {return count;}
+
+    [[nodiscard]] const FlowRecord& operator[](const std::size_t i) const noexcept {
+        return reinterpret_cast<const FlowRecord*>(base + sizeof(FlowHeader))[i];
+    }
+
+    template<typename Q>
+    uint64_t replay(Q& q, const uint64_t first = 0, uint64_t last = UINT64_MAX) const {
+        // Decodes records [first, last) into q's slots in place (claim/commit), spinning while q is full.
+        // Corrupt records are skipped, their slot is claimed again by the next one. Returns how many were sent
+        if (last > count) {last = count;}
+        uint64_t sent = 0;
+        for (uint64_t i = first; i < last; ++i) {
+            OrderCommand* slot = nullptr;
+            while ((slot = q.claim()) == nullptr) {}
+            if (!decode((*this)[i], *slot)) {continue;}
+            q.commit();
+            ++sent;
+        }
+        return sent;
+    }
+};
@@ -0,0 +1,115 @@
+// The OrderIndex class, maps order IDs to where the order rests inside the Book
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class OrderIndex {
+// Open addressing hash table from order ID to a resting order handle.
+// Linear probing keeps a lookup to one or two cache lines, and deletes shift
+// the following entries back so no tombstones build up under cancel heavy flow.
+
+    struct Entry {
+        int key;
+        uint32_t value; // npos marks an empty slot
+    };
+
+    std::vector<Entry> table;
+    std::size_t mask;
+    std::size_t count = 0;
+
+    [[nodiscard]] std::size_t home(const int key) const noexcept {
+        // Fibonacci hashing, spreads sequential IDs across the table
+        return (static_cast<uint64_t>(static_cast<uint32_t>(key)) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+    }
+
+    void grow() {
+        // Doubles the table and reinserts every entry
+        std::vector<Entry> old(table.size() * 2, Entry{0, npos});
+        old.swap(table);
+        mask = table.size() - 1;
+        count = 0;
+        for (const Entry& e : old) {
+            if (e.value != npos) {insert(e.key, e.value);}
+        }
+    }
+
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    explicit OrderIndex(const std::size_t expected = 1'024)
+        : table(std::bit_ceil(std::max<std::size_t>(expected * 2, 16)), Entry{0, npos}),
+          mask(table.size() - 1) {}
+
+    [[nodiscard]] std::size_t size() const noexcept {return count;}
+
+    [[nodiscard]] uint32_t find(const int key) const noexcept {
+        // Returns the handle for key, or npos
+        for (std::size_t i = home(key);; i = (i + 1) & mask) {
+            const Entry& e = table[i];
+            if (e.value == npos) {return npos;}
+            if (e.key == key) {return e.value;}
+        }
+    }
+
+    void prefetch(const int key) const noexcept {
+        // Starts loading key's home slot, for bulk inserts or lookups a few keys ahead
+        __builtin_prefetch(&table[home(key)]);
+    }
+
+    void insert(const int key, const uint32_t value) {
+        // Inserts key, or overwrites its handle if it's already present
+        if ((count + 1) * 2 > table.size()) {grow();}
+        for (std::size_t i = home(key);; i = (i + 1) & mask) {
+            Entry& e = table[i];
+            if (e.value == npos) {
+                e = Entry{key, value};
+                ++count;
+                return;
+            }
+            if (e.key == key) {
+                e.value = value;
+                return;
+            }
+        }
+    }
+
+    void erase(const int key) noexcept {
+        // Removes key if present, shifting back any entries that probed past it
+        for (std::size_t i = home(key);; i = (i + 1) & mask) {
+            if (table[i].value == npos) {return;}
+            if (table[i].key == key) {eraseAt(i); return;}
+        }
+    }
+
+    void erase(const int key, const uint32_t value) noexcept {
+        // Removes key only if it maps to value, in one probe rather than a find and an erase
+        for (std::size_t i = home(key);; i = (i + 1) & mask) {
+            if (table[i].value == npos) {return;}
+            if (table[i].key == key) {
+                if (table[i].value == value) {eraseAt(i);}
+                return;
+            }
+        }
+    }
+
+private:
+    void eraseAt(std::size_t i) noexcept {
+        // Empties slot i, shifting back any entries that probed past it
+        --count;
+        for (std::size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+            if (table[j].value == npos) {break;}
+            // Entry j can fill the hole at i if its home isn't cyclically in (i, j]
+            const std::size_t h = home(table[j].key);
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                table[i] = table[j];
+                i = j;
+            }
+        }
+        table[i].value = npos;
+    }
+};
@@ -0,0 +1,63 @@
+#include "PerfCounters.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+int openCounter(const uint32_t type, const uint64_t config, const bool userOnly) noexcept {
+    // Counter on the calling thread, any CPU, created disabled. -1 if the kernel refuses it
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = userOnly ? 1 : 0;
+    attr.exclude_hv = 1;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+}
+
+ThreadCounters::ThreadCounters() noexcept {
+    constexpr uint64_t dtlbLoadMisses = PERF_COUNT_HW_CACHE_DTLB
+                                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    fds[DTLB] = openCounter(PERF_TYPE_HW_CACHE, dtlbLoadMisses, true);
+    fds[MIGRATIONS] = openCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, false);
+    fds[SWITCHES] = openCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+}
+
+ThreadCounters::~ThreadCounters() {
+    for (const int fd : fds) {
+        if (fd >= 0) {::close(fd);}
+    }
+}
+
+void ThreadCounters::start() noexcept {
+    for (const int fd : fds) {
+        if (fd < 0) {continue;}
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+CounterValues ThreadCounters::stop() noexcept {
+    std::array<int64_t, COUNTERS> counts{-1, -1, -1};
+    for (std::size_t i = 0; i < COUNTERS; ++i) {
+        if (fds[i] < 0) {continue;}
+        ::ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t n = 0;
+        if (::read(fds[i], &n, sizeof(n)) == sizeof(n)) {counts[i] = static_cast<int64_t>(n);}
+    }
+    return {.dtlbMisses = counts[DTLB], .migrations = counts[MIGRATIONS], .contextSwitches = counts[SWITCHES]};
+}
+
+bool ThreadCounters::available() const noexcept {
+    for (const int fd : fds) {
+        if (fd >= 0) {return true;}
+    }
+    return false;
+}
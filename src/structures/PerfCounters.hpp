@@ -0,0 +1,39 @@
+// The ThreadCounters class, hardware and scheduler counters for one thread read through perf_event_open
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+struct CounterValues{
+// Counts over one start()/stop() window. -1 where the counter couldn't be opened: no PMU exposed to a VM,
+// perf_event_paranoid too strict, or perf_event_open blocked altogether
+    int64_t dtlbMisses = -1;      // Data TLB load misses, each one a page walk
+    int64_t migrations = -1;      // Times the scheduler moved the thread to another CPU
+    int64_t contextSwitches = -1; // Times the thread was switched out, for another thread or to sleep
+};
+
+class ThreadCounters{
+// Opens the counters for the constructing thread, counting only that thread wherever it runs.
+// Construct, start() and stop() on the thread being measured. Hardware counters count user space only,
+// which perf_event_paranoid 2 (the usual default) still allows. The scheduler counters fire in the kernel,
+// so they need perf_event_paranoid 1 or CAP_PERFMON and read -1 otherwise
+    enum Counter{DTLB, MIGRATIONS, SWITCHES, COUNTERS};
+    std::array<int, COUNTERS> fds{-1, -1, -1};
+
+public:
+    ThreadCounters() noexcept;
+    ~ThreadCounters();
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    // Zeroes and enables every counter that opened
+    void start() noexcept;
+
+    // Disables them and reads the counts since start()
+    CounterValues stop() noexcept;
+
+    // True if any counter opened
+    [[nodiscard]] bool available() const noexcept;
+};
@@ -0,0 +1,40 @@
+// Compile time configuration for BasicOrder and BasicBook
+
+#pragma once
+
+#include <cstdint>
+
+#include "Clock.hpp"
+
+// Fixed point price: a whole number of ticks. Orders and the Book hold prices as Ticks,
+// Policy::Price is only used to convert at the edges (commands in, events, depth and getters out)
+using Ticks = int64_t;
+
+struct NullSink{
+// Event sink that ignores every event. The calls are inlined away, so a Book using it pays nothing.
+// A sink receives, by reference, the orders involved in each event. Prices come converted out of the Book's ticks:
+//  - onFill:     taker crossed maker for qty at price (the maker's price)
+//  - onRest:     a limit order's remainder was added to the book at price
+//  - onComplete: an order is finished, fully filled or (for market orders) out of liquidity
+//  - onReject:   a limit order's remainder couldn't rest at price because the book is full
+    template<typename O>
+    void onFill(const O&, const O&, typename O::Qty, typename O::Price) noexcept {}
+
+    template<typename O>
+    void onRest(const O&, typename O::Price) noexcept {}
+
+    template<typename O>
+    void onComplete(const O&) noexcept {}
+
+    template<typename O>
+    void onReject(const O&, typename O::Price) noexcept {}
+};
+
+struct DefaultPolicy{
+// The engine as originally written: double prices on a 0.05 tick, int quantities, no events
+    using Price = double;                   // Floating point, converted to whole Ticks on construction
+    using Qty = int;
+    static constexpr double tickSize = 0.05;
+    using Sink = NullSink;                  // Receives execution events from the Book
+    using Clock = TscClock;                 // Stamps orders as the Book accepts them
+};
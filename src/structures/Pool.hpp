@@ -0,0 +1,47 @@
+// The Pool class, fixed capacity storage for objects the Book creates and destroys at high rates
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "HugePageAllocator.hpp"
+
+template<typename T>
+class Pool {
+// Preallocated slab of T handed out by 32 bit handle, with a free list of released slots.
+// Every slot is constructed up front, so acquire and release never touch the heap.
+// When the slab is used up acquire returns npos instead of allocating more.
+
+    std::vector<T, HugePageAllocator<T>> slots; // Large pools are walked at random, huge pages keep the TLB misses down
+    std::vector<uint32_t> freeList; // Reserved to capacity, push_back never reallocates
+
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    explicit Pool(const std::size_t capacity)
+        : slots(capacity) {
+        // Hand out low handles first, so a lightly used pool stays in a few pages
+        freeList.reserve(capacity);
+        for (std::size_t i = capacity; i > 0; --i) {freeList.push_back(static_cast<uint32_t>(i - 1));}
+    }
+
+    [[nodiscard]] uint32_t acquire() noexcept {
+        // Returns a free slot, or npos when the pool is exhausted
+        if (freeList.empty()) {return npos;}
+        const uint32_t h = freeList.back();
+        freeList.pop_back();
+        return h;
+    }
+
+    void release(const uint32_t h) noexcept {freeList.push_back(h);}
+
+    T& operator[](const uint32_t h) noexcept {return slots[h];}
+    const T& operator[](const uint32_t h) const noexcept {return slots[h];}
+
+    [[nodiscard]] std::size_t capacity() const noexcept {return slots.size();}
+    [[nodiscard]] std::size_t inUse() const noexcept {return slots.size() - freeList.size();}
+    [[nodiscard]] bool full() const noexcept {return freeList.empty();}
+};
@@ -0,0 +1,99 @@
+// The PreTradeCheck stage, validation and risk limits applied to each command before it reaches the Book
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "Book.hpp"
+#include "OrderCommand.hpp"
+
+enum class RejectReason : uint8_t{
+    NONE,                // Passed every check
+    BAD_QUANTITY,        // Zero, negative or above maxQty
+    BAD_PRICE,           // Limit price not positive, not a number, outside [minPrice, maxPrice] or too many ticks for int64
+    OUTSIDE_BAND,        // Limit price further from the last trade than the band allows
+    FAT_FINGER,          // Notional (quantity x price) above maxNotional
+    OPEN_ORDER_LIMIT,    // The participant already has maxOpenOrders resting
+    UNKNOWN_PARTICIPANT  // Participant ID beyond what the Book counts
+};
+
+inline const char* toString(const RejectReason r) noexcept {
+    switch (r) {
+    case RejectReason::NONE:                return "NONE";
+    case RejectReason::BAD_QUANTITY:        return "BAD_QUANTITY";
+    case RejectReason::BAD_PRICE:           return "BAD_PRICE";
+    case RejectReason::OUTSIDE_BAND:        return "OUTSIDE_BAND";
+    case RejectReason::FAT_FINGER:          return "FAT_FINGER";
+    case RejectReason::OPEN_ORDER_LIMIT:    return "OPEN_ORDER_LIMIT";
+    case RejectReason::UNKNOWN_PARTICIPANT: return "UNKNOWN_PARTICIPANT";
+    }
+    return "?";
+}
+
+struct RiskLimits{
+// One instrument's limits. The defaults only screen out malformed orders
+    int64_t maxQty = std::numeric_limits<int>::max();         // Largest quantity for a NEW or AMEND
+    double minPrice = 0;                                       // Static collar on limit prices
+    double maxPrice = std::numeric_limits<double>::max();
+    double band = 0;                                           // Limit prices more than this fraction of the last trade away
+                                                               // from it are rejected. 0 turns it off, as does no trade yet
+    double maxNotional = std::numeric_limits<double>::max();   // Market orders are valued at the last trade,
+                                                               // or the touch they take from before the first trade
+    uint32_t maxOpenOrders = std::numeric_limits<uint32_t>::max(); // Resting orders per participant, checked on NEW limits
+};
+
+class PreTradeCheck{
+// Screens commands on the matching thread just before Book::apply, so it reads the Book's last trade and per participant
+// open order counts without any synchronisation. Everything that passes is safe for the matcher to take as is:
+// the fill loop carries no checks and never throws.
+// Cancels always pass, the Book reports unknown IDs itself
+    RiskLimits limits;
+
+    static constexpr double tickLimit = 0x1p63; // First tick count an int64_t can't hold
+
+public:
+    explicit PreTradeCheck(const RiskLimits& l = {}) noexcept : limits(l) {}
+
+    [[nodiscard]] const RiskLimits& riskLimits() const noexcept {return limits;}
+
+    template<typename Policy>
+    [[nodiscard]] RejectReason check(const OrderCommand& c, const BasicBook<Policy>& book) const noexcept {
+        if (c.command == CommandType::CANCEL) {return RejectReason::NONE;}
+
+        if (c.qty <= 0 || c.qty > limits.maxQty) {return RejectReason::BAD_QUANTITY;}
+
+        const bool isNew = c.command == CommandType::NEW;
+        if (isNew && c.participant >= book.participants()) {return RejectReason::UNKNOWN_PARTICIPANT;}
+
+        const auto last = static_cast<double>(book.lastPrice());
+        const bool priced = !isNew || c.type == OrderType::LIMIT;
+        if (priced) {
+            // Negated so NaN fails too
+            if (!(c.price > 0 && c.price >= limits.minPrice && c.price <= limits.maxPrice)) {return RejectReason::BAD_PRICE;}
+            // Prices are rounded to int64 ticks, on the Policy's tick and then the book's
+            if (!(c.price / std::min<double>(book.tickSize(), Policy::tickSize) < tickLimit)) {return RejectReason::BAD_PRICE;}
+            if (limits.band > 0 && last > 0 && std::abs(c.price - last) > limits.band * last) {
+                return RejectReason::OUTSIDE_BAND;
+            }
+        }
+
+        double valuedAt = priced ? c.price : last;
+        if (valuedAt == 0) {
+            // A market order before the first trade, valued at the best price on the side it takes from
+            std::array<typename BasicBook<Policy>::DepthLevel, 1> touch{};
+            if (book.depth(c.side == Side::BUY ? Side::SELL : Side::BUY, touch) != 0) {
+                valuedAt = static_cast<double>(touch[0].price);
+            }
+        }
+        if (static_cast<double>(c.qty) * valuedAt > limits.maxNotional) {return RejectReason::FAT_FINGER;}
+
+        if (isNew && priced && book.openOrders(c.participant) >= limits.maxOpenOrders) {
+            return RejectReason::OPEN_ORDER_LIMIT;
+        }
+        return RejectReason::NONE;
+    }
+};
@@ -0,0 +1,358 @@
+// The PriceLadder class, a flat tick-indexed array of price levels for one side of the Book
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "HugePageAllocator.hpp"
+#include "Pool.hpp"
+
+class TickBitmap {
+// Hierarchical occupancy bitmap. Layer 0 holds one bit per tick; each bit in layer k+1
+// is set when the matching 64 bit word in layer k is non-zero.
+// Scans skip empty stretches a whole summary word at a time, so finding the next occupied tick
+// costs a handful of word reads however sparse the book is.
+
+    static constexpr std::size_t wordBits = 64;
+
+    std::vector<std::vector<uint64_t, HugePageAllocator<uint64_t>>> layers;
+
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    explicit TickBitmap(std::size_t bits = 0) {
+        // Builds enough summary layers to end with a single word
+        do {
+            const std::size_t words = (bits + wordBits - 1) / wordBits;
+            layers.emplace_back(std::max<std::size_t>(words, 1), 0);
+            bits = words;
+        } while (bits > 1);
+    }
+
+    void reset() noexcept {
+        // Clears every bit, keeping the storage
+        for (auto& layer : layers) {std::fill(layer.begin(), layer.end(), 0);}
+    }
+
+    [[nodiscard]] bool test(const std::size_t i) const noexcept {
+        return (layers[0][i / wordBits] >> (i % wordBits)) & 1U;
+    }
+
+    void set(std::size_t i) noexcept {
+        // Sets bit i, and its summary bits up to the first word that was already non-zero
+        for (auto& layer : layers) {
+            uint64_t& word = layer[i / wordBits];
+            const bool wasEmpty = word == 0;
+            word |= (uint64_t{1} << (i % wordBits));
+            if (!wasEmpty) {return;}
+            i /= wordBits;
+        }
+    }
+
+    void clear(std::size_t i) noexcept {
+        // Clears bit i, and its summary bits for every word this leaves empty
+        for (auto& layer : layers) {
+            uint64_t& word = layer[i / wordBits];
+            word &= ~(uint64_t{1} << (i % wordBits));
+            if (word != 0) {return;}
+            i /= wordBits;
+        }
+    }
+
+    [[nodiscard]] std::size_t scanUp(std::size_t i) const noexcept {
+        // Index of the first set bit at or above i, or npos
+
+        // Climb until a layer has a set bit at or after i
+        std::size_t k = 0;
+        for (;; ++k) {
+            const std::size_t w = i / wordBits;
+            if (w >= layers[k].size()) {return npos;}
+            const uint64_t bits = layers[k][w] & (~uint64_t{0} << (i % wordBits));
+            if (bits != 0) {
+                i = w * wordBits + static_cast<std::size_t>(std::countr_zero(bits));
+                break;
+            }
+            if (k + 1 == layers.size()) {return npos;}
+            i = w + 1;
+        }
+        // Descend through the lowest set bits
+        while (k-- > 0) {
+            i = i * wordBits + static_cast<std::size_t>(std::countr_zero(layers[k][i]));
+        }
+        return i;
+    }
+
+    [[nodiscard]] std::size_t scanDown(std::size_t i) const noexcept {
+        // Index of the first set bit at or below i, or npos
+
+        // Climb until a layer has a set bit at or before i
+        std::size_t k = 0;
+        for (;; ++k) {
+            const std::size_t w = i / wordBits;
+            const uint64_t bits = layers[k][w] & (~uint64_t{0} >> (wordBits - 1 - i % wordBits));
+            if (bits != 0) {
+                i = w * wordBits + wordBits - 1 - static_cast<std::size_t>(std::countl_zero(bits));
+                break;
+            }
+            if (w == 0 || k + 1 == layers.size()) {return npos;}
+            i = w - 1;
+        }
+        // Descend through the highest set bits
+        while (k-- > 0) {
+            i = i * wordBits + wordBits - 1 - static_cast<std::size_t>(std::countl_zero(layers[k][i]));
+        }
+        return i;
+    }
+};
+
+template<typename>
+class TestLadderHelper;
+
+template<typename L>
+class PriceLadder {
+// Maps integer tick indices onto a contiguous window of price levels (L).
+// Each tick holds a 4 byte handle into a fixed size Pool of level objects, so a wide, sparse window stays cheap
+// and the levels that are actually in use sit close together in memory.
+// An occupancy bitmap (one bit per tick) tracks which ticks hold orders,
+// so the lowest and highest occupied ticks are found with a bit scan rather than a tree walk.
+// The window moves with the market: it recenters when a price falls outside of it,
+// and doubles in size when the occupied range no longer fits, up to a fixed maximum. Recentering reuses the window
+// in place, so the only allocation after construction is that doubling.
+    friend class TestLadderHelper<L>; // Helper class for unit tests
+
+    static constexpr std::size_t minWindow = 64;
+    static constexpr uint32_t vacant = std::numeric_limits<uint32_t>::max();
+    static constexpr long long maxTick = std::numeric_limits<long long>::max() / 4; // Keeps base + window from overflowing
+
+    using Slots = std::vector<uint32_t, HugePageAllocator<uint32_t>>;
+
+    Slots slots;                      // slots[i] is the handle of the level at tick (base + i), or vacant
+    TickBitmap occupied;              // bit i is set when tick (base + i) holds orders
+    Pool<L> levels;                   // Level objects, recycled when a tick is vacated
+    long long base = 0;               // Tick of slots[0]
+    long long lo = 0;                 // Lowest occupied tick (valid when count != 0)
+    long long hi = 0;                 // Highest occupied tick (valid when count != 0)
+    std::size_t count = 0;            // Number of occupied ticks
+    std::size_t maxWindow;            // Widest the window may grow
+
+    [[nodiscard]] std::size_t window() const noexcept {return slots.size();}
+
+    [[nodiscard]] bool inWindow(const long long tick) const noexcept {
+        return tick >= base && tick < base + static_cast<long long>(window());
+    }
+
+    [[nodiscard]] long long nextUp(const long long tick) const noexcept {
+        // Next occupied tick above tick. Caller guarantees one exists.
+        return base + static_cast<long long>(occupied.scanUp(static_cast<std::size_t>(tick - base) + 1));
+    }
+
+    [[nodiscard]] long long nextDown(const long long tick) const noexcept {
+        // Next occupied tick below tick. Caller guarantees one exists.
+        return base + static_cast<long long>(occupied.scanDown(static_cast<std::size_t>(tick - base) - 1));
+    }
+
+    [[nodiscard]] bool fits(const long long tick) const noexcept {
+        // True if tick and every occupied level can share a window no wider than maxWindow
+        if (tick > maxTick || tick < -maxTick) {return false;}
+        const long long newLo = count ? std::min(lo, tick) : tick;
+        const long long newHi = count ? std::max(hi, tick) : tick;
+        return static_cast<std::size_t>(newHi - newLo) < maxWindow;
+    }
+
+    void rebase(const long long tick) {
+        // Moves the window so that tick and every occupied level fit, growing it if needed.
+        // Occupied levels are re-centred in the window to leave headroom on both sides.
+
+        const long long newLo = count ? std::min(lo, tick) : tick;
+        const long long newHi = count ? std::max(hi, tick) : tick;
+        const auto span = static_cast<std::size_t>(newHi - newLo + 1);
+
+        std::size_t newWindow = window();
+        while (newWindow < span + span / 2 && newWindow < maxWindow) {newWindow *= 2;}
+        const long long newBase = newLo - static_cast<long long>((newWindow - span) / 2);
+
+        if (newWindow == window()) {
+            // Slide the handles in place. Walk against the direction of travel so none are overwritten
+            if (count) {
+                const long long shift = base - newBase;
+                const auto move = [&](const long long t) {
+                    const auto from = static_cast<std::size_t>(t - base);
+                    const uint32_t slot = slots[from];
+                    slots[from] = vacant;
+                    slots[static_cast<std::size_t>(static_cast<long long>(from) + shift)] = slot;
+                };
+                if (shift > 0) {for (long long t = hi;; t = nextDown(t)) {move(t); if (t == lo) {break;}}}
+                else {for (long long t = lo;; t = nextUp(t)) {move(t); if (t == hi) {break;}}}
+            }
+            occupied.reset();
+        } else {
+            // Only the occupied ticks carry over to the bigger window
+            Slots newSlots(newWindow, vacant);
+            if (count) {
+                for (long long t = lo;; t = nextUp(t)) {
+                    newSlots[static_cast<std::size_t>(t - newBase)] = slots[static_cast<std::size_t>(t - base)];
+                    if (t == hi) {break;}
+                }
+            }
+            slots = std::move(newSlots);
+            occupied = TickBitmap(newWindow);
+        }
+
+        // Re-mark the occupied ticks at their new positions
+        base = newBase;
+        if (count) {
+            for (long long t = lo; t <= hi; ++t) {
+                const auto i = static_cast<std::size_t>(t - base);
+                if (slots[i] != vacant) {occupied.set(i);}
+            }
+        }
+    }
+
+public:
+
+    // maxLevels is the most price levels that can be occupied at once,
+    // maxTicks the widest range of ticks they may span (rounded up to a power of two)
+    explicit PriceLadder(const std::size_t initialTicks = 4'096, const std::size_t maxLevels = 16'384,
+                         const std::size_t maxTicks = 16'777'216)
+        : slots(std::bit_ceil(std::max<std::size_t>(initialTicks, minWindow)), vacant),
+          occupied(window()),
+          levels(maxLevels),
+          maxWindow(std::bit_ceil(std::max(maxTicks, window()))) {}
+
+    [[nodiscard]] bool empty() const noexcept {return count == 0;}
+    [[nodiscard]] bool full() const noexcept {return levels.full();}
+    [[nodiscard]] std::size_t size() const noexcept {return count;}
+
+    // Best prices, only valid when the ladder isn't empty
+    [[nodiscard]] long long lowest() const noexcept {return lo;}
+    [[nodiscard]] long long highest() const noexcept {return hi;}
+
+    [[nodiscard]] L* find(const long long tick) noexcept {
+        // Returns the occupied level at tick, or nullptr
+        if (!inWindow(tick)) {return nullptr;}
+        const uint32_t slot = slots[static_cast<std::size_t>(tick - base)];
+        return slot != vacant ? &levels[slot] : nullptr;
+    }
+
+    [[nodiscard]] const L* find(const long long tick) const noexcept {
+        if (!inWindow(tick)) {return nullptr;}
+        const uint32_t slot = slots[static_cast<std::size_t>(tick - base)];
+        return slot != vacant ? &levels[slot] : nullptr;
+    }
+
+    void prefetch(const long long tick) const noexcept {
+        // Starts loading the handle at tick, so a find() on it a little later doesn't miss
+        if (inWindow(tick)) {__builtin_prefetch(&slots[static_cast<std::size_t>(tick - base)]);}
+    }
+
+    L& at(const long long tick) noexcept {
+        // Level at an occupied tick, no checks
+        return levels[slots[static_cast<std::size_t>(tick - base)]];
+    }
+
+    L* occupy(const long long tick) {
+        // Returns the level at tick, marking it occupied and moving the window if needed.
+        // Returns nullptr if the tick is vacant and the level pool is exhausted,
+        // or if the window can't stretch to cover it without growing past maxTicks
+
+        if (!inWindow(tick)) {
+            if (levels.full() || !fits(tick)) {return nullptr;}
+            rebase(tick);
+        }
+        const auto i = static_cast<std::size_t>(tick - base);
+        if (slots[i] == vacant) {
+            const uint32_t slot = levels.acquire();
+            if (slot == Pool<L>::npos) {return nullptr;}
+            slots[i] = slot;
+            occupied.set(i);
+            if (count == 0) {lo = hi = tick;}
+            else if (tick < lo) {lo = tick;}
+            else if (tick > hi) {hi = tick;}
+            ++count;
+        }
+        return &levels[slots[i]];
+    }
+
+    void vacate(const long long tick) {
+        // Marks the level at an occupied tick as empty and resets it for reuse
+
+        const auto i = static_cast<std::size_t>(tick - base);
+        levels[slots[i]].reset();
+        levels.release(slots[i]);
+        slots[i] = vacant;
+        occupied.clear(i);
+        if (--count == 0) {return;}
+        if (tick == lo) {lo = nextUp(tick);}
+        if (tick == hi) {hi = nextDown(tick);}
+    }
+
+    // Vacates the best occupied ticks in one go, given best first as bestTicks wrote them.
+    // The new best is found with one scan from the last of them rather than one per tick
+    template<bool Ascending>
+    void vacateBest(const std::span<const long long> ticks) noexcept {
+        for (const long long tick : ticks) {
+            const auto i = static_cast<std::size_t>(tick - base);
+            levels[slots[i]].reset();
+            levels.release(slots[i]);
+            slots[i] = vacant;
+            occupied.clear(i);
+            --count;
+        }
+        if (count == 0 || ticks.empty()) {return;}
+        if constexpr (Ascending) {lo = nextUp(ticks.back());}
+        else {hi = nextDown(ticks.back());}
+    }
+
+    // Writes up to out.size() occupied ticks into out, best first: from the lowest up when Ascending, else from the
+    // highest down. Stops before the first tick past stop (above it ascending, below it descending). Returns the count
+    template<bool Ascending>
+    std::size_t bestTicks(const std::span<long long> out, const long long stop) const noexcept {
+        if (count == 0) {return 0;}
+        std::size_t n = 0;
+        for (long long t = Ascending ? lo : hi; n < out.size(); t = Ascending ? nextUp(t) : nextDown(t)) {
+            if (Ascending ? t > stop : t < stop) {break;}
+            out[n++] = t;
+            if (t == (Ascending ? hi : lo)) {break;}
+        }
+        return n;
+    }
+
+    // Visits each occupied (tick, level) pair from the lowest tick up.
+    // If f returns bool, returning false stops the walk
+    template<typename F>
+    void forEachAscending(F&& f) const {
+        if (count == 0) {return;}
+        for (long long t = lo;; t = nextUp(t)) {
+            if (!visit(f, t)) {return;}
+            if (t == hi) {break;}
+        }
+    }
+
+    // Visits each occupied (tick, level) pair from the highest tick down, stopping the same way
+    template<typename F>
+    void forEachDescending(F&& f) const {
+        if (count == 0) {return;}
+        for (long long t = hi;; t = nextDown(t)) {
+            if (!visit(f, t)) {return;}
+            if (t == lo) {break;}
+        }
+    }
+
+private:
+
+    template<typename F>
+    bool visit(F& f, const long long t) const {
+        // Calls f on the level at an occupied tick. False if f asked to stop
+        const L& level = levels[slots[static_cast<std::size_t>(t - base)]];
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, long long, const L&>, bool>) {return f(t, level);}
+        else {f(t, level); return true;}
+    }
+};
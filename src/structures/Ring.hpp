@@ -2,53 +2,179 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <optional>
 #include <cstddef>
 #include <atomic>
+#include <span>
 
-template<typename, std::size_t>
+template<typename, std::size_t, typename>
 class SpscQ;
 
 template<typename, std::size_t>
 class TestRingHelper;
 
+// Assumed cache line size. Producer and consumer state are kept on separate lines so they don't false share
+inline constexpr std::size_t cacheLine = 64;
+
 template<typename O, std::size_t N>
 class Ring {
 //Buffer for my Single Producer Single consumer ring interface (SpscQ)
-    friend class SpscQ<O,N>; //Interface for SpscQ
+//The producer owns tail, the consumer owns head. Each side keeps a cached copy of the other's index
+//and only reloads it when the ring looks full (producer) or empty (consumer),
+//so in steady state each operation touches just its own cache line plus the slot.
+    template<typename, std::size_t, typename>
+    friend class SpscQ; //Interface for SpscQ, whatever its wait strategy
     friend class TestRingHelper<O,N>; // Helper class for unit tests
 
-    std::array<O, N> buffer;
+    static constexpr bool powerOfTwo = N != 0 && (N & (N - 1)) == 0;
+
+    static constexpr size_t advance(const size_t i, const size_t by = 1) noexcept {
+        // Index by slots past i, wrapping at N. A mask when N is a power of two, otherwise a compare
+        if constexpr (powerOfTwo) {
+            return (i + by) & (N - 1);
+        } else {
+            const size_t next = i + by;
+            return next >= N ? next - N : next;
+        }
+    }
+
+    //Consumer's cache line: written by the consumer, read by the producer when it thinks the ring is full
+    alignas(cacheLine) std::atomic<size_t> head = 0;
+    size_t cachedTail = 0; // Consumer's last view of tail
+
+    //Producer's cache line: written by the producer, read by the consumer when it thinks the ring is empty
+    alignas(cacheLine) std::atomic<size_t> tail = 0;
+    size_t cachedHead = 0; // Producer's last view of head
 
-    //Indivisible under concurrency
-    std::atomic<size_t> head = 0;
-    std::atomic<size_t> tail = 0;
+    alignas(cacheLine) std::array<O, N> buffer;
 
     bool push(const O& o) {
         //Pushes an Order to the buffer at tail.
         //Moves tail forward one
 
-        // Check if the buffer is full
-        const size_t next = (tail + 1) % N;
-        if (next == head) {
-            return false;
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t next = advance(t);
+
+        // Check if the buffer is full, the cached head may be stale so reload it before giving up
+        if (next == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (next == cachedHead) {return false;}
         }
-        buffer[tail] = o;
-        tail = next;
+        buffer[t] = o;
+        tail.store(next, std::memory_order_release); // Publishes the slot to the consumer
         return true;
     }
 
     std::optional<O> pop() {
         //Pops order off at head by moving head forward, not actually deleting any data
 
-        //Checks if buffer is empty
-        if (head == tail){return std::nullopt;}
+        const size_t h = head.load(std::memory_order_relaxed);
+
+        //Checks if buffer is empty, the cached tail may be stale so reload it before giving up
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {return std::nullopt;}
+        }
 
-        O o = buffer[head];
-        head = (head + 1) % N;
+        O o = buffer[h];
+        head.store(advance(h), std::memory_order_release); // Hands the slot back to the producer
 
         return o;
     }
-};
 
+    O* claim() noexcept {
+        //Returns the slot at tail for the producer to write in place, or nullptr if the buffer is full.
+        //Nothing is visible to the consumer until commit()
+
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t next = advance(t);
+        if (next == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (next == cachedHead) {return nullptr;}
+        }
+        return &buffer[t];
+    }
+
+    void commit() noexcept {
+        //Publishes the slot returned by the last claim()
+        tail.store(advance(tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    const O* peek() noexcept {
+        //Returns the slot at head for the consumer to read in place, or nullptr if the buffer is empty.
+        //The slot stays valid until release()
+
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {return nullptr;}
+        }
+        return &buffer[h];
+    }
+
+    void release() noexcept {
+        //Hands the slot returned by the last peek() back to the producer
+        head.store(advance(head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    std::span<const O> peek_n(const size_t max) noexcept {
+        //Returns up to max slots from head for the consumer to read in place, empty if the buffer is empty.
+        //A batch is one contiguous run, so it stops at the end of the array and the next one starts from the front.
+        //The slots stay valid until release_n()
+        const size_t h = head.load(std::memory_order_relaxed);
+        size_t ready = (cachedTail + N - h) % N;
+        if (ready < max) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            ready = (cachedTail + N - h) % N;
+        }
+        return {buffer.data() + h, std::min({ready, max, N - h})};
+    }
+
+    void release_n(const size_t count) noexcept {
+        //Hands the first count slots returned by the last peek_n() back to the producer
+        head.store(advance(head.load(std::memory_order_relaxed), count), std::memory_order_release);
+    }
+
+    size_t push_n(std::span<const O> in) {
+        //Pushes as many of in as fit, in order, with a single tail publish. Returns how many were pushed
+
+        const size_t t = tail.load(std::memory_order_relaxed);
+        size_t free = (cachedHead + N - t - 1) % N;
+        if (free < in.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            free = (cachedHead + N - t - 1) % N;
+        }
+        const size_t count = std::min(free, in.size());
+        if (count == 0) {return 0;}
+
+        // Copy in at most two runs, up to the end of the array then from the start
+        const size_t first = std::min(count, N - t);
+        std::copy_n(in.begin(), first, buffer.begin() + t);
+        std::copy_n(in.begin() + first, count - first, buffer.begin());
+
+        tail.store(advance(t, count), std::memory_order_release);
+        return count;
+    }
+
+    size_t pop_n(std::span<O> out) {
+        //Pops up to out.size() orders into out, in order, with a single head publish. Returns how many were popped
+
+        const size_t h = head.load(std::memory_order_relaxed);
+        size_t ready = (cachedTail + N - h) % N;
+        if (ready < out.size()) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            ready = (cachedTail + N - h) % N;
+        }
+        const size_t count = std::min(ready, out.size());
+        if (count == 0) {return 0;}
+
+        const size_t first = std::min(count, N - h);
+        std::copy_n(buffer.begin() + h, first, out.begin());
+        std::copy_n(buffer.begin(), count - first, out.begin() + first);
+
+        head.store(advance(h, count), std::memory_order_release);
+        return count;
+    }
+};
@@ -0,0 +1,92 @@
+#include "Runtime.hpp"
+
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool pinCurrentThread(const int cpu) noexcept {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {return false;}
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int currentCpu() noexcept {
+    unsigned cpu = 0, node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {return -1;}
+    return static_cast<int>(cpu);
+}
+
+int currentNode() noexcept {
+    unsigned cpu = 0, node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {return -1;}
+    return static_cast<int>(node);
+}
+
+const char* toString(const PageKind k) noexcept {
+    switch (k) {
+    case PageKind::HUGETLB:     return "HUGETLB";
+    case PageKind::TRANSPARENT: return "TRANSPARENT";
+    case PageKind::SMALL:       return "SMALL";
+    }
+    return "?";
+}
+
+namespace {
+
+constexpr std::size_t hugePage = std::size_t{1} << 21;
+
+void* mapAnonymous(const std::size_t bytes, const int extraFlags) noexcept {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+}
+
+NodeRegion::NodeRegion(const std::size_t size, const int node, const bool hugePages) : bytes(size) {
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t rounded = (size + hugePage - 1) & ~(hugePage - 1);
+
+    if (hugePages) {
+        // Explicit huge pages only exist if the admin reserved some, fails straight away otherwise
+        if ((base = mapAnonymous(rounded, MAP_HUGETLB)) != nullptr) {
+            mapped = rounded;
+            kind = PageKind::HUGETLB;
+        } else if (void* p = mapAnonymous(rounded + hugePage, 0)) {
+            // Transparent huge pages need 2MB alignment, so map one huge page extra and trim both ends to it
+            const auto start = reinterpret_cast<uintptr_t>(p);
+            const uintptr_t aligned = (start + hugePage - 1) & ~(hugePage - 1);
+            if (aligned > start) {::munmap(p, aligned - start);}
+            const uintptr_t end = start + rounded + hugePage;
+            if (end > aligned + rounded) {::munmap(reinterpret_cast<void*>(aligned + rounded), end - aligned - rounded);}
+            base = reinterpret_cast<void*>(aligned);
+            mapped = rounded;
+            kind = ::madvise(base, mapped, MADV_HUGEPAGE) == 0 ? PageKind::TRANSPARENT : PageKind::SMALL;
+        }
+    }
+    if (base == nullptr) {
+        mapped = (size + page - 1) & ~(page - 1);
+        if ((base = mapAnonymous(mapped, 0)) == nullptr) {throw std::bad_alloc();}
+        kind = PageKind::SMALL;
+    }
+
+    if (node >= 0 && node < 64) {
+        // Preferred rather than bound: if the node runs out the kernel falls back to another instead of failing.
+        // Raw syscall so there's no libnuma dependency, ignored where NUMA isn't supported
+        const unsigned long mask = 1UL << node;
+        ::syscall(SYS_mbind, base, mapped, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1, 0); // The kernel drops the last bit
+    }
+
+    // Touch every page now, from this thread, so the faults happen here and first touch places them locally
+    auto* bytesOut = static_cast<volatile unsigned char*>(base);
+    const std::size_t step = kind == PageKind::HUGETLB ? hugePage : page;
+    for (std::size_t i = 0; i < mapped; i += step) {bytesOut[i] = 0;}
+}
+
+NodeRegion::~NodeRegion() {
+    if (base != nullptr) {::munmap(base, mapped);}
+}
@@ -0,0 +1,165 @@
+// The PipelineRuntime, the ingestion and matching threads pinned to chosen CPUs, with the ring and the Book
+// in memory on the matching thread's NUMA node
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <latch>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "Book.hpp"
+#include "Journal.hpp"
+#include "OrderCommand.hpp"
+#include "PerfCounters.hpp"
+#include "SpscQ.hpp"
+#include "WaitStrategy.hpp"
+
+// Pins the calling thread to cpu. Returns false if the CPU doesn't exist or isn't in this process's allowed set
+bool pinCurrentThread(int cpu) noexcept;
+
+// CPU and NUMA node the calling thread is running on at this moment
+int currentCpu() noexcept;
+int currentNode() noexcept;
+
+enum class PageKind : uint8_t{
+    HUGETLB,     // Explicit 2MB pages from the kernel's reserved pool (vm.nr_hugepages)
+    TRANSPARENT, // 2MB aligned and marked MADV_HUGEPAGE, the kernel backs it with huge pages when it can
+    SMALL        // 4K pages
+};
+
+const char* toString(PageKind k) noexcept;
+
+class NodeRegion{
+// An anonymous mapping placed on one NUMA node and faulted in by the constructing thread, so the hot path never
+// takes a page fault or reaches across to another node's memory. With huge pages asked for it tries explicit ones,
+// then transparent ones, then settles for 4K pages. Node -1 leaves placement to first touch, which is the
+// constructing thread's node. Throws std::bad_alloc if nothing can be mapped
+    void* base = nullptr;
+    std::size_t mapped = 0;
+    std::size_t bytes = 0;
+    PageKind kind = PageKind::SMALL;
+
+public:
+    NodeRegion(std::size_t bytes, int node, bool hugePages);
+    ~NodeRegion();
+
+    NodeRegion(const NodeRegion&) = delete;
+    NodeRegion& operator=(const NodeRegion&) = delete;
+
+    [[nodiscard]] void* data() const noexcept {return base;}
+    [[nodiscard]] std::size_t size() const noexcept {return bytes;}
+    [[nodiscard]] PageKind pages() const noexcept {return kind;}
+};
+
+struct RuntimeConfig{
+    int ingestCpu = -1;    // CPU for the ingestion thread, -1 leaves it to the scheduler
+    int matchCpu = -1;     // CPU for the matching thread, -1 leaves it to the scheduler
+    bool hugePages = true; // Back the ring with huge pages if the kernel has them
+    BookConfig book = {};
+    std::string journal;     // Journal the matching thread appends to, empty for none. What it already holds is replayed
+                             // into the Book before matching starts
+    bool journalSync = true; // fdatasync the journal, see Journal
+};
+
+struct RuntimeReport{
+// Where the threads ran and what they cost, for one run()
+    bool ingestPinned = false;
+    bool matchPinned = false;
+    int matchNode = -1;                 // NUMA node of the matching thread, which holds the ring and the Book
+    PageKind ringPages = PageKind::SMALL;
+    CounterValues ingest;               // Counted from when the thread starts its work until it returns
+    CounterValues match;
+    uint64_t recovered = 0;             // Commands replayed from the journal before matching started
+};
+
+template<typename Policy = DefaultPolicy, typename Wait = BusySpin, std::size_t N = 16'384>
+class PipelineRuntime{
+// One ingestion thread feeding one matching thread through an SpscQ, each optionally pinned to its own CPU.
+// The matching thread pins itself first, then maps the ring and builds the Book, so both are local to it and already
+// faulted in (the Book's large arrays already ask for transparent huge pages), and opens the journal if there is one.
+// The ingestion thread only starts once that's done. Pinning that fails isn't an error, the thread runs where the
+// scheduler puts it and the report says so
+public:
+    using Book = BasicBook<Policy>;
+    using Queue = SpscQ<OrderCommand, N, Wait>;
+
+    explicit PipelineRuntime(const RuntimeConfig& c = {}) : cfg(c) {}
+
+    template<typename Ingest, typename Match>
+    RuntimeReport run(Ingest&& ingest, Match&& match) {
+        // Runs ingest(Queue&) on the ingestion thread and match(Queue&, Book&) on the matching thread,
+        // returns once both have. Each run gets a fresh ring and Book, the Book stays readable through book().
+        // A match that takes a third Journal* argument gets the configured journal, or nullptr without one. It should
+        // append each command after its pre-trade check passes and before applying it, so the journal only holds what
+        // the Book was given. The journal is flushed before run returns. Rethrows on this thread if the ring, the Book or the journal can't
+        // be set up
+
+        RuntimeReport report;
+        std::latch ready(1);
+        std::exception_ptr failed;
+        std::unique_ptr<NodeRegion> region;
+        Queue* queue = nullptr;
+
+        std::jthread matcher([&] {
+            report.matchPinned = cfg.matchCpu >= 0 && pinCurrentThread(cfg.matchCpu);
+            report.matchNode = currentNode();
+            try {
+                region = std::make_unique<NodeRegion>(sizeof(Queue), report.matchPinned ? report.matchNode : -1,
+                                                      cfg.hugePages);
+                queue = new (region->data()) Queue();
+                report.ringPages = region->pages();
+                matchBook = std::make_unique<Book>(cfg.book);
+                matchJournal.reset();
+                if (!cfg.journal.empty()) {
+                    matchJournal = std::make_unique<Journal>(cfg.journal, cfg.journalSync);
+                    report.recovered = recover(cfg.journal, *matchBook);
+                }
+            } catch (...) {
+                failed = std::current_exception();
+            }
+            ready.count_down();
+            if (failed) {return;}
+
+            ThreadCounters counters;
+            counters.start();
+            if constexpr (std::is_invocable_v<Match, Queue&, Book&, Journal*>) {
+                match(*queue, *matchBook, matchJournal.get());
+            } else {
+                match(*queue, *matchBook);
+            }
+            report.match = counters.stop();
+            if (matchJournal) {matchJournal->flush();}
+        });
+
+        std::jthread ingester([&] {
+            report.ingestPinned = cfg.ingestCpu >= 0 && pinCurrentThread(cfg.ingestCpu);
+            ready.wait();
+            if (failed) {return;}
+
+            ThreadCounters counters;
+            counters.start();
+            ingest(*queue);
+            report.ingest = counters.stop();
+        });
+
+        ingester.join();
+        matcher.join();
+        if (queue != nullptr) {queue->~Queue();}
+        if (failed) {std::rethrow_exception(failed);}
+        return report;
+    }
+
+    // The Book from the last run(), nullptr before the first. Not safe to use while run() is going
+    [[nodiscard]] Book* book() noexcept {return matchBook.get();}
+
+private:
+    RuntimeConfig cfg;
+    std::unique_ptr<Book> matchBook;
+    std::unique_ptr<Journal> matchJournal;
+};
@@ -0,0 +1,119 @@
+#include "SharedQ.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool readStat(const int32_t pid, char& state, uint64_t& started) noexcept {
+    // State and start time (fields 3 and 22) of /proc/<pid>/stat. The name in field 2 may hold spaces and brackets,
+    // so parsing starts after its last ')'
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    std::FILE* f = std::fopen(path, "r");
+    if (f == nullptr) {return false;}
+    char buf[1'024];
+    const std::size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+    std::fclose(f);
+    buf[n] = '\0';
+
+    const char* p = std::strrchr(buf, ')');
+    if (p == nullptr) {return false;}
+    unsigned long long start = 0;
+    // State, then 18 fields to skip before starttime
+    if (std::sscanf(p + 2, "%c %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %llu",
+                    &state, &start) != 2) {
+        return false;
+    }
+    started = start;
+    return true;
+}
+
+std::runtime_error failure(const std::string& what, const std::string& name) {
+    return std::runtime_error("SharedSegment: " + what + " " + name + ": " + std::strerror(errno));
+}
+
+}
+
+ProcessId currentProcess() {
+    ProcessId self{static_cast<int32_t>(::getpid()), 0};
+    char state = 0;
+    if (!readStat(self.pid, state, self.started)) {throw std::runtime_error("currentProcess: can't read /proc/self/stat");}
+    return self;
+}
+
+bool processAlive(const ProcessId& p) noexcept {
+    char state = 0;
+    uint64_t started = 0;
+    if (p.pid <= 0 || !readStat(p.pid, state, started)) {return false;}
+    if (state == 'Z' || state == 'X') {return false;}
+    return p.started == 0 || started == p.started;
+}
+
+bool processAlive(const uint64_t packed) noexcept {
+    char state = 0;
+    uint64_t started = 0;
+    const auto pid = static_cast<int32_t>(packed >> 32);
+    if (pid <= 0 || !readStat(pid, state, started)) {return false;}
+    if (state == 'Z' || state == 'X') {return false;}
+    return static_cast<uint32_t>(started) == static_cast<uint32_t>(packed);
+}
+
+const char* toString(const PeerState s) noexcept {
+    switch (s) {
+    case PeerState::DETACHED: return "DETACHED";
+    case PeerState::ALIVE:    return "ALIVE";
+    case PeerState::CRASHED:  return "CRASHED";
+    }
+    return "?";
+}
+
+SharedSegment::SharedSegment(const std::string& name, const std::size_t size) : bytes(size) {
+    const std::string path = "/" + name;
+    int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd >= 0) {
+        creator = true;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const std::runtime_error e = failure("can't size", name);
+            ::close(fd);
+            ::shm_unlink(path.c_str());
+            throw e;
+        }
+    } else if (errno == EEXIST) {
+        if ((fd = ::shm_open(path.c_str(), O_RDWR | O_CLOEXEC, 0600)) < 0) {throw failure("can't open", name);}
+        // The creator may not have sized it yet
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        struct stat st{};
+        while (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) < bytes) {
+            if (st.st_size != 0 || std::chrono::steady_clock::now() > deadline) {
+                ::close(fd);
+                throw std::runtime_error("SharedSegment: " + name + " is " + std::to_string(st.st_size)
+                                         + " bytes, expected " + std::to_string(bytes));
+            }
+            std::this_thread::yield();
+        }
+    } else {
+        throw failure("can't create", name);
+    }
+
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        const std::runtime_error e = failure("can't map", name);
+        if (creator) {::shm_unlink(path.c_str());}
+        throw e;
+    }
+    base = p;
+}
+
+SharedSegment::~SharedSegment() {
+    if (base != nullptr) {::munmap(base, bytes);}
+}
+
+bool SharedSegment::remove(const std::string& name) noexcept {
+    return ::shm_unlink(("/" + name).c_str()) == 0;
+}
@@ -0,0 +1,218 @@
+// The SharedSpscQ class, an SpscQ in a named shared memory segment so a producer and a consumer in different
+// processes exchange orders through memory
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "Ring.hpp"
+#include "SpscQ.hpp"
+#include "WaitStrategy.hpp"
+
+// A process, told apart from a later one that reuses its PID by when it started
+struct ProcessId{
+    int32_t pid = 0;
+    uint64_t started = 0; // Start time in clock ticks since boot, from /proc/<pid>/stat. 0 matches any
+};
+
+// The calling process
+ProcessId currentProcess();
+
+// Whether the process is still running. Exited, not yet reaped (zombie) and replaced by another with the same PID
+// all count as gone. Both processes must be in the same PID namespace
+bool processAlive(const ProcessId& p) noexcept;
+
+// A process in one word, so it can be claimed and read with a single atomic: the pid in the high 32 bits and the low
+// 32 bits of its start time below. 0 is no process
+inline uint64_t packProcess(const ProcessId& p) noexcept {
+    return (uint64_t{static_cast<uint32_t>(p.pid)} << 32) | static_cast<uint32_t>(p.started);
+}
+
+// processAlive for a packed process, matching on the low 32 bits of the start time
+bool processAlive(uint64_t packed) noexcept;
+
+class SharedSegment{
+// A named POSIX shared memory segment (/dev/shm/<name>), mapped read write and faulted in. Opens it if it exists,
+// otherwise creates it at bytes (created() says which). Exactly one of several processes racing to open a new name
+// creates it. Throws std::runtime_error if it can't be opened or mapped, or an existing one never reaches bytes
+    void* base = nullptr;
+    std::size_t bytes = 0;
+    bool creator = false;
+
+public:
+    SharedSegment(const std::string& name, std::size_t bytes);
+    ~SharedSegment();
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    [[nodiscard]] void* data() const noexcept {return base;}
+    [[nodiscard]] std::size_t size() const noexcept {return bytes;}
+    [[nodiscard]] bool created() const noexcept {return creator;}
+
+    // Removes the name, mappings already open stay valid. Returns false if there was no such segment
+    static bool remove(const std::string& name) noexcept;
+};
+
+enum class SharedRole : uint8_t{
+    PRODUCER,
+    CONSUMER
+};
+
+enum class PeerState : uint8_t{
+    DETACHED, // Never attached, or detached cleanly
+    ALIVE,    // Attached and its process is running
+    CRASHED   // Attached, but its process has gone without detaching
+};
+
+const char* toString(PeerState s) noexcept;
+
+struct SharedPeer{
+// Who holds one role. holder is the claim, the holder's packProcess word: pid and start time go in with one compare
+// and swap (from 0, or from a dead holder's) and are always read together. Cleared on detach
+    std::atomic<uint64_t> holder = 0;
+    std::atomic<uint64_t> attaches = 0; // Times the role has been taken
+};
+
+struct SharedQHeader{
+// Start of every segment. The creator fills it in and builds the queue, then sets ready.
+// Attaching checks every field, so processes built with a different queue type or version can't share a segment
+    char magic[8];            // sharedQMagic
+    uint32_t version;         // sharedQVersion
+    uint32_t headerBytes;     // sizeof(SharedQHeader)
+    uint64_t slotBytes;       // sizeof(O)
+    uint64_t slots;           // N
+    uint64_t queueBytes;      // sizeof(SpscQ<O, N, Wait>), differs between wait strategies
+    uint64_t queueOffset;     // Where the queue starts
+    std::atomic<uint32_t> ready;
+    alignas(cacheLine) SharedPeer peers[2]; // Indexed by SharedRole
+};
+
+inline constexpr char sharedQMagic[8] = {'O','B','S','H','M','Q','\0','\0'};
+inline constexpr uint32_t sharedQVersion = 2;
+
+static_assert(std::atomic<std::size_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free
+              && std::atomic<uint32_t>::is_always_lock_free, "Shared atomics must be lock free to work across processes");
+
+template<typename O, std::size_t N, typename Wait = BusySpin>
+class SharedSpscQ{
+// Attaches one side (producer or consumer) of an SpscQ that lives in the shared memory segment name, creating and
+// building it if no one has yet. The queue's indices, cached indices and slots are all in the segment and the
+// indices are lock free atomics, so the two sides run exactly the SpscQ code they would in one process. O must be
+// trivially copyable. Wait strategies that sleep must be process shared (SharedFutexWait, not FutexWait).
+//
+// Each role is held by one process at a time. A side that crashes leaves its claim behind: peer() reports it CRASHED
+// and a new process can take the role over, carrying on from the indices as they were. A consumer that crashed between
+// peek and release sees that order again, a producer's claimed but uncommitted slot is lost.
+// The *_wait calls don't check the peer, a side that has to notice a crash should use the non blocking calls and
+// check peer() while idle. Throws std::runtime_error if the segment doesn't match this queue type or the role is held
+    using Queue = SpscQ<O, N, Wait>;
+
+    static_assert(std::is_trivially_copyable_v<O>, "Slots are shared memory, raw bytes to the other process");
+
+    static constexpr std::size_t queueOffset = (sizeof(SharedQHeader) + alignof(Queue) - 1) / alignof(Queue)
+                                             * alignof(Queue);
+    static constexpr auto buildTimeout = std::chrono::seconds(1);
+
+    SharedSegment segment;
+    SharedRole role;
+    SharedQHeader* header = nullptr;
+    Queue* q = nullptr;
+    bool attached = false;
+
+    void build() {
+        header = new (segment.data()) SharedQHeader();
+        std::memcpy(header->magic, sharedQMagic, sizeof(sharedQMagic));
+        header->version = sharedQVersion;
+        header->headerBytes = sizeof(SharedQHeader);
+        header->slotBytes = sizeof(O);
+        header->slots = N;
+        header->queueBytes = sizeof(Queue);
+        header->queueOffset = queueOffset;
+        q = new (static_cast<std::byte*>(segment.data()) + queueOffset) Queue();
+        header->ready.store(1, std::memory_order_release);
+    }
+
+    void check() {
+        // Waits for the creator to finish building, then compares the layout with this queue type's
+        header = std::launder(static_cast<SharedQHeader*>(segment.data()));
+        const auto deadline = std::chrono::steady_clock::now() + buildTimeout;
+        while (header->ready.load(std::memory_order_acquire) == 0) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw std::runtime_error("SharedSpscQ: segment never finished building, its creator may have crashed");
+            }
+            std::this_thread::yield();
+        }
+        if (std::memcmp(header->magic, sharedQMagic, sizeof(sharedQMagic)) != 0 || header->version != sharedQVersion) {
+            throw std::runtime_error("SharedSpscQ: segment isn't a shared queue of this version");
+        }
+        if (header->headerBytes != sizeof(SharedQHeader) || header->slotBytes != sizeof(O) || header->slots != N
+            || header->queueBytes != sizeof(Queue) || header->queueOffset != queueOffset) {
+            throw std::runtime_error("SharedSpscQ: segment holds a different queue type");
+        }
+        q = std::launder(reinterpret_cast<Queue*>(static_cast<std::byte*>(segment.data()) + queueOffset));
+    }
+
+    void claim() {
+        SharedPeer& p = header->peers[static_cast<std::size_t>(role)];
+        const uint64_t self = packProcess(currentProcess());
+        uint64_t holder = 0;
+        while (!p.holder.compare_exchange_strong(holder, self, std::memory_order_acq_rel)) {
+            // Held: only a holder that has gone can be replaced. Two processes replacing the same one both swap from
+            // its word, so only one can win, and the other then sees the winner alive
+            if (processAlive(holder)) {
+                throw std::runtime_error(std::string("SharedSpscQ: ") + (role == SharedRole::PRODUCER ? "producer" : "consumer")
+                                         + " already attached by process " + std::to_string(holder >> 32));
+            }
+        }
+        p.attaches.fetch_add(1, std::memory_order_relaxed);
+        attached = true;
+    }
+
+public:
+    SharedSpscQ(const std::string& name, const SharedRole r)
+        : segment(name, queueOffset + sizeof(Queue)), role(r) {
+        if (segment.created()) {build();}
+        else {check();}
+        claim();
+    }
+
+    ~SharedSpscQ() {detach();}
+
+    SharedSpscQ(const SharedSpscQ&) = delete;
+    SharedSpscQ& operator=(const SharedSpscQ&) = delete;
+
+    // Gives up the role so another process can take it. The segment stays, and so does anything in the queue
+    void detach() noexcept {
+        if (!attached) {return;}
+        header->peers[static_cast<std::size_t>(role)].holder.store(0, std::memory_order_release);
+        attached = false;
+    }
+
+    // The queue, to be used only as this side: claim/commit, push and friends for a producer, peek/release, pop and
+    // friends for a consumer
+    [[nodiscard]] Queue& queue() noexcept {return *q;}
+
+    [[nodiscard]] SharedRole side() const noexcept {return role;}
+
+    [[nodiscard]] PeerState peer() const noexcept {
+        // State of the process holding the other role
+        const uint64_t holder = header->peers[role == SharedRole::PRODUCER ? 1 : 0].holder.load(std::memory_order_acquire);
+        if (holder == 0) {return PeerState::DETACHED;}
+        return processAlive(holder) ? PeerState::ALIVE : PeerState::CRASHED;
+    }
+
+    // Times the other role has been taken, counting the current holder. Goes up when a crashed peer is replaced
+    [[nodiscard]] uint64_t peerAttaches() const noexcept {
+        return header->peers[role == SharedRole::PRODUCER ? 1 : 0].attaches.load(std::memory_order_relaxed);
+    }
+};
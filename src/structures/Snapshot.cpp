@@ -0,0 +1,137 @@
+#include "Snapshot.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SnapshotWriter::SnapshotWriter(const std::string& path, const double tickSize, const uint64_t seq, const uint64_t lastSeq,
+                               const int64_t lastTrade, const uint64_t sellOrders, const uint64_t buyOrders)
+    : path(path), temp(path + ".tmp") {
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.recordSize = sizeof(SnapshotOrder);
+    header.tickSize = tickSize;
+    header.seq = seq;
+    header.lastSeq = lastSeq;
+    header.lastTrade = lastTrade;
+    header.sellOrders = sellOrders;
+    header.buyOrders = buyOrders;
+    bytes = sizeof(SnapshotHeader) + (sellOrders + buyOrders) * sizeof(SnapshotOrder);
+
+    // The last snapshot at path stays as it is until this one is complete
+    fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {throw std::runtime_error("SnapshotWriter: can't open " + temp);}
+
+    // Reserve the blocks now, so a full disk is an error here rather than a SIGBUS while writing through the mapping
+    if (::posix_fallocate(fd, 0, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        ::unlink(temp.c_str());
+        throw std::runtime_error("SnapshotWriter: can't size " + temp);
+    }
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd);
+        ::unlink(temp.c_str());
+        throw std::runtime_error("SnapshotWriter: can't map " + temp);
+    }
+    base = static_cast<std::byte*>(p);
+
+    // Everything but the magic, which stays zero until close()
+    std::memcpy(base + sizeof(header.magic), reinterpret_cast<const std::byte*>(&header) + sizeof(header.magic),
+                sizeof(header) - sizeof(header.magic));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    // Abandoned before close(): the temporary file goes, whatever was at path stays
+    if (base == nullptr) {return;}
+    ::munmap(base, bytes);
+    ::close(fd);
+    ::unlink(temp.c_str());
+}
+
+namespace {
+
+bool syncFile(const int fd) noexcept {
+    // fsync(2), retried if a signal interrupts it
+    int r = 0;
+    do {r = ::fsync(fd);} while (r != 0 && errno == EINTR);
+    return r == 0;
+}
+
+bool syncDirectory(const std::string& file) noexcept {
+    // Makes the file's directory entry durable, so the renamed snapshot can't vanish after close() returns
+    const std::filesystem::path dir = std::filesystem::path(file).parent_path();
+    const int d = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (d < 0) {return false;}
+    const bool ok = syncFile(d);
+    ::close(d);
+    return ok;
+}
+
+}
+
+void SnapshotWriter::close() {
+    if (base == nullptr) {return;}
+
+    // Orders first, then the magic that marks them complete
+    bool ok = ::msync(base, bytes, MS_SYNC) == 0;
+    if (ok) {
+        std::memcpy(base, header.magic, sizeof(header.magic));
+        ok = ::msync(base, sizeof(header), MS_SYNC) == 0;
+    }
+    ::munmap(base, bytes);
+    base = nullptr;
+    ok = ok && syncFile(fd);
+    ::close(fd);
+    fd = -1;
+    if (!ok) {
+        ::unlink(temp.c_str());
+        throw std::runtime_error("SnapshotWriter: can't sync " + temp);
+    }
+
+    // Only a complete, synced snapshot replaces the last one
+    if (::rename(temp.c_str(), path.c_str()) != 0) {
+        ::unlink(temp.c_str());
+        throw std::runtime_error("SnapshotWriter: can't rename " + temp + " to " + path);
+    }
+    if (!syncDirectory(path)) {throw std::runtime_error("SnapshotWriter: can't sync the directory of " + path);}
+}
+
+SnapshotFile::SnapshotFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {throw std::runtime_error("SnapshotFile: can't open " + path);}
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        throw std::runtime_error("SnapshotFile: " + path + " is too short for a snapshot");
+    }
+    bytes = static_cast<std::size_t>(st.st_size);
+
+    void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {throw std::runtime_error("SnapshotFile: can't map " + path);}
+    base = static_cast<const std::byte*>(p);
+    ::madvise(p, bytes, MADV_SEQUENTIAL);
+
+    std::memcpy(&header, base, sizeof(header));
+    const std::size_t records = (bytes - sizeof(SnapshotHeader)) / sizeof(SnapshotOrder);
+    const bool valid = std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) == 0 &&
+                       header.version == snapshotVersion && header.recordSize == sizeof(SnapshotOrder) &&
+                       header.sellOrders <= records && header.buyOrders <= records - header.sellOrders;
+    if (!valid) {
+        ::munmap(p, bytes);
+        throw std::runtime_error("SnapshotFile: " + path + " isn't a complete version " +
+                                 std::to_string(snapshotVersion) + " snapshot");
+    }
+}
+
+SnapshotFile::~SnapshotFile() {
+    ::munmap(const_cast<std::byte*>(base), bytes);
+}
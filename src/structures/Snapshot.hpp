@@ -0,0 +1,100 @@
+// Binary Book snapshots: every resting order in priority order, for a warm restart without replaying the flow
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+
+struct SnapshotHeader{
+// Start of every snapshot file. The sell orders follow it, best price first and oldest first within a price,
+// then the buy orders the same way
+    char magic[8];       // snapshotMagic
+    uint32_t version;    // snapshotVersion
+    uint32_t recordSize; // sizeof(SnapshotOrder)
+    double tickSize;     // Tick of the Book that wrote it, a Book can only load a snapshot on the same tick
+    uint64_t seq;        // Journal sequence number the snapshot covers up to, 0 if none
+    uint64_t sellOrders;
+    uint64_t buyOrders;
+    uint64_t lastSeq;    // Order sequence number the Book had handed out, so a loaded Book carries on after it
+    int64_t lastTrade;   // Book's last fill price in ticks, for price bands
+};
+
+struct SnapshotOrder{
+// One resting order, prices in ticks of the header's tickSize. Its target quantity is executed + unexecuted
+    int64_t price;
+    int64_t notional;     // Sum of quantity x price (in ticks) executed so far
+    int64_t execQty;
+    int64_t unexecQty;
+    uint64_t timestamp;
+    uint64_t seq;
+    int32_t orderID;
+    uint32_t participant;
+};
+
+inline constexpr char snapshotMagic[8] = {'O','B','S','N','A','P','\0','\0'};
+inline constexpr uint32_t snapshotVersion = 3;
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader is the on-disk layout");
+static_assert(std::is_trivially_copyable_v<SnapshotOrder> && sizeof(SnapshotOrder) == 56, "SnapshotOrder is the on-disk layout");
+
+class SnapshotWriter{
+// Creates a snapshot at its final size in <path>.tmp and maps it read/write, so the orders can be filled in any order
+// (the Book fills many price levels at once). The header is written up front, except for its magic, which close()
+// adds once the orders are on disk. close() then renames the file over path, so the last good snapshot at path is
+// only replaced by a complete one. A writer abandoned before close() removes its temporary file.
+// Throws std::runtime_error if the file can't be created, sized or mapped
+    std::byte* base = nullptr;
+    std::size_t bytes = 0;
+    int fd = -1;
+    std::string path; // Where the snapshot ends up
+    std::string temp; // Where it's written until close()
+    SnapshotHeader header{};
+
+public:
+    SnapshotWriter(const std::string& path, double tickSize, uint64_t seq, uint64_t lastSeq, int64_t lastTrade,
+                   uint64_t sellOrders, uint64_t buyOrders);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Where the sell and buy orders go, each in priority order
+    [[nodiscard]] std::span<SnapshotOrder> sells() noexcept {
+        return {reinterpret_cast<SnapshotOrder*>(base + sizeof(SnapshotHeader)), header.sellOrders};
+    }
+    [[nodiscard]] std::span<SnapshotOrder> buys() noexcept {
+        return {sells().data() + header.sellOrders, header.buyOrders};
+    }
+
+    // Syncs the orders, then marks the header complete and syncs it and the file, renames it over path and syncs the
+    // directory. Throws std::runtime_error if a sync or the rename fails, leaving whatever was at path untouched.
+    // A writer destroyed without close() leaves path as it was
+    void close();
+};
+
+class SnapshotFile{
+// A snapshot mapped read only, so loading reads the orders straight out of the page cache.
+// Throws std::runtime_error if the file can't be mapped or isn't a snapshot
+    const std::byte* base = nullptr;
+    std::size_t bytes = 0;
+    SnapshotHeader header{};
+
+public:
+    explicit SnapshotFile(const std::string& path);
+    ~SnapshotFile();
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    [[nodiscard]] const SnapshotHeader& info() const noexcept {return header;}
+
+    [[nodiscard]] std::span<const SnapshotOrder> sells() const noexcept {
+        return {reinterpret_cast<const SnapshotOrder*>(base + sizeof(SnapshotHeader)), header.sellOrders};
+    }
+    [[nodiscard]] std::span<const SnapshotOrder> buys() const noexcept {
+        return {sells().data() + header.sellOrders, header.buyOrders};
+    }
+};
@@ -3,25 +3,115 @@
 #pragma once
 
 #include "Ring.hpp"
+#include "WaitStrategy.hpp"
 #include <optional>
+#include <span>
 
 // SpscQ class
 // Single Producer Single Consumer Queue
 // Provides a simple interface to the underlying Ring buffer
-template<typename O, size_t N>
+// Holds up to N - 1 orders. A power of two N lets index wrapping use a mask.
+// Wait is what the *_wait calls do while the queue is full or empty, see WaitStrategy.hpp.
+// Every call that publishes notifies the other side, which costs nothing unless Wait can sleep
+template<typename O, size_t N, typename Wait = BusySpin>
 class SpscQ {
 public:
 
     // Instantiates a Ring buffer of size N for Order (O)
     Ring<O, N> ring;
 
+private:
+    [[no_unique_address]] Wait notFull;  // Producer waits for space, consumer notifies as it frees slots
+    [[no_unique_address]] Wait notEmpty; // Consumer waits for orders, producer notifies as it publishes
+
+public:
     bool push(const O& o) {
-        return ring.push(o);
+        const bool pushed = ring.push(o);
+        if (pushed) {notEmpty.notify();}
+        return pushed;
     }
 
     std::optional<O> pop() {
-        return ring.pop();
+        std::optional<O> o = ring.pop();
+        if (o) {notFull.notify();}
+        return o;
+    }
+
+    // In place versions, no copy through a temporary.
+    // Producer: write into *claim() (nullptr when full), then commit().
+    // Consumer: read *peek() (nullptr when empty), then release(). A slot may not be touched after it's committed/released
+    O* claim() noexcept {
+        return ring.claim();
+    }
+
+    void commit() noexcept {
+        ring.commit();
+        notEmpty.notify();
+    }
+
+    const O* peek() noexcept {
+        return ring.peek();
+    }
+
+    void release() noexcept {
+        ring.release();
+        notFull.notify();
+    }
+
+    // Batch versions, one index publish per call rather than per order.
+    // Both move as many as they can and return the count, which may be less than requested
+    size_t push_n(std::span<const O> in) {
+        const size_t count = ring.push_n(in);
+        if (count != 0) {notEmpty.notify();}
+        return count;
+    }
+
+    size_t pop_n(std::span<O> out) {
+        const size_t count = ring.pop_n(out);
+        if (count != 0) {notFull.notify();}
+        return count;
+    }
+
+    // In place batch: read up to max committed slots from peek_n(), then hand back the ones used with release_n()
+    std::span<const O> peek_n(const size_t max) noexcept {
+        return ring.peek_n(max);
+    }
+
+    void release_n(const size_t count) noexcept {
+        ring.release_n(count);
+        notFull.notify();
+    }
+
+    // Blocking versions, wait with the Wait strategy until there's space or an order, never fail
+    void push_wait(const O& o) {
+        notFull.await([&] {return ring.push(o);});
+        notEmpty.notify();
     }
-};
 
+    O pop_wait() {
+        std::optional<O> o;
+        notEmpty.await([&] {return (o = ring.pop()).has_value();});
+        notFull.notify();
+        return *o;
+    }
+
+    // Claimed and peeked slots are handed back with commit() and release() as above
+    O* claim_wait() {
+        O* slot = nullptr;
+        notFull.await([&] {return (slot = ring.claim()) != nullptr;});
+        return slot;
+    }
 
+    const O* peek_wait() {
+        const O* slot = nullptr;
+        notEmpty.await([&] {return (slot = ring.peek()) != nullptr;});
+        return slot;
+    }
+
+    // At least one order, up to max
+    std::span<const O> peek_n_wait(const size_t max) {
+        std::span<const O> batch;
+        notEmpty.await([&] {return !(batch = ring.peek_n(max)).empty();});
+        return batch;
+    }
+};
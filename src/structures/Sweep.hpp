@@ -0,0 +1,62 @@
+// Prefix sums over price level quantities, how far an aggressive order reaches before it stops clearing levels
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// levelsCleared below, one level at a time from level i on, total being the sum of the levels before i
+inline std::size_t levelsClearedScalar(const std::span<const int64_t> qty, const int64_t want, std::size_t i = 0,
+                                       int64_t total = 0) noexcept {
+    for (; i < qty.size(); ++i) {
+        total += qty[i];
+        if (total > want) {return i;}
+    }
+    return qty.size();
+}
+
+#if defined(__x86_64__)
+// levelsCleared below, taking the sums four levels at a time, each block carrying the previous block's total in.
+// Only this function is built for AVX2, and levelsCleared only calls it when the CPU has it,
+// so the default build gets the vector path without -mavx2 and still runs on any x86-64
+[[gnu::target("avx2")]]
+inline std::size_t levelsClearedAvx2(const std::span<const int64_t> qty, const int64_t want) noexcept {
+    const __m256i limit = _mm256_set1_epi64x(want);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero; // Previous blocks' total in every lane
+    std::size_t i = 0;
+    for (; i + 4 <= qty.size(); i += 4) {
+        __m256i sums = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qty.data() + i));
+        // In block prefix sum: add the block shifted up one lane, then two
+        sums = _mm256_add_epi64(sums, _mm256_blend_epi32(_mm256_permute4x64_epi64(sums, 0x90), zero, 0x03));
+        sums = _mm256_add_epi64(sums, _mm256_blend_epi32(_mm256_permute4x64_epi64(sums, 0x40), zero, 0x0F));
+        sums = _mm256_add_epi64(sums, carry);
+
+        const int over = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(sums, limit)));
+        if (over != 0) {return i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(over)));}
+        carry = _mm256_permute4x64_epi64(sums, 0xFF);
+    }
+    return levelsClearedScalar(qty, want, i, _mm256_extract_epi64(carry, 0));
+}
+
+// Read once at startup, so the check on each call is a predictable branch
+inline const bool hasAvx2 = [] {
+    __builtin_cpu_init(); // May run before the CPU model is read at startup
+    return __builtin_cpu_supports("avx2") != 0;
+}();
+#endif
+
+// How many of the leading levels an order for want takes in full: the longest prefix of qty whose sum is at most want.
+// Level quantities are positive, so the running sums only rise and the first sum over want ends the prefix
+inline std::size_t levelsCleared(const std::span<const int64_t> qty, const int64_t want) noexcept {
+#if defined(__x86_64__)
+    if (hasAvx2) {return levelsClearedAvx2(qty, want);}
+#endif
+    return levelsClearedScalar(qty, want);
+}
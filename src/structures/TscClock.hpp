@@ -0,0 +1,57 @@
+// The TscClock, a cycle counter read for latency measurements on the matching path
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+struct TscClock{
+// Raw ticks from the time stamp counter (rdtsc), a couple of dozen cycles to read, against the ~20ns of a
+// steady_clock call. Ticks are only good for differences and are turned into nanoseconds with a rate measured
+// once against steady_clock. Assumes an invariant TSC (constant rate, synchronised across cores), which every
+// x86 server of the last decade has. Elsewhere it falls back to steady_clock nanoseconds
+
+    [[nodiscard]] static uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Low 32 bits of now(), small enough to travel in an OrderCommand. Wraps every few seconds at GHz rates,
+    // so only good for intervals shorter than that
+    [[nodiscard]] static uint32_t stamp() noexcept {return static_cast<uint32_t>(now());}
+
+    // Ticks from a stamp to a later now(), correct across the wrap
+    [[nodiscard]] static uint64_t since(const uint32_t stamp, const uint64_t later) noexcept {
+        return static_cast<uint32_t>(static_cast<uint32_t>(later) - stamp);
+    }
+
+    // Nanoseconds per tick, measured on first use (takes ~10ms, once)
+    [[nodiscard]] static double nsPerTick() noexcept {
+        static const double rate = calibrate();
+        return rate;
+    }
+
+    [[nodiscard]] static double toNs(const uint64_t ticks) noexcept {return static_cast<double>(ticks) * nsPerTick();}
+
+private:
+    static double calibrate() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        using namespace std::chrono;
+        const auto t0 = steady_clock::now();
+        const uint64_t c0 = now();
+        auto t1 = t0;
+        while ((t1 = steady_clock::now()) - t0 < milliseconds(10)) {}
+        const uint64_t c1 = now();
+        return static_cast<double>(duration_cast<nanoseconds>(t1 - t0).count()) / static_cast<double>(c1 - c0);
+#else
+        return 1.0;
+#endif
+    }
+};
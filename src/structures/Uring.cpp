@@ -0,0 +1,175 @@
+#include "Uring.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+int setup(const unsigned entries, io_uring_params& p) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+}
+
+void* mapRing(const int fd, const std::size_t bytes, const uint64_t offset) noexcept {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(offset));
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+std::runtime_error failure(const std::string& what) {
+    return std::runtime_error("Uring: " + what + ": " + std::strerror(errno));
+}
+
+}
+
+Uring::Uring(const unsigned entries) {
+    // Newest setup flags first, dropping them for older kernels. The completion queue is four times the submission
+    // queue, as one multishot receive posts many completions
+    const unsigned tries[] = {IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN, IORING_SETUP_COOP_TASKRUN, 0};
+    io_uring_params p{};
+    for (const unsigned flags : tries) {
+        p = {};
+        p.flags = flags | IORING_SETUP_CQSIZE;
+        p.cq_entries = entries * 4;
+        if ((ringFd = setup(entries, p)) >= 0 || errno != EINVAL) {break;}
+    }
+    if (ringFd < 0) {throw failure("io_uring_setup failed");}
+    if ((p.features & IORING_FEAT_EXT_ARG) == 0 || (p.features & IORING_FEAT_NODROP) == 0) {
+        ::close(ringFd);
+        throw std::runtime_error("Uring: kernel too old, needs 5.11 or later");
+    }
+
+    sqMapBytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqMapBytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    sqesBytes = p.sq_entries * sizeof(io_uring_sqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {sqMapBytes = cqMapBytes = std::max(sqMapBytes, cqMapBytes);}
+
+    sqMap = mapRing(ringFd, sqMapBytes, IORING_OFF_SQ_RING);
+    cqMap = (p.features & IORING_FEAT_SINGLE_MMAP) ? sqMap : mapRing(ringFd, cqMapBytes, IORING_OFF_CQ_RING);
+    sqes = static_cast<io_uring_sqe*>(mapRing(ringFd, sqesBytes, IORING_OFF_SQES));
+    if (sqMap == nullptr || cqMap == nullptr || sqes == nullptr) {
+        const std::runtime_error e = failure("mapping the rings failed");
+        unmap();
+        throw e;
+    }
+
+    auto* sq = static_cast<std::byte*>(sqMap);
+    sqHead = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sqEntries = p.sq_entries;
+    // Entries are always used in ring order, so the indirection array is set once to the identity
+    auto* array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    for (unsigned i = 0; i < sqEntries; ++i) {array[i] = i;}
+
+    auto* cq = static_cast<std::byte*>(cqMap);
+    cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+}
+
+Uring::~Uring() {unmap();}
+
+void Uring::unmap() noexcept {
+    if (sqes != nullptr) {::munmap(sqes, sqesBytes);}
+    if (cqMap != nullptr && cqMap != sqMap) {::munmap(cqMap, cqMapBytes);}
+    if (sqMap != nullptr) {::munmap(sqMap, sqMapBytes);}
+    if (ringFd >= 0) {::close(ringFd);}
+    sqes = nullptr;
+    cqMap = sqMap = nullptr;
+    ringFd = -1;
+}
+
+bool Uring::supported() noexcept {
+    io_uring_params p{};
+    const int fd = setup(1, p);
+    if (fd < 0) {return false;}
+    ::close(fd);
+    return (p.features & IORING_FEAT_EXT_ARG) != 0;
+}
+
+int Uring::enter(const unsigned submit, const unsigned waitFor, const unsigned flags, const void* arg,
+                 const std::size_t argBytes) {
+    enters++;
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, submit, waitFor, flags, arg, argBytes));
+}
+
+io_uring_sqe& Uring::sqe() {
+    const unsigned tail = *sqTail;
+    if (tail - std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire) == sqEntries) {
+        // Full: hand what's queued to the kernel now, without waiting on anything
+        const int n = enter(queued, 0, 0, nullptr, 0);
+        if (n < 0) {throw failure("io_uring_enter failed");}
+        queued -= static_cast<unsigned>(n);
+    }
+    io_uring_sqe& e = sqes[tail & sqMask];
+    std::memset(&e, 0, sizeof(e));
+    std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+    queued++;
+    return e;
+}
+
+unsigned Uring::submitAndWait(const unsigned waitFor, const std::chrono::nanoseconds timeout) {
+    __kernel_timespec ts{};
+    ts.tv_sec = timeout.count() / 1'000'000'000;
+    ts.tv_nsec = timeout.count() % 1'000'000'000;
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    const int n = enter(queued, waitFor, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    if (n < 0) {
+        // Timed out or interrupted with nothing submitted, or the completion queue is backed up: the caller drains
+        if (errno == ETIME || errno == EINTR || errno == EAGAIN || errno == EBUSY) {return 0;}
+        throw failure("io_uring_enter failed");
+    }
+    queued -= static_cast<unsigned>(n);
+    return static_cast<unsigned>(n);
+}
+
+BufferRing::BufferRing(Uring& r, const uint16_t g, const unsigned c, const unsigned s)
+    : ring(r), group(g), count(c), size(s) {
+    if (count == 0 || count > 32'768 || (count & (count - 1)) != 0) {
+        throw std::runtime_error("BufferRing: count must be a power of 2 up to 32768");
+    }
+    entriesBytes = count * sizeof(io_uring_buf);
+    dataBytes = std::size_t{count} * size;
+    void* e = ::mmap(nullptr, entriesBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    void* d = ::mmap(nullptr, dataBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (e == MAP_FAILED || d == MAP_FAILED) {
+        if (e != MAP_FAILED) {::munmap(e, entriesBytes);}
+        if (d != MAP_FAILED) {::munmap(d, dataBytes);}
+        throw failure("mapping the buffers failed");
+    }
+    entries = static_cast<io_uring_buf*>(e);
+    data = static_cast<std::byte*>(d);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(entries);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (::syscall(__NR_io_uring_register, ring.fd(), IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        const std::runtime_error err = failure("registering the buffer ring failed");
+        ::munmap(entries, entriesBytes);
+        ::munmap(data, dataBytes);
+        throw err;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {recycle(static_cast<uint16_t>(i));}
+    publish();
+}
+
+BufferRing::~BufferRing() {
+    io_uring_buf_reg reg{};
+    reg.bgid = group;
+    ::syscall(__NR_io_uring_register, ring.fd(), IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    ::munmap(entries, entriesBytes);
+    ::munmap(data, dataBytes);
+}
@@ -0,0 +1,110 @@
+// Uring and BufferRing, a minimal io_uring driven through the raw syscalls, the parts the gateway needs
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+class Uring{
+// One io_uring instance for the thread that builds it. Submission entries are queued with sqe() and all go to the
+// kernel in the next submitAndWait, one syscall however many there are. Completions are read in place by drain.
+// Built with SINGLE_ISSUER and DEFER_TASKRUN where the kernel has them, so completion work runs inside
+// submitAndWait on this thread rather than interrupting it. Throws std::runtime_error if the kernel has no io_uring,
+// it's blocked (e.g. by a container's seccomp profile), or it's older than 5.11
+    int ringFd = -1;
+    void* sqMap = nullptr;
+    std::size_t sqMapBytes = 0;
+    void* cqMap = nullptr;
+    std::size_t cqMapBytes = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqesBytes = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    unsigned queued = 0;     // Entries written since the last submit
+    uint64_t enters = 0;     // io_uring_enter calls
+
+    void unmap() noexcept;
+    int enter(unsigned submit, unsigned waitFor, unsigned flags, const void* arg, std::size_t argBytes);
+
+public:
+    explicit Uring(unsigned entries);
+    ~Uring();
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    // Whether this process can create a ring at all
+    [[nodiscard]] static bool supported() noexcept;
+
+    [[nodiscard]] int fd() const noexcept {return ringFd;}
+    [[nodiscard]] uint64_t syscalls() const noexcept {return enters;}
+
+    // Next submission entry, zeroed. If the submission queue is full what's queued is submitted first
+    io_uring_sqe& sqe();
+
+    // Submits everything queued and waits until waitFor completions are ready or timeout passes, in one syscall.
+    // Returns how many entries were submitted
+    unsigned submitAndWait(unsigned waitFor, std::chrono::nanoseconds timeout);
+
+    template<typename F>
+    unsigned drain(F&& f) {
+        // Calls f(cqe) for each ready completion in order, then hands their slots back to the kernel.
+        // f may queue new entries. Returns how many there were
+        const unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+        unsigned head = *cqHead;
+        const unsigned n = tail - head;
+        for (; head != tail; ++head) {f(cqes[head & cqMask]);}
+        std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+        return n;
+    }
+};
+
+class BufferRing{
+// A provided buffer ring registered with a Uring: count buffers of size bytes the kernel picks from for receives
+// marked IOSQE_BUFFER_SELECT with this group. A completion names the buffer it filled, which stays the caller's
+// until recycle hands it back. Recycled buffers reach the kernel together at the next publish.
+// count must be a power of 2 up to 32768. Throws std::runtime_error if the kernel can't register it (before 5.19)
+    Uring& ring;
+    uint16_t group;
+    unsigned count;
+    unsigned size;
+    // The ring is an array of io_uring_buf whose first entry's resv field is the tail. Not reached through
+    // io_uring_buf_ring: in C++ its flexible array member sits 8 bytes in rather than at the start
+    io_uring_buf* entries = nullptr;
+    std::size_t entriesBytes = 0;
+    std::byte* data = nullptr;
+    std::size_t dataBytes = 0;
+    uint16_t tail = 0;
+
+public:
+    BufferRing(Uring& ring, uint16_t group, unsigned count, unsigned size);
+    ~BufferRing();
+
+    BufferRing(const BufferRing&) = delete;
+    BufferRing& operator=(const BufferRing&) = delete;
+
+    [[nodiscard]] uint16_t id() const noexcept {return group;}
+    [[nodiscard]] const std::byte* buffer(const uint16_t bid) const noexcept {return data + std::size_t{bid} * size;}
+
+    void recycle(const uint16_t bid) noexcept {
+        io_uring_buf& b = entries[tail & (count - 1)];
+        b.addr = reinterpret_cast<uint64_t>(data + std::size_t{bid} * size);
+        b.len = size;
+        b.bid = bid;
+        ++tail;
+    }
+
+    void publish() noexcept {std::atomic_ref<uint16_t>(entries[0].resv).store(tail, std::memory_order_release);}
+};
@@ -0,0 +1,107 @@
+// Wait strategies, what a queue endpoint does while the queue isn't ready for it (full for a producer, empty for a consumer)
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Ring.hpp"
+
+// Every strategy has the same two calls:
+//  - await(ready): returns once ready() is true, ready() is retried until then
+//  - notify():     called by the other side after it publishes, so a sleeping waiter can be woken.
+//                  Strategies that never sleep leave it empty and it compiles away
+
+inline void cpuRelax() noexcept {
+    // Spin loop hint: frees the core's pipeline for a hyperthread sibling and avoids the memory order
+    // misspeculation flush when the spin ends
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+struct BusySpin{
+// Retries straight away. Lowest latency, keeps its core at 100% whether or not there's work
+    template<typename Ready>
+    void await(Ready&& ready) {while (!ready()) {}}
+
+    void notify() noexcept {}
+};
+
+struct PauseSpin{
+// Retries after a pause. Still 100% of a core, but kinder to a hyperthread sibling and to power,
+// and a few ns slower to notice new work
+    template<typename Ready>
+    void await(Ready&& ready) {while (!ready()) {cpuRelax();}}
+
+    void notify() noexcept {}
+};
+
+template<unsigned Spins = 1'024>
+struct SpinThenYield{
+// Pause spins for Spins attempts, then yields to the scheduler between attempts. Other runnable threads get the core,
+// but with nothing else to run it's still 100%, one sched_yield syscall per attempt
+    template<typename Ready>
+    void await(Ready&& ready) {
+        for (unsigned i = 0; !ready(); ++i) {
+            if (i < Spins) {cpuRelax();}
+            else {std::this_thread::yield();}
+        }
+    }
+
+    void notify() noexcept {}
+};
+
+template<unsigned Spins = 1'024, bool Shared = false>
+class FutexWait{
+// Pause spins for Spins attempts, then sleeps in the kernel until the other side publishes, so an idle thread uses
+// no CPU. Waking costs a few microseconds. The publishing side pays a fence and a load on every notify,
+// and a FUTEX_WAKE syscall only when a waiter is actually asleep.
+// Private futexes are cheaper but only wake threads of the same process. Shared ones work for a queue
+// in memory mapped by two processes (SharedSpscQ)
+    static constexpr int waitOp = Shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+    static constexpr int wakeOp = Shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE;
+    alignas(cacheLine) std::atomic<uint32_t> epoch = 0; // Futex word, bumped by each notify that finds a sleeper
+    std::atomic<uint32_t> sleepers = 0;                 // Waiters past their spin budget
+
+    static void futex(std::atomic<uint32_t>* word, const int op, const uint32_t val) noexcept {
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, val, nullptr, nullptr, 0);
+    }
+
+public:
+    template<typename Ready>
+    void await(Ready&& ready) {
+        for (unsigned i = 0; i < Spins; ++i) {
+            if (ready()) {return;}
+            cpuRelax();
+        }
+        while (!ready()) {
+            const uint32_t seen = epoch.load(std::memory_order_acquire);
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // Checked again once registered: a notify either sees the sleeper and bumps epoch, so the wait returns
+            // straight away, or published before this check and it passes
+            if (!ready()) {futex(&epoch, waitOp, seen);}
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Orders the caller's publish before reading sleepers
+        if (sleepers.load(std::memory_order_relaxed) != 0) {
+            epoch.fetch_add(1, std::memory_order_release);
+            futex(&epoch, wakeOp, INT_MAX);
+        }
+    }
+};
+
+template<unsigned Spins = 1'024>
+using SharedFutexWait = FutexWait<Spins, true>;
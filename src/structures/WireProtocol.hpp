@@ -0,0 +1,61 @@
+// The gateway's wire protocol, fixed size binary order messages clients stream over a socket
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "OrderCommand.hpp"
+
+enum class WireKind : uint8_t{
+    LIMIT,
+    MARKET,
+    CANCEL,
+    AMEND
+};
+
+struct WireOrder{
+// One message. Fixed width, little endian, sent back to back with no framing: the stream is cut every
+// sizeof(WireOrder) bytes. Order IDs are the Book's, so clients must keep them unique across sessions.
+// The participant isn't on the wire, the gateway fills it in from the session
+    double price;        // Limit price for LIMIT and AMEND, 0 otherwise
+    uint32_t qty;        // Order quantity for LIMIT and MARKET, new quantity for AMEND. At most INT32_MAX
+    int32_t orderID;
+    uint32_t sent;       // Client's TscClock::stamp() as it wrote the message. Same machine, so comparable with the gateway's
+    uint16_t instrument;
+    WireKind kind;
+    uint8_t side;        // 0 buy, 1 sell
+};
+
+static_assert(std::is_trivially_copyable_v<WireOrder> && sizeof(WireOrder) == 24, "WireOrder is the wire layout");
+
+inline WireOrder toWire(const OrderCommand& c) noexcept {
+    // Command to its message, for clients. Quantities beyond INT32_MAX don't fit the wire and are clamped
+    WireKind k = WireKind::LIMIT;
+    if (c.command == CommandType::CANCEL) {k = WireKind::CANCEL;}
+    else if (c.command == CommandType::AMEND) {k = WireKind::AMEND;}
+    else if (c.type == OrderType::MARKET) {k = WireKind::MARKET;}
+    const int64_t q = c.qty < 0 ? 0 : c.qty > int64_t{INT32_MAX} ? int64_t{INT32_MAX} : c.qty;
+    return WireOrder{c.price, static_cast<uint32_t>(q), c.orderID, c.sent, c.instrument, k,
+                     static_cast<uint8_t>(c.side == Side::SELL)};
+}
+
+[[nodiscard]] inline bool fromWire(const WireOrder& m, const uint16_t participant, OrderCommand& c) noexcept {
+    // Message straight into a command, e.g. a claimed ring slot. Returns false, leaving c as it was, for a message
+    // no client could have meant: an unknown kind or side, a price that isn't a number, or a quantity an Order's int
+    // can't hold. Anything else is left to the pre-trade checks
+    if (static_cast<uint8_t>(m.kind) > static_cast<uint8_t>(WireKind::AMEND) || m.side > 1 || std::isnan(m.price) ||
+        m.qty > uint32_t{INT32_MAX}) {
+        return false;
+    }
+    const Side s = m.side ? Side::SELL : Side::BUY;
+    switch (m.kind) {
+    case WireKind::LIMIT:  c = OrderCommand::limit(m.orderID, s, m.qty, m.price, m.instrument, participant); break;
+    case WireKind::MARKET: c = OrderCommand::market(m.orderID, s, m.qty, m.instrument, participant); break;
+    case WireKind::CANCEL: c = OrderCommand::cancel(m.orderID, m.instrument); break;
+    case WireKind::AMEND:  c = OrderCommand::amend(m.orderID, m.qty, m.price, m.instrument); break;
+    }
+    c.sent = m.sent;
+    return true;
+}
@@ -0,0 +1,86 @@
+// The WorkStealingPool class, runs a batch of independent tasks across worker threads that steal from each other when idle
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "Ring.hpp"
+
+class WorkStealingPool{
+// Each worker has its own queue of task indices, dealt round robin up front in the order given, so passing the longest
+// tasks first spreads them evenly from the start. A worker takes from the front of its own queue and, once that's
+// empty, from the front of the next non-empty one along, so a worker that drew short tasks picks up what's left of
+// the long ones and no worker sits idle while another still has a queue.
+// Tasks are expected to be coarse (a whole replay, milliseconds or more), so each queue is a deque behind its own
+// mutex: locking costs nothing next to a task, and there's no contention until workers start stealing
+    struct alignas(cacheLine) Worker{
+        std::mutex lock;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint64_t> stolen = 0;
+
+    std::optional<std::size_t> take(const std::size_t self) {
+        // Next task for worker self, its own first, then the other queues in turn
+        for (std::size_t k = 0; k < workers.size(); ++k) {
+            Worker& w = *workers[(self + k) % workers.size()];
+            const std::scoped_lock guard(w.lock);
+            if (w.tasks.empty()) {continue;}
+            const std::size_t task = w.tasks.front();
+            w.tasks.pop_front();
+            if (k != 0) {stolen.fetch_add(1, std::memory_order_relaxed);}
+            return task;
+        }
+        return std::nullopt;
+    }
+
+public:
+    // threads workers, or one per hardware thread when 0
+    explicit WorkStealingPool(std::size_t threads = 0) {
+        if (threads == 0) {threads = std::max(1U, std::thread::hardware_concurrency());}
+        for (std::size_t i = 0; i < threads; ++i) {workers.push_back(std::make_unique<Worker>());}
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {return workers.size();}
+
+    // Tasks that ran on another worker than the one they were dealt to, in the last run
+    [[nodiscard]] uint64_t steals() const noexcept {return stolen.load(std::memory_order_relaxed);}
+
+    template<typename F>
+    void run(const std::size_t tasks, F&& f) {
+        // Calls f(task, worker) once for every task in [0, tasks) and returns when they've all finished.
+        // If tasks throw, the rest still run and the first exception is rethrown here
+        for (std::size_t t = 0; t < tasks; ++t) {workers[t % workers.size()]->tasks.push_back(t);}
+        stolen.store(0, std::memory_order_relaxed);
+
+        std::mutex failedLock;
+        std::exception_ptr failed;
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(workers.size());
+            for (std::size_t w = 0; w < workers.size(); ++w) {
+                threads.emplace_back([&, w] {
+                    while (const std::optional<std::size_t> task = take(w)) {
+                        try {
+                            f(*task, w);
+                        } catch (...) {
+                            const std::scoped_lock guard(failedLock);
+                            if (!failed) {failed = std::current_exception();}
+                        }
+                    }
+                });
+            }
+        }
+        if (failed) {std::rethrow_exception(failed);}
+    }
+};
@@ -6,6 +6,7 @@
 #define TESTHELPERS_H
 
 #include <optional>
+#include <span>
 
 // Provides access to private fields and functions of the Order class
 // Used to check for internal state changes during unit testing
@@ -14,15 +15,17 @@ public:
     //Getters
     static int& orderID(Order& o) {return o.orderID;}
     static int& tgtQuantity(Order& o) {return o.tgtQuantity;}
-    static double& tgtPrice(Order& o) {return o.tgtPrice;}
+    static double tgtPrice(const Order& o) {return o.getPrice();}
+    static Ticks& ticks(Order& o) {return o.tgtPrice;}
     static int& execQuantity(Order& o) {return o.execQuantity;}
     static int& unexecQuantity(Order& o) {return o.unexecQuantity;}
-    static double& execPrice(Order& o) {return o.execPrice;}
-    static long long timestamp(const Order& o) {return o.timestamp;}
+    static double execPrice(const Order& o) {return o.getExecPrice();}
+    static int64_t& notional(Order& o) {return o.notional;}
+    static uint64_t timestamp(const Order& o) {return o.timestamp;}
     static double tickSize(){return Order::tickSize;}
 
     //Access private functions
-    static void exec(Order& o, const int& qty, const double prc){o.exec(qty,prc);}
+    static void exec(Order& o, const int& qty, const double prc){o.exec(qty,Order::toTicks(prc));}
 
 };
 
@@ -38,12 +41,27 @@ public:
     static std::size_t getTail(const Ring<O, N>& r) { return r.tail; }
 
     //Setters
-    static void setHead(Ring<O, N>& r, std::size_t h) { r.head = h; }
-    static void setTail(Ring<O, N>& r, std::size_t t) { r.tail = t; }
+    // Also set the other side's cached copy, as if it had just been reloaded
+    static void setHead(Ring<O, N>& r, std::size_t h) { r.head = h; r.cachedHead = h; }
+    static void setTail(Ring<O, N>& r, std::size_t t) { r.tail = t; r.cachedTail = t; }
     static void setBuffer(Ring<O, N>& r, Order& o, size_t pos) { r.buffer[pos] = o; }
 
     static bool doPush(Ring<O, N>& r,Order& o) {return r.push(o); }
     static std::optional<O> doPop(Ring<O, N>& r) { return r.pop(); }
+    static std::size_t doPushN(Ring<O, N>& r, std::span<const O> in) { return r.push_n(in); }
+    static std::size_t doPopN(Ring<O, N>& r, std::span<O> out) { return r.pop_n(out); }
+    static O* doClaim(Ring<O, N>& r) { return r.claim(); }
+    static void doCommit(Ring<O, N>& r) { r.commit(); }
+    static const O* doPeek(Ring<O, N>& r) { return r.peek(); }
+    static void doRelease(Ring<O, N>& r) { r.release(); }
+    static std::span<const O> doPeekN(Ring<O, N>& r, std::size_t max) { return r.peek_n(max); }
+    static void doReleaseN(Ring<O, N>& r, std::size_t count) { r.release_n(count); }
+
+    // Bytes between the head and tail indices
+    static std::size_t indexDistance() {
+        const Ring<O, N> r;
+        return static_cast<std::size_t>(reinterpret_cast<const char*>(&r.tail) - reinterpret_cast<const char*>(&r.head));
+    }
 };
 
 #endif //TESTHELPERS_H
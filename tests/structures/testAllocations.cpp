@@ -0,0 +1,101 @@
+// Allocation tests — hot paths that must not touch the heap once warm.
+// Built as its own binary, since counting allocations means replacing the global operator new
+
+#include "structures/Book.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Allocations made on this thread while any CountAllocations is alive
+thread_local long long counted = 0;
+thread_local int scopes = 0;
+
+class CountAllocations {
+// Counts the calling thread's heap allocations for as long as it lives. Other threads aren't counted
+    long long start;
+public:
+    CountAllocations() : start(counted) {++scopes;}
+    ~CountAllocations() {--scopes;}
+    CountAllocations(const CountAllocations&) = delete;
+    CountAllocations& operator=(const CountAllocations&) = delete;
+
+    [[nodiscard]] long long count() const noexcept {return counted - start;}
+};
+
+void* allocate(const std::size_t n, const std::size_t align){
+    if (scopes > 0) {++counted;}
+    const std::size_t size = n == 0 ? 1 : n;
+    void* p = align > alignof(std::max_align_t)
+        ? std::aligned_alloc(align, (size + align - 1) / align * align)
+        : std::malloc(size);
+    if (p == nullptr) {throw std::bad_alloc();}
+    return p;
+}
+}
+
+// Every replaceable form, so nothing slips past the count or pairs with the wrong delete
+void* operator new(std::size_t n) {return allocate(n, 0);}
+void* operator new[](std::size_t n) {return allocate(n, 0);}
+void* operator new(std::size_t n, std::align_val_t a) {return allocate(n, static_cast<std::size_t>(a));}
+void* operator new[](std::size_t n, std::align_val_t a) {return allocate(n, static_cast<std::size_t>(a));}
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    try {return allocate(n, 0);} catch (const std::bad_alloc&) {return nullptr;}
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+    try {return allocate(n, 0);} catch (const std::bad_alloc&) {return nullptr;}
+}
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    try {return allocate(n, static_cast<std::size_t>(a));} catch (const std::bad_alloc&) {return nullptr;}
+}
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    try {return allocate(n, static_cast<std::size_t>(a));} catch (const std::bad_alloc&) {return nullptr;}
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete[](void* p) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t) noexcept {std::free(p);}
+void operator delete[](void* p, std::size_t) noexcept {std::free(p);}
+void operator delete(void* p, std::align_val_t) noexcept {std::free(p);}
+void operator delete[](void* p, std::align_val_t) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {std::free(p);}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {std::free(p);}
+void operator delete(void* p, const std::nothrow_t&) noexcept {std::free(p);}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {std::free(p);}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {std::free(p);}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {std::free(p);}
+
+TEST_CASE("CountAllocations: sees allocations only while in scope", "[Allocations]"){
+    auto* before = new int(1);
+    CountAllocations scope;
+    auto* during = new int[4];
+    REQUIRE(scope.count() == 1);
+    delete before;
+    delete[] during;
+}
+
+TEST_CASE("Book: warm steady state matching doesn't allocate", "[Allocations][Book]"){
+    Book b({.maxOrders = 1'024, .maxLevels = 256});
+
+    // Mixed flow of resting, crossing, cancelled and amended orders
+    const auto run = [&b](const int round){
+        for (int i = 0; i < 200; ++i){
+            const int id = round * 1'000 + i;
+            Order bo(id,Side::BUY,OrderType::LIMIT,10,100 - i % 20);
+            Order so(id + 500,Side::SELL,OrderType::LIMIT,10,101 + i % 20);
+            b.addOrder(bo);
+            b.addOrder(so);
+            if (i % 3 == 0) {b.cancel(id);}
+            if (i % 5 == 0) {b.amend(id + 500,5,102);}
+            Order mo(id + 700,(i % 2) ? Side::BUY : Side::SELL,OrderType::MARKET,15);
+            b.addOrder(mo);
+        }
+    };
+
+    run(0); // Warm up
+    CountAllocations scope;
+    run(1);
+    run(2);
+    REQUIRE(scope.count() == 0);
+}
@@ -0,0 +1,138 @@
+// Unit tests for the WorkStealingPool and the backtest runner, every task run once, stealing and merged replay stats
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include "structures/Backtest.hpp"
+#include "structures/OrderFlow.hpp"
+#include "structures/WorkStealingPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string tempPath(const std::string& name){
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void writeDay(const std::string& path, const int orders, const unsigned seed){
+    //Limits around 100 with some markets, cancels and amends, enough to cross and rest
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> kind(0, 9), qty(1, 200), offset(-20, 20);
+    FlowWriter w(path);
+    for (int id = 1; id <= orders; ++id) {
+        const Side s = id % 2 ? Side::BUY : Side::SELL;
+        const int k = kind(rng);
+        if (k < 6) {w.write(OrderCommand::limit(id, s, qty(rng), 100 + 0.05 * offset(rng)));}
+        else if (k < 7) {w.write(OrderCommand::market(id, s, qty(rng)));}
+        else if (k < 9) {w.write(OrderCommand::cancel(id - 1 - kind(rng)));}
+        else {w.write(OrderCommand::amend(id - 1 - kind(rng), qty(rng), 100 + 0.05 * offset(rng)));}
+    }
+}
+
+}
+
+//Happy path test - Every task runs exactly once, whatever the worker count
+TEST_CASE("WorkStealingPool: Runs every task once","[Backtest]"){
+    for (const std::size_t threads : {1, 3, 8}) {
+        WorkStealingPool pool(threads);
+        REQUIRE(pool.size() == threads);
+        std::vector<std::atomic<int>> runs(1'000);
+        pool.run(runs.size(), [&](const std::size_t task, const std::size_t worker) {
+            REQUIRE(worker < threads);
+            runs[task].fetch_add(1);
+        });
+        for (const auto& r : runs) {REQUIRE(r.load() == 1);}
+    }
+
+    WorkStealingPool empty(2);
+    empty.run(0, [](std::size_t, std::size_t) {FAIL("No tasks to run");});
+}
+
+//Happy path test - A worker stuck on a long task has its queued ones taken by the idle worker
+TEST_CASE("WorkStealingPool: Idle workers steal queued tasks","[Backtest]"){
+    //Dealt round robin, worker 0 gets 0,2,4,6. Task 0 holds its worker until every other task has finished,
+    //which only happens if the other worker takes what's queued behind it
+    WorkStealingPool pool(2);
+    std::atomic<int> others = 0;
+    bool finished = false;
+    pool.run(8, [&](const std::size_t task, std::size_t) {
+        if (task != 0) {others++; return;}
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (others.load() < 7 && std::chrono::steady_clock::now() < deadline) {std::this_thread::yield();}
+        finished = others.load() == 7;
+    });
+
+    REQUIRE(finished);
+    REQUIRE(pool.steals() >= 1);
+}
+
+//Edge case - A task that throws doesn't stop the others, and its exception reaches the caller
+TEST_CASE("WorkStealingPool: Rethrows a failed task's exception","[Backtest]"){
+    WorkStealingPool pool(3);
+    std::atomic<int> ran = 0;
+    REQUIRE_THROWS_AS(pool.run(30, [&](const std::size_t task, std::size_t) {
+        ran++;
+        if (task == 7) {throw std::runtime_error("task 7");}
+    }), std::runtime_error);
+    REQUIRE(ran.load() == 30);
+}
+
+//Happy path test - Each book's stats match replaying its file alone, and the total is their sum
+TEST_CASE("runBacktest: Matches replaying each day alone","[Backtest]"){
+    std::vector<BacktestInput> inputs;
+    for (int i = 0; i < 6; ++i) {
+        inputs.push_back({tempPath("testBacktest" + std::to_string(i) + ".bin"), {}});
+        writeDay(inputs.back().path, 500 + 1'500 * i, static_cast<unsigned>(i));
+    }
+
+    const BacktestResult r = runBacktest(inputs, 3);
+    REQUIRE(r.threads == 3);
+    REQUIRE(r.books.size() == inputs.size());
+
+    uint64_t commands = 0;
+    uint64_t fills = 0;
+    int64_t volume = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        BookStats alone;
+        replayInto(inputs[i], alone);
+        const BookStats& b = *r.books[i];
+        REQUIRE(b.commands == static_cast<uint64_t>(500 + 1'500 * i));
+        REQUIRE(b.commands == alone.commands);
+        REQUIRE(b.unapplied == alone.unapplied);
+        REQUIRE(b.fills == alone.fills);
+        REQUIRE(b.volume == alone.volume);
+        REQUIRE(b.notional == alone.notional);
+        REQUIRE(b.resting == alone.resting);
+        REQUIRE(b.apply.count() == b.commands);
+        REQUIRE(b.fills > 0);
+        commands += b.commands;
+        fills += b.fills;
+        volume += b.volume;
+    }
+
+    REQUIRE(r.total->commands == commands);
+    REQUIRE(r.total->fills == fills);
+    REQUIRE(r.total->volume == volume);
+    REQUIRE(r.total->apply.count() == commands);
+
+    for (const auto& in : inputs) {std::filesystem::remove(in.path);}
+}
+
+//Edge case - A missing file fails the run, after the others have replayed
+TEST_CASE("runBacktest: Rethrows when a file can't be read","[Backtest]"){
+    const std::vector<BacktestInput> inputs{{tempPath("testBacktestGood.bin"), {}},
+                                            {tempPath("testBacktestMissing.bin"), {}}};
+    writeDay(inputs[0].path, 100, 1);
+    std::filesystem::remove(inputs[1].path);
+
+    REQUIRE_THROWS_AS(runBacktest(inputs, 2), std::runtime_error);
+    std::filesystem::remove(inputs[0].path);
+}
@@ -4,50 +4,77 @@
 
 #include "structures/Book.hpp" 
 #include "structures/Order.hpp"
+#include "structures/Snapshot.hpp"
 
-//These tests only aim to test the methods and attributes of the Book class function correctly. They do not aim to catch underlying malfunctions in sub-classes such as the Order class. Those should be captured elsewhere.
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
 
-//Testing class, to override Book internals
-class TestBook: public Book{
-public:
-    bool isMarketMatchCalled = false;
+//These tests only aim to test the methods and attributes of the Book class function correctly. They do not aim to catch underlying malfunctions in sub-classes such as the Order class. Those should be captured elsewhere.
 
-    void marketMatch(Order& o) override{
-        isMarketMatchCalled = true;
+//Event sink that records what the Book reports, in place of overriding Book and Order internals
+struct RecordingSink{
+    struct Fill{
+        int takerID; int makerID; long qty; double price;
+        bool operator==(const Fill&) const = default;
+    };
+
+    std::vector<Fill> fills;
+    std::vector<int> rested;
+    std::vector<double> restPrices;
+    std::vector<int> completed;
+    std::vector<int> rejected;
+
+    template<typename O>
+    void onFill(const O& taker, const O& maker, typename O::Qty qty, typename O::Price price){
+        fills.push_back({taker.getID(),maker.getID(),static_cast<long>(qty),static_cast<double>(price)});
     }
-};
-
-//Testing class, to override Order internals
-class TestOrder: public Order{
-public:
-    mutable bool isNotified = false;
-    mutable bool isExecd = false;
-    mutable int qtyPassed = -1;
-    mutable double pPassed = -1;
-
-    TestOrder(int id, Side s, OrderType type,
-        int tgtQ, double tgtP = 0)
-    : Order(id,s,type,tgtQ,tgtP){}
-
-    void notify() const override{
-        isNotified = true;
+    template<typename O>
+    void onRest(const O& o, typename O::Price price){
+        rested.push_back(o.getID());
+        restPrices.push_back(static_cast<double>(price));
     }
+    template<typename O>
+    void onComplete(const O& o){completed.push_back(o.getID());}
+    template<typename O>
+    void onReject(const O& o, typename O::Price){rejected.push_back(o.getID());}
+};
 
-    void exec(int qty, double p) override{
-        isExecd = true;
-        qtyPassed = qty;
-        pPassed = p;
-    }
+//Testing policy, a different tick size and quantity type with the recording sink
+struct TestPolicy{
+    using Price = double;
+    using Qty = long;
+    static constexpr double tickSize = 0.01;
+    using Sink = RecordingSink;
+    using Clock = ManualClock;
 };
+using TestBook = BasicBook<TestPolicy>;
+using TestOrder = BasicOrder<TestPolicy>;
 
 // Helper class to provide access to the internals of Book, retaining encapsulation
 struct BookTestHelper{
     //Getters
-    static std::map<double,std::deque<Order>,std::less<>>&  limitSell(Book& b){return b.limitSell;}
-    static std::map<double,std::deque<Order>,std::greater<>>& limitBuy(Book& b){return b.limitBuy;}
+    //Returns the orders resting at a price, in time priority
+    static std::vector<Order> limitSell(Book& b, double p){return level(b, b.limitSell, p);}
+    static std::vector<Order> limitBuy(Book& b, double p){return level(b, b.limitBuy, p);}
 
     //Access private methods
     static void marketMatch(Book& b, Order& o){return b.marketMatch(o);}
+
+private:
+    static std::vector<Order> level(Book& b, Book::Ladder& ladder, double p){
+        std::vector<Order> orders;
+        const PriceLevel* lvl = ladder.find(b.toTick(p));
+        if (lvl == nullptr){return orders;}
+        for (uint32_t n = lvl->head; n != PriceLevel::nil; n = b.nodes[n].next){
+            orders.push_back(b.nodes[n].order);
+        }
+        return orders;
+    }
 };
 
 
@@ -59,7 +86,9 @@ TEST_CASE("addOrder: Limit Order added","[Book]"){
 
     b.addOrder(o1);
 
-    REQUIRE(b.isMarketMatchCalled);
+    //Nothing to cross, so it rests
+    REQUIRE(b.sink().fills.empty());
+    REQUIRE(b.sink().rested == std::vector<int>{1});
     
 }
 
@@ -70,11 +99,34 @@ TEST_CASE("addOrder: Market Order Added","[Book]"){
     TestOrder o(1,Side::BUY,OrderType::MARKET,100,5.5);
     b.addOrder(o);
 
-    REQUIRE(b.isMarketMatchCalled);
-    REQUIRE(o.isNotified);
+    REQUIRE(b.sink().rested.empty());
+    REQUIRE(b.sink().completed == std::vector<int>{1});
 
 }
 
+//Happy path test - Fills are reported to the sink with the maker's price
+TEST_CASE("addOrder: Sink receives fills and completions","[Book]"){
+    TestBook b;
+
+    TestOrder so1(1,Side::SELL,OrderType::LIMIT,100,5.01);
+    TestOrder so2(2,Side::SELL,OrderType::LIMIT,100,5.02);
+    b.addOrder(so1);
+    b.addOrder(so2);
+
+    TestOrder bo1(3,Side::BUY,OrderType::LIMIT,150,5.05);
+    b.addOrder(bo1);
+
+    const auto& fills = b.sink().fills;
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].makerID == 1);
+    REQUIRE(fills[0].qty == 100);
+    REQUIRE(fills[0].price == Catch::Approx(5.01));
+    REQUIRE(fills[1].makerID == 2);
+    REQUIRE(fills[1].qty == 50);
+    REQUIRE(fills[1].price == Catch::Approx(5.02));
+    REQUIRE(b.sink().completed == std::vector<int>{1,3});
+}
+
 
 
 
@@ -92,7 +144,7 @@ TEST_CASE("marketMatch: Standard full market match","[Book]"){
     Order buyOrder(2,Side::BUY,OrderType::MARKET,100);
     b.addOrder(buyOrder);
 
-    REQUIRE(BookTestHelper::limitSell(b)[5.0].empty());
+    REQUIRE(BookTestHelper::limitSell(b,5.0).empty());
 }
 
 //Happy path test - Market order isn't fully executed (no liquidity)
@@ -107,8 +159,8 @@ TEST_CASE("marketMatch: Partial market match","[Book]"){
     Order buyOrder(2,Side::BUY,OrderType::MARKET,75);
     b.addOrder(buyOrder);
 
-    REQUIRE(BookTestHelper::limitSell(b)[5.0].front().getUnexecQty() == 25);
-    REQUIRE(BookTestHelper::limitSell(b)[5.0].front().getPrice() == Catch::Approx(5.0));
+    REQUIRE(BookTestHelper::limitSell(b,5.0).front().getUnexecQty() == 25);
+    REQUIRE(BookTestHelper::limitSell(b,5.0).front().getPrice() == Catch::Approx(5.0));
 
     
 }
@@ -130,7 +182,7 @@ TEST_CASE("marketMatch: Price priority","[Book]"){
     b.addOrder(bo1);
 
     //so2 should get executed fully
-    REQUIRE(BookTestHelper::limitBuy(b)[10].empty());
+    REQUIRE(BookTestHelper::limitBuy(b,10).empty());
 
 }
 
@@ -148,7 +200,579 @@ TEST_CASE("marketMatch: Time priority","[Book]"){
     Order so1(3,Side::SELL,OrderType::MARKET,50);
     b.addOrder(so1);
 
-    REQUIRE(BookTestHelper::limitBuy(b)[5].front().getID() == 2);
+    REQUIRE(BookTestHelper::limitBuy(b,5).front().getID() == 2);
+
+}
+
+
+//Happy path test - Limit order sweeps several levels, then rests its remainder
+TEST_CASE("marketMatch: Limit order crosses multiple levels","[Book]"){
+    Book b;
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,10,5.0);
+    Order so2(2,Side::SELL,OrderType::LIMIT,10,5.5);
+    Order so3(3,Side::SELL,OrderType::LIMIT,10,6.0);
+    b.addOrder(so1);
+    b.addOrder(so2);
+    b.addOrder(so3);
+
+    //Crosses 5.0 and 5.5, but not 6.0
+    Order bo1(4,Side::BUY,OrderType::LIMIT,25,5.5);
+    b.addOrder(bo1);
+
+    REQUIRE(BookTestHelper::limitSell(b,5.0).empty());
+    REQUIRE(BookTestHelper::limitSell(b,5.5).empty());
+    REQUIRE(BookTestHelper::limitSell(b,6.0).front().getUnexecQty() == 10);
+    REQUIRE(BookTestHelper::limitBuy(b,5.5).front().getUnexecQty() == 5);
+}
+
+//Happy path test - An order that clears many levels fills every maker in price then time order, and stops where it runs out
+TEST_CASE("marketMatch: Sweeps through many levels","[Book]"){
+    TestBook b({.maxOrders = 1'024});
+
+    //20 levels of three orders each, 1 + 2 + 3 lots, from 5.00 up
+    int id = 0;
+    std::vector<RecordingSink::Fill> expected;
+    for (int level = 0; level < 20; ++level) {
+        for (int k = 1; k <= 3; ++k) {
+            TestOrder so(id,Side::SELL,OrderType::LIMIT,k,5.0 + 0.01 * level);
+            b.addOrder(so);
+            expected.push_back({1'000,id++,k,5.0 + 0.01 * level});
+        }
+    }
+
+    //A market buy clears 13 levels (78 lots), then takes 1 of the 14th level's first order and 1 of its second
+    TestOrder bo(1'000,Side::BUY,OrderType::MARKET,80);
+    b.addOrder(bo);
+    expected.resize(41);
+    expected.back().qty = 1;
+
+    const auto& fills = b.sink().fills;
+    REQUIRE(fills.size() == expected.size());
+    for (std::size_t i = 0; i < fills.size(); ++i) {
+        REQUIRE(fills[i].makerID == expected[i].makerID);
+        REQUIRE(fills[i].qty == expected[i].qty);
+        REQUIRE(fills[i].price == Catch::Approx(expected[i].price));
+    }
+    REQUIRE(b.sink().completed.size() == 41); //40 makers and the taker
+    REQUIRE(b.sink().completed.back() == 1'000);
+    REQUIRE(bo.getUnexecQty() == 0);
+    REQUIRE(b.lastPrice() == Catch::Approx(5.13));
+    REQUIRE(b.size() == 20);
+
+    std::array<TestBook::DepthLevel,2> top{};
+    REQUIRE(b.depth(Side::SELL,top) == 2);
+    REQUIRE(top[0].price == Catch::Approx(5.13));
+    REQUIRE(top[0].quantity == 4);
+    REQUIRE(top[0].orders == 2);
+    REQUIRE(top[1].quantity == 6);
+
+    //A limit buy sweeps up to its price and rests what's left
+    TestOrder lo(1'001,Side::BUY,OrderType::LIMIT,100,5.15);
+    b.addOrder(lo);
+    REQUIRE(lo.getUnexecQty() == 84);
+    REQUIRE(b.lastPrice() == Catch::Approx(5.15));
+    REQUIRE(b.depth(Side::BUY,top) == 1);
+    REQUIRE(top[0].price == Catch::Approx(5.15));
+    REQUIRE(top[0].quantity == 84);
+
+    //A market order bigger than the whole side takes everything and the rest is reported
+    TestOrder so(1'002,Side::SELL,OrderType::MARKET,1'000);
+    b.addOrder(so);
+    REQUIRE(so.getUnexecQty() == 916);
+    REQUIRE(b.depth(Side::BUY,top) == 0);
+}
+
+//Edge case - Prices far outside the starting window move the ladder
+TEST_CASE("addOrder: Prices outside the initial window","[Book]"){
+    Book b({.initialTicks = 64});
+
+    Order bo1(1,Side::BUY,OrderType::LIMIT,10,1.0);
+    Order bo2(2,Side::BUY,OrderType::LIMIT,10,50'000.0);
+    Order bo3(3,Side::BUY,OrderType::LIMIT,10,0.05);
+    b.addOrder(bo1);
+    b.addOrder(bo2);
+    b.addOrder(bo3);
+
+    REQUIRE(BookTestHelper::limitBuy(b,1.0).front().getID() == 1);
+    REQUIRE(BookTestHelper::limitBuy(b,50'000.0).front().getID() == 2);
+    REQUIRE(BookTestHelper::limitBuy(b,0.05).front().getID() == 3);
+
+    //Best bid is still found after the window moved
+    Order so1(4,Side::SELL,OrderType::MARKET,10);
+    b.addOrder(so1);
+    REQUIRE(BookTestHelper::limitBuy(b,50'000.0).empty());
+    REQUIRE(!BookTestHelper::limitBuy(b,1.0).empty());
+}
+
+//Happy path test - Cancel from the middle of a queue
+TEST_CASE("cancel: Removes a resting order and keeps the rest of the queue","[Book]"){
+    Book b;
+
+    Order bo1(1,Side::BUY,OrderType::LIMIT,10,5);
+    Order bo2(2,Side::BUY,OrderType::LIMIT,20,5);
+    Order bo3(3,Side::BUY,OrderType::LIMIT,30,5);
+    b.addOrder(bo1);
+    b.addOrder(bo2);
+    b.addOrder(bo3);
+
+    REQUIRE(b.cancel(2));
+    REQUIRE(!b.cancel(2)); // Already gone
+
+    auto level = BookTestHelper::limitBuy(b,5);
+    REQUIRE(level.size() == 2);
+    REQUIRE(level[0].getID() == 1);
+    REQUIRE(level[1].getID() == 3);
+
+    //Cancelling the rest empties the level
+    REQUIRE(b.cancel(1));
+    REQUIRE(b.cancel(3));
+    REQUIRE(BookTestHelper::limitBuy(b,5).empty());
+
+    //Nothing left to match against
+    Order so1(4,Side::SELL,OrderType::MARKET,10);
+    b.addOrder(so1);
+    REQUIRE(so1.getUnexecQty() == 10);
+}
+
+//Edge case - Filled orders can't be cancelled
+TEST_CASE("cancel: Unknown or filled order","[Book]"){
+    Book b;
+
+    REQUIRE(!b.cancel(1));
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,10,5);
+    b.addOrder(so1);
+    Order bo1(2,Side::BUY,OrderType::MARKET,10);
+    b.addOrder(bo1);
+
+    REQUIRE(!b.cancel(1));
+}
+
+//Happy path test - Reducing quantity keeps time priority
+TEST_CASE("amend: Quantity reduce keeps priority","[Book]"){
+    Book b;
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,50,5);
+    Order so2(2,Side::SELL,OrderType::LIMIT,50,5);
+    b.addOrder(so1);
+    b.addOrder(so2);
+
+    REQUIRE(b.amend(1,20,5));
+
+    auto level = BookTestHelper::limitSell(b,5);
+    REQUIRE(level[0].getID() == 1);
+    REQUIRE(level[0].getUnexecQty() == 20);
+}
+
+//Happy path test - Increasing quantity loses time priority
+TEST_CASE("amend: Quantity increase moves to the back","[Book]"){
+    Book b;
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,50,5);
+    Order so2(2,Side::SELL,OrderType::LIMIT,50,5);
+    b.addOrder(so1);
+    b.addOrder(so2);
+
+    REQUIRE(b.amend(1,60,5));
 
+    auto level = BookTestHelper::limitSell(b,5);
+    REQUIRE(level[0].getID() == 2);
+    REQUIRE(level[1].getID() == 1);
+    REQUIRE(level[1].getUnexecQty() == 60);
 }
 
+//Happy path test - Price change moves the order to the back of the new level
+TEST_CASE("amend: Price change moves to the back of the new level","[Book]"){
+    Book b;
+
+    Order bo1(1,Side::BUY,OrderType::LIMIT,50,5);
+    Order bo2(2,Side::BUY,OrderType::LIMIT,50,6);
+    b.addOrder(bo1);
+    b.addOrder(bo2);
+
+    REQUIRE(b.amend(1,40,6));
+
+    REQUIRE(BookTestHelper::limitBuy(b,5).empty());
+    auto level = BookTestHelper::limitBuy(b,6);
+    REQUIRE(level.size() == 2);
+    REQUIRE(level[0].getID() == 2);
+    REQUIRE(level[1].getID() == 1);
+    REQUIRE(level[1].getUnexecQty() == 40);
+}
+
+//Happy path test - Amending through the opposite side crosses the book
+TEST_CASE("amend: Price change that crosses the book","[Book]"){
+    Book b;
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,30,6);
+    Order bo1(2,Side::BUY,OrderType::LIMIT,50,5);
+    b.addOrder(so1);
+    b.addOrder(bo1);
+
+    REQUIRE(b.amend(2,50,6));
+
+    REQUIRE(BookTestHelper::limitSell(b,6).empty());
+    REQUIRE(BookTestHelper::limitBuy(b,5).empty());
+    REQUIRE(BookTestHelper::limitBuy(b,6).front().getUnexecQty() == 20);
+}
+
+//Error case - Amending to zero quantity
+TEST_CASE("amend: Zero quantity throws exception","[Book]"){
+    Book b;
+
+    Order bo1(1,Side::BUY,OrderType::LIMIT,50,5);
+    b.addOrder(bo1);
+
+    REQUIRE_THROWS_AS(b.amend(1,0,5),std::logic_error);
+    REQUIRE(!b.amend(7,10,5));
+}
+
+//Edge case - Order pool exhausted
+TEST_CASE("addOrder: Full book rejects the remainder instead of allocating","[Book]"){
+    Book b({.maxOrders = 2, .maxLevels = 8});
+
+    Order bo1(1,Side::BUY,OrderType::LIMIT,10,5);
+    Order bo2(2,Side::BUY,OrderType::LIMIT,10,4);
+    Order bo3(3,Side::BUY,OrderType::LIMIT,10,3);
+    REQUIRE(b.addOrder(bo1));
+    REQUIRE(b.addOrder(bo2));
+    REQUIRE(!b.addOrder(bo3));
+    REQUIRE(b.size() == 2);
+    REQUIRE(BookTestHelper::limitBuy(b,3).empty());
+
+    //Freeing a node makes room again
+    REQUIRE(b.cancel(1));
+    REQUIRE(b.addOrder(bo3));
+
+    //Crossing orders still match when the book is full
+    Order so1(4,Side::SELL,OrderType::LIMIT,5,4);
+    REQUIRE(b.addOrder(so1));
+    REQUIRE(so1.getUnexecQty() == 0);
+}
+
+//Edge case - Level pool exhausted
+TEST_CASE("addOrder: Level pool exhausted","[Book]"){
+    Book b({.maxOrders = 8, .maxLevels = 1});
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,10,5);
+    Order so2(2,Side::SELL,OrderType::LIMIT,10,5);
+    Order so3(3,Side::SELL,OrderType::LIMIT,10,6);
+    REQUIRE(b.addOrder(so1));
+    REQUIRE(b.addOrder(so2)); // Same level
+    REQUIRE(!b.addOrder(so3));
+    REQUIRE(so3.getUnexecQty() == 10);
+}
+
+//Edge case - Price far outside the book
+TEST_CASE("addOrder: Limit beyond maxTicks is rejected like a full book","[Book]"){
+    Book b({.maxTicks = 65'536});
+
+    Order so1(1,Side::SELL,OrderType::LIMIT,10,100);
+    REQUIRE(b.addOrder(so1));
+
+    Order so2(2,Side::SELL,OrderType::LIMIT,10,1e8);
+    Order so3(3,Side::SELL,OrderType::LIMIT,10,1e20);
+    REQUIRE(!b.addOrder(so2));
+    REQUIRE(!b.addOrder(so3));
+    REQUIRE(b.size() == 1);
+
+    //The book still trades at its real prices
+    Order bo1(4,Side::BUY,OrderType::LIMIT,10,100);
+    REQUIRE(b.addOrder(bo1));
+    REQUIRE(bo1.getUnexecQty() == 0);
+}
+
+//Happy path test - Commands off the ring dispatch to addOrder, amend and cancel
+TEST_CASE("apply: New, amend and cancel commands","[Book]"){
+    TestBook b;
+
+    REQUIRE(b.apply(OrderCommand::limit(1,Side::SELL,30,5)));
+    REQUIRE(b.apply(OrderCommand::limit(2,Side::SELL,30,6)));
+    REQUIRE(b.sink().rested == std::vector<int>{1,2});
+
+    REQUIRE(b.apply(OrderCommand::amend(2,10,6)));
+    REQUIRE(b.apply(OrderCommand::cancel(1)));
+    REQUIRE(!b.apply(OrderCommand::cancel(1)));
+    REQUIRE(b.size() == 1);
+
+    REQUIRE(b.apply(OrderCommand::market(3,Side::BUY,15)));
+    REQUIRE(b.sink().fills.size() == 1);
+    REQUIRE(b.sink().fills[0].makerID == 2);
+    REQUIRE(b.sink().fills[0].qty == 10);
+    REQUIRE(b.size() == 0);
+}
+
+//Happy path test - Batches give exactly what the same commands and orders give one at a time
+TEST_CASE("apply/addOrders: Batches match one at a time","[Book]"){
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pick(0,9);
+    std::uniform_int_distribution<int> level(0,20);
+    std::uniform_int_distribution<int> size(1,50);
+    std::vector<OrderCommand> cmds;
+    for (int id = 0; id < 3'000; ++id) {
+        const Side side = id % 2 ? Side::SELL : Side::BUY;
+        const double price = 5 + (side == Side::SELL ? 0.01 : -0.01) * (level(gen) - 3);
+        const int k = pick(gen);
+        if (k < 6) {cmds.push_back(OrderCommand::limit(id,side,size(gen),price));}
+        else if (k < 7) {cmds.push_back(OrderCommand::market(id,side,size(gen)));}
+        else if (k < 9) {cmds.push_back(OrderCommand::cancel(id / 2));}
+        else {cmds.push_back(OrderCommand::amend(id / 2,size(gen),price));}
+    }
+
+    TestBook one({.maxOrders = 512});
+    TestBook batched({.maxOrders = 512});
+    std::size_t applied = 0;
+    for (const OrderCommand& c : cmds) {applied += one.apply(c);}
+
+    //Uneven batches, so they end in different places relative to the prefetch distances
+    std::size_t batchApplied = 0;
+    std::size_t seen = 0;
+    for (std::size_t at = 0; at < cmds.size(); at += 37) {
+        const auto batch = std::span<const OrderCommand>(cmds).subspan(at, std::min<std::size_t>(37, cmds.size() - at));
+        batchApplied += batched.apply(batch, [&](const OrderCommand& c, bool){REQUIRE(c.orderID == cmds[seen++].orderID);});
+    }
+    REQUIRE(seen == cmds.size());
+    REQUIRE(!one.sink().fills.empty());
+    REQUIRE(!one.sink().rejected.empty());
+    REQUIRE(batchApplied == applied);
+    REQUIRE(batched.sink().fills == one.sink().fills);
+    REQUIRE(batched.sink().rested == one.sink().rested);
+    REQUIRE(batched.sink().completed == one.sink().completed);
+    REQUIRE(batched.sink().rejected == one.sink().rejected);
+    REQUIRE(batched.size() == one.size());
+    REQUIRE(batched.lastSeq() == one.lastSeq());
+
+    //Orders, stamped and matched in place
+    std::vector<TestOrder> orders;
+    for (int id = 0; id < 500; ++id) {
+        const Side side = id % 2 ? Side::SELL : Side::BUY;
+        const double price = 5 + (side == Side::SELL ? 0.01 : -0.01) * (level(gen) - 3);
+        orders.emplace_back(id,side,pick(gen) ? OrderType::LIMIT : OrderType::MARKET,size(gen),price);
+    }
+    std::vector<TestOrder> copies = orders;
+    TestBook single;
+    TestBook many;
+    std::size_t added = 0;
+    for (TestOrder& o : copies) {added += single.addOrder(o);}
+    REQUIRE(many.addOrders(orders) == added);
+    REQUIRE(many.sink().fills == single.sink().fills);
+    REQUIRE(many.sink().rested == single.sink().rested);
+    for (std::size_t i = 0; i < orders.size(); ++i) {
+        REQUIRE(orders[i].getUnexecQty() == copies[i].getUnexecQty());
+        REQUIRE(orders[i].getSeq() == copies[i].getSeq());
+    }
+}
+
+//Happy path test - Level totals follow rests, fills, cancels and amends
+TEST_CASE("depth: Top levels with running totals","[Book]"){
+    Book b;
+    using Level = Book::DepthLevel;
+
+    for (int i = 0; i < 3; ++i) {
+        Order so(i,Side::SELL,OrderType::LIMIT,10,5 + i * 0.05);
+        Order bo(10 + i,Side::BUY,OrderType::LIMIT,20,4.9 - i * 0.05);
+        b.addOrder(so);
+        b.addOrder(bo);
+    }
+    Order so3(3,Side::SELL,OrderType::LIMIT,7,5);
+    b.addOrder(so3);
+
+    std::array<Level,2> asks{};
+    REQUIRE(b.depth(Side::SELL,asks) == 2);
+    REQUIRE(asks[0].price == Catch::Approx(5));
+    REQUIRE(asks[0].quantity == 17);
+    REQUIRE(asks[0].orders == 2);
+    REQUIRE(asks[1].price == Catch::Approx(5.05));
+    REQUIRE(asks[1].quantity == 10);
+
+    std::array<Level,5> bids{};
+    REQUIRE(b.depth(Side::BUY,bids) == 3);
+    REQUIRE(bids[0].price == Catch::Approx(4.9));
+    REQUIRE(bids[2].price == Catch::Approx(4.8));
+    REQUIRE(bids[2].quantity == 20);
+
+    //Partial fill of the level, the first order fills and the second is left with 3
+    Order mo(20,Side::BUY,OrderType::MARKET,14);
+    b.addOrder(mo);
+    REQUIRE(b.depth(Side::SELL,asks) == 2);
+    REQUIRE(asks[0].quantity == 3);
+    REQUIRE(asks[0].orders == 1);
+
+    //In place reduce, then cancel
+    REQUIRE(b.amend(11,5,4.85));
+    REQUIRE(b.cancel(10));
+    REQUIRE(b.depth(Side::BUY,bids) == 2);
+    REQUIRE(bids[0].price == Catch::Approx(4.85));
+    REQUIRE(bids[0].quantity == 5);
+    REQUIRE(bids[0].orders == 1);
+
+    //Empty book and empty buffer
+    Book empty;
+    REQUIRE(empty.depth(Side::BUY,bids) == 0);
+    REQUIRE(b.depth(Side::BUY,std::span<Level>{}) == 0);
+}
+
+//Happy path test - A book on its own tick holds ticks of it, and converts back to prices for events and getters
+TEST_CASE("addOrder: Book on another tick converts prices at the edges","[Book]"){
+    TestBook b({.tickSize = 0.25});
+
+    //Built on the Policy's 0.01 tick, moved to the nearest quarter by the book
+    TestOrder so(1,Side::SELL,OrderType::LIMIT,10,5.37);
+    b.addOrder(so);
+    b.apply(OrderCommand::limit(2,Side::SELL,10,5.4));
+    REQUIRE(b.sink().restPrices == std::vector<double>{5.25,5.5});
+
+    std::array<TestBook::DepthLevel,2> asks{};
+    REQUIRE(b.depth(Side::SELL,asks) == 2);
+    REQUIRE(asks[0].price == Catch::Approx(5.25));
+    REQUIRE(asks[1].price == Catch::Approx(5.5));
+
+    REQUIRE(b.apply(OrderCommand::market(3,Side::BUY,15)));
+    REQUIRE(b.sink().fills[0].price == Catch::Approx(5.25));
+    REQUIRE(b.sink().fills[1].price == Catch::Approx(5.5));
+    REQUIRE(b.lastPrice() == Catch::Approx(5.5));
+
+    //Amends are converted the same way, 5.6 is nearest 5.5
+    REQUIRE(b.amend(2,3,5.6));
+    REQUIRE(b.depth(Side::SELL,asks) == 1);
+    REQUIRE(asks[0].quantity == 3);
+}
+
+//Happy path test - The book stamps orders as it accepts them, constructing one reads no clock
+TEST_CASE("addOrder: Stamps sequence number and clock time on acceptance","[Book]"){
+    TestBook b({}, {}, ManualClock(1'000));
+    TestOrder so1(1,Side::SELL,OrderType::LIMIT,30,5.01);
+    REQUIRE(so1.getSeq() == 0);
+    REQUIRE(so1.getTimestamp() == 0);
+
+    b.addOrder(so1);
+    REQUIRE(so1.getSeq() == 1);
+    REQUIRE(so1.getTimestamp() == 1'000);
+
+    b.clock().advance(5);
+    TestOrder bo1(2,Side::BUY,OrderType::MARKET,10);
+    b.addOrder(bo1);
+    REQUIRE(bo1.getSeq() == 2);
+    REQUIRE(bo1.getTimestamp() == 1'005);
+
+    //Commands are stamped too, and a re-entered amend counts as a new arrival
+    b.clock().set(2'000);
+    REQUIRE(b.apply(OrderCommand::limit(3,Side::SELL,10,5.02)));
+    REQUIRE(b.amend(1,30,5.01)); // Quantity up, loses priority
+    REQUIRE(b.lastSeq() == 4);
+    REQUIRE(b.amend(1,10,5.01)); // Reduce in place, keeps its stamp
+    REQUIRE(b.lastSeq() == 4);
+}
+
+//Happy path test - A snapshot reloads with the same levels, queue order and partial fills
+TEST_CASE("snapshot/load: Round trip keeps priority and executed quantity","[Book]"){
+    const std::string path = (std::filesystem::temp_directory_path() / "testBookSnapshot.bin").string();
+
+    TestBook b;
+    TestOrder so1(1,Side::SELL,OrderType::LIMIT,30,5.01);
+    TestOrder so2(2,Side::SELL,OrderType::LIMIT,20,5.01);
+    TestOrder so3(3,Side::SELL,OrderType::LIMIT,40,5.03);
+    TestOrder bo1(4,Side::BUY,OrderType::LIMIT,25,4.99);
+    TestOrder bo2(5,Side::BUY,OrderType::LIMIT,15,4.98);
+    for (TestOrder* o : {&so1,&so2,&so3,&bo1,&bo2}) {b.addOrder(*o);}
+    TestOrder mo(6,Side::BUY,OrderType::MARKET,10);
+    b.addOrder(mo); // Order 1 is left with 20 of 30
+    b.snapshot(path,77);
+
+    TestBook loaded;
+    REQUIRE(loaded.load(path) == 77);
+    REQUIRE(loaded.size() == 5);
+    REQUIRE(loaded.sink().rested.empty()); // No events while loading
+    REQUIRE(loaded.lastSeq() == 6);        // Carries on after the market order, which never rested
+    REQUIRE(loaded.lastPrice() == Catch::Approx(5.01));
+    REQUIRE(loaded.openOrders(0) == 5);
+
+    std::array<TestBook::DepthLevel,4> asks{};
+    REQUIRE(loaded.depth(Side::SELL,asks) == 2);
+    REQUIRE(asks[0].price == Catch::Approx(5.01));
+    REQUIRE(asks[0].quantity == 40);
+    REQUIRE(asks[0].orders == 2);
+    std::array<TestBook::DepthLevel,4> bids{};
+    REQUIRE(loaded.depth(Side::BUY,bids) == 2);
+    REQUIRE(bids[1].price == Catch::Approx(4.98));
+
+    //Time priority survives: 1 then 2 then 3
+    TestOrder sweep(7,Side::BUY,OrderType::MARKET,70);
+    loaded.addOrder(sweep);
+    const auto& fills = loaded.sink().fills;
+    REQUIRE(fills.size() == 3);
+    REQUIRE(fills[0].makerID == 1);
+    REQUIRE(fills[0].qty == 20);
+    REQUIRE(fills[1].makerID == 2);
+    REQUIRE(fills[2].makerID == 3);
+
+    //Cancel and amend find loaded orders
+    REQUIRE(loaded.cancel(4));
+    REQUIRE(loaded.amend(5,5,4.98));
+    REQUIRE(loaded.depth(Side::BUY,bids) == 1);
+    REQUIRE(bids[0].quantity == 5);
+    std::remove(path.c_str());
+}
+
+//Error case - A snapshot cut short before close leaves the last complete one in place
+TEST_CASE("snapshot: An abandoned snapshot doesn't replace the last good one","[Book]"){
+    const std::string path = (std::filesystem::temp_directory_path() / "testBookSnapshotTorn.bin").string();
+    const double tick = Book().tickSize();
+    {
+        SnapshotWriter w(path,tick,0,2,0,2,0);
+        w.sells()[0] = SnapshotOrder{5,0,0,10,0,1,1,0};
+        w.sells()[1] = SnapshotOrder{6,0,0,10,0,2,2,0};
+        w.close();
+    }
+    REQUIRE(!std::filesystem::exists(path + ".tmp"));
+
+    //Nothing reaches path until close, and the temporary file goes with the writer
+    {
+        SnapshotWriter w(path,tick,0,1,0,1,0);
+        w.sells()[0] = SnapshotOrder{7,0,0,10,0,1,3,0};
+        REQUIRE(std::filesystem::exists(path + ".tmp"));
+        REQUIRE(SnapshotFile(path).info().sellOrders == 2);
+    }
+    REQUIRE(!std::filesystem::exists(path + ".tmp"));
+
+    //A file without its magic, as a writer killed mid-snapshot leaves behind, is never loaded
+    {
+        SnapshotWriter w(path + ".torn",tick,0,1,0,1,0);
+        w.sells()[0] = SnapshotOrder{7,0,0,10,0,1,3,0};
+        std::filesystem::copy_file(path + ".torn.tmp",path + ".torn",std::filesystem::copy_options::overwrite_existing);
+    }
+    REQUIRE_THROWS_AS(SnapshotFile(path + ".torn"),std::runtime_error);
+
+    Book b;
+    REQUIRE(b.load(path) == 0);
+    REQUIRE(b.size() == 2);
+    std::remove(path.c_str());
+    std::remove((path + ".torn").c_str());
+}
+
+//Error case - Loading into a book that can't take the snapshot
+TEST_CASE("load: Rejects non-empty books, other ticks and small pools","[Book]"){
+    const std::string path = (std::filesystem::temp_directory_path() / "testBookSnapshotErrors.bin").string();
+
+    Book b;
+    for (int i = 0; i < 4; ++i) {
+        Order o(i,Side::SELL,OrderType::LIMIT,10,5 + i);
+        b.addOrder(o);
+    }
+    b.snapshot(path);
+
+    REQUIRE_THROWS_AS(b.load(path),std::runtime_error);
+    Book otherTick({.tickSize = 0.01});
+    REQUIRE_THROWS_AS(otherTick.load(path),std::runtime_error);
+    Book small({.maxOrders = 3});
+    REQUIRE_THROWS_AS(small.load(path),std::runtime_error);
+    Book fewLevels({.maxLevels = 2});
+    REQUIRE_THROWS_AS(fewLevels.load(path),std::runtime_error);
+    REQUIRE_THROWS_AS(Book().load(path + ".missing"),std::runtime_error);
+
+    Book fresh;
+    REQUIRE(fresh.load(path) == 0);
+    REQUIRE(fresh.size() == 4);
+    std::remove(path.c_str());
+}
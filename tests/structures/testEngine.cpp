@@ -0,0 +1,115 @@
+// Unit tests for the ShardedEngine class, routing, per-instrument ticks and bands, and shard threads
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include "structures/Engine.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+//Small books so many instruments stay cheap
+constexpr BookConfig smallBook{.maxOrders = 256, .maxLevels = 64, .initialTicks = 64};
+
+const std::array<InstrumentSpec,3> specs{{
+    {.id = 10, .tickSize = 0.01, .risk = {.minPrice = 90, .maxPrice = 110}, .book = smallBook},
+    {.id = 20, .tickSize = 0.25, .risk = {.maxPrice = 1'000}, .book = smallBook},
+    {.id = 30, .tickSize = 1, .risk = {.maxPrice = 1'000}, .book = smallBook},
+}};
+
+void drain(ShardedEngine<>& e, const uint64_t expected){
+    // Waits until the shards have handled expected commands
+    while (e.processed() < expected) {std::this_thread::yield();}
+}
+
+}
+
+//Happy path test - Instruments are dealt to shards round robin
+TEST_CASE("ShardedEngine: assigns instruments to shards","[Engine]"){
+    ShardedEngine<> e(specs,2);
+
+    REQUIRE(e.shards() == 2);
+    REQUIRE(e.shardOf(10) == 0);
+    REQUIRE(e.shardOf(20) == 1);
+    REQUIRE(e.shardOf(30) == 0);
+    REQUIRE(e.shardOf(40) == OrderIndex::npos);
+    REQUIRE(e.book(40) == nullptr);
+    REQUIRE(!e.route(OrderCommand::limit(1,Side::BUY,10,100,40)));
+}
+
+//Edge case - No shards to deal instruments to
+TEST_CASE("ShardedEngine: rejects zero shards","[Engine]"){
+    REQUIRE_THROWS_AS(ShardedEngine<>(specs,0),std::invalid_argument);
+}
+
+//Edge case - Two specs with the same id would leave one of their books unreachable
+TEST_CASE("ShardedEngine: rejects an instrument listed twice","[Engine]"){
+    const std::array<InstrumentSpec,3> twice{{specs[0], specs[1], {.id = 10, .tickSize = 1, .book = smallBook}}};
+    REQUIRE_THROWS_AS(ShardedEngine<>(twice,2),std::invalid_argument);
+    REQUIRE_THROWS_AS(ShardedEngine<>(twice,1),std::invalid_argument);
+}
+
+//Happy path test - Each instrument has its own book and tick
+TEST_CASE("ShardedEngine: routes orders to their instrument's book","[Engine]"){
+    ShardedEngine<> e(specs,2);
+    e.start();
+
+    REQUIRE(e.route(OrderCommand::limit(1,Side::SELL,10,100.013,10)));
+    REQUIRE(e.route(OrderCommand::limit(2,Side::SELL,10,100.13,20)));
+    REQUIRE(e.route(OrderCommand::limit(3,Side::BUY,4,100.01,10)));
+    drain(e,3);
+    e.stop();
+
+    REQUIRE(e.book(10)->tickSize() == Catch::Approx(0.01));
+    REQUIRE(e.book(20)->tickSize() == Catch::Approx(0.25));
+
+    // Order 1 rounded to 100.01 and was partly filled by order 3, order 2 rounded to 100.25 and rests alone
+    REQUIRE(e.book(10)->size() == 1);
+    REQUIRE(e.book(20)->size() == 1);
+    REQUIRE(e.book(30)->size() == 0);
+    REQUIRE(e.rejected() == 0);
+}
+
+//Edge case - Prices outside the instrument's band never reach the book
+TEST_CASE("ShardedEngine: rejects limit prices outside the band","[Engine]"){
+    ShardedEngine<> e(specs,1);
+    e.start();
+
+    REQUIRE(e.route(OrderCommand::limit(1,Side::BUY,10,89.99,10)));
+    REQUIRE(e.route(OrderCommand::limit(2,Side::SELL,10,110.01,10)));
+    REQUIRE(e.route(OrderCommand::limit(3,Side::BUY,10,95,10)));
+    REQUIRE(e.route(OrderCommand::amend(3,10,120,10)));
+    REQUIRE(e.route(OrderCommand::market(4,Side::SELL,5,10))); // Markets have no price to check
+    drain(e,5);
+    e.stop();
+
+    REQUIRE(e.rejected() == 3);
+    REQUIRE(e.book(10)->size() == 1);
+}
+
+//Happy path test - Every command gets handled with several shards running at once
+TEST_CASE("ShardedEngine: shard threads handle every routed command","[Engine][Threads]"){
+    ShardedEngine<> e(specs,3);
+    e.start();
+
+    constexpr int n = 3'000;
+    for (int i = 0; i < n; ++i) {
+        const uint32_t instr = specs[i % 3].id;
+        const OrderCommand c = OrderCommand::limit(i, i % 2 ? Side::BUY : Side::SELL, 1, 100, instr);
+        while (!e.route(c)) {std::this_thread::yield();}
+    }
+    e.stop();
+
+    REQUIRE(e.processed() == n);
+    //Alternating sides at one price cross pairwise
+    REQUIRE(e.book(10)->size() + e.book(20)->size() + e.book(30)->size() == 0);
+
+    //Every command went into its shard's latency histograms
+    for (std::size_t s = 0; s < e.shards(); ++s) {
+        REQUIRE(e.latency(s).endToEnd.count() == n / 3);
+        REQUIRE(e.latency(s).endToEnd.max() >= e.latency(s).book.max());
+    }
+}
@@ -0,0 +1,137 @@
+// Unit tests for execution reports — the events a Book publishes and how a full ring is handled
+
+#include "structures/Book.hpp"
+#include "structures/ExecReport.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+template<std::size_t N>
+std::vector<ExecEvent> drain(ExecReportStream<N>& s){
+    std::vector<ExecEvent> out;
+    while (auto e = s.pop()) {out.push_back(*e);}
+    return out;
+}
+}
+
+//A sink without a stream would dereference null on its first report
+static_assert(!std::is_default_constructible_v<ExecReportSink<64>>);
+static_assert(!std::is_default_constructible_v<ExecReportSink<64, Overflow::BACKPRESSURE>>);
+
+TEST_CASE("ExecReportSink: rest, fill and partial fill reports", "[ExecReport]"){
+    using Policy = ReportingPolicy<64>;
+    auto stream = std::make_unique<ExecReportStream<64>>();
+    BasicBook<Policy> b({}, ExecReportSink<64>(*stream));
+
+    BasicOrder<Policy> so1(1,Side::SELL,OrderType::LIMIT,100,5.0);
+    b.addOrder(so1);
+    BasicOrder<Policy> bo1(2,Side::BUY,OrderType::LIMIT,40,5.0);
+    b.addOrder(bo1);
+
+    const auto events = drain(*stream);
+    REQUIRE(events.size() == 3);
+
+    REQUIRE(events[0].type == ExecType::REST);
+    REQUIRE(events[0].orderID == 1);
+    REQUIRE(events[0].qty == 100);
+
+    // Taker first, then maker
+    REQUIRE(events[1].type == ExecType::FILL);
+    REQUIRE(events[1].orderID == 2);
+    REQUIRE(events[1].contraID == 1);
+    REQUIRE(events[1].qty == 40);
+    REQUIRE(events[1].price == Catch::Approx(5.0));
+    REQUIRE(events[1].side == Side::BUY);
+
+    REQUIRE(events[2].type == ExecType::PARTIAL_FILL);
+    REQUIRE(events[2].orderID == 1);
+    REQUIRE(events[2].contraID == 2);
+    REQUIRE(events[2].side == Side::SELL);
+}
+
+TEST_CASE("ExecReportSink: unfilled market order is rejected", "[ExecReport]"){
+    using Policy = ReportingPolicy<64>;
+    auto stream = std::make_unique<ExecReportStream<64>>();
+    BasicBook<Policy> b({}, ExecReportSink<64>(*stream));
+
+    BasicOrder<Policy> so1(1,Side::SELL,OrderType::LIMIT,30,5.0);
+    b.addOrder(so1);
+    BasicOrder<Policy> bo1(2,Side::BUY,OrderType::MARKET,50);
+    b.addOrder(bo1);
+
+    const auto events = drain(*stream);
+    REQUIRE(events.size() == 4);
+    REQUIRE(events[1].type == ExecType::PARTIAL_FILL); // Market order, 20 outstanding
+    REQUIRE(events[2].type == ExecType::FILL);         // Resting sell
+    REQUIRE(events[3].type == ExecType::REJECT);
+    REQUIRE(events[3].orderID == 2);
+    REQUIRE(events[3].qty == 20);
+}
+
+TEST_CASE("ExecReportSink: full book is rejected", "[ExecReport]"){
+    using Policy = ReportingPolicy<64>;
+    auto stream = std::make_unique<ExecReportStream<64>>();
+    BasicBook<Policy> b({.maxOrders = 1}, ExecReportSink<64>(*stream));
+
+    BasicOrder<Policy> bo1(1,Side::BUY,OrderType::LIMIT,10,5.0);
+    BasicOrder<Policy> bo2(2,Side::BUY,OrderType::LIMIT,10,5.0);
+    b.addOrder(bo1);
+    REQUIRE(!b.addOrder(bo2));
+
+    const auto events = drain(*stream);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[1].type == ExecType::REJECT);
+    REQUIRE(events[1].orderID == 2);
+    REQUIRE(events[1].qty == 10);
+}
+
+TEST_CASE("ExecReportSink: DROP counts reports that don't fit", "[ExecReport]"){
+    // Ring of 4 holds 3 reports
+    using Policy = ReportingPolicy<4, Overflow::DROP>;
+    auto stream = std::make_unique<ExecReportStream<4>>();
+    BasicBook<Policy> b({}, ExecReportSink<4, Overflow::DROP>(*stream));
+
+    for (int i = 0; i < 5; ++i){
+        BasicOrder<Policy> o(i,Side::BUY,OrderType::LIMIT,10,5.0);
+        b.addOrder(o);
+    }
+
+    REQUIRE(drain(*stream).size() == 3);
+    REQUIRE(stream->droppedCount() == 2);
+}
+
+TEST_CASE("ExecReportSink: BACKPRESSURE waits for the consumer", "[ExecReport][Threads]"){
+    using Policy = ReportingPolicy<8, Overflow::BACKPRESSURE>;
+    auto stream = std::make_unique<ExecReportStream<8>>();
+    BasicBook<Policy> b({.maxOrders = 1'024}, ExecReportSink<8, Overflow::BACKPRESSURE>(*stream));
+    constexpr int n = 500;
+
+    // Matching thread rests n orders, each is one report
+    std::jthread matcher([&] {
+        for (int i = 0; i < n; ++i){
+            BasicOrder<Policy> o(i,Side::BUY,OrderType::LIMIT,10,5.0);
+            b.addOrder(o);
+        }
+    });
+
+    int received = 0;
+    int lastID = -1;
+    bool inOrder = true;
+    while (received < n){
+        if (auto e = stream->pop()){
+            inOrder = inOrder && e->orderID == lastID + 1;
+            lastID = e->orderID;
+            ++received;
+        }
+    }
+    matcher.join();
+
+    REQUIRE(inOrder);
+    REQUIRE(stream->droppedCount() == 0);
+}
@@ -0,0 +1,263 @@
+// Unit tests for the wire protocol and the Gateway, messages split across receives, malformed input and session limits
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/Gateway.hpp"
+#include "structures/SpscQ.hpp"
+#include "structures/Uring.hpp"
+#include "structures/WireProtocol.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+using Queue = SpscQ<OrderCommand,1'024>;
+
+std::string tempPath(const std::string& name){
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+struct Server{
+    //A Gateway running on its own thread until the test ends
+    std::unique_ptr<Queue> q = std::make_unique<Queue>();
+    Gateway<Queue> gw;
+    std::exception_ptr failed;
+    std::jthread thread;
+
+    explicit Server(const GatewayConfig& cfg) : gw(cfg, *q), thread([this](const std::stop_token st) {
+        try {gw.run(st);} catch (...) {failed = std::current_exception();}
+    }) {}
+};
+
+int connectTo(const std::string& path){
+    //Reads time out so a test fails rather than hangs
+    const int fd = connectUnix(path);
+    const timeval tv{5, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+bool sendBytes(const int fd, const void* data, const std::size_t n){
+    //No assertions in here, clients run on their own threads
+    const auto* p = static_cast<const char*>(data);
+    for (std::size_t sent = 0; sent < n;) {
+        const ssize_t w = ::write(fd, p + sent, n - sent);
+        if (w <= 0) {return false;}
+        sent += static_cast<std::size_t>(w);
+    }
+    return true;
+}
+
+ssize_t readByte(const int fd){
+    //One read, retried if a signal interrupts it
+    char c = 0;
+    ssize_t r = 0;
+    do {r = ::read(fd, &c, 1);} while (r < 0 && errno == EINTR);
+    return r;
+}
+
+std::vector<OrderCommand> take(Queue& q, const std::size_t n){
+    //n commands off the ring, or what arrived within 5 seconds
+    std::vector<OrderCommand> out;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (out.size() < n && std::chrono::steady_clock::now() < deadline) {
+        if (const OrderCommand* c = q.peek()) {
+            out.push_back(*c);
+            q.release();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return out;
+}
+
+template<typename Ready>
+bool waitFor(Ready&& ready){
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!ready()) {
+        if (std::chrono::steady_clock::now() > deadline) {return false;}
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}
+
+//Happy path test - Every kind of command survives the wire, the participant comes from the session
+TEST_CASE("toWire/fromWire: Commands round trip","[Gateway]"){
+    OrderCommand limit = OrderCommand::limit(1,Side::SELL,100,5.25,7);
+    limit.sent = 12'345;
+    const OrderCommand sent[] = {limit, OrderCommand::market(2,Side::BUY,40), OrderCommand::amend(1,30,5.5,7),
+                                 OrderCommand::cancel(1,7)};
+
+    for (const OrderCommand& c : sent) {
+        OrderCommand back{};
+        REQUIRE(fromWire(toWire(c),9,back));
+        REQUIRE(back.command == c.command);
+        REQUIRE(back.type == c.type);
+        REQUIRE(back.side == c.side);
+        REQUIRE(back.orderID == c.orderID);
+        REQUIRE(back.qty == c.qty);
+        REQUIRE(back.price == c.price);
+        REQUIRE(back.instrument == c.instrument);
+        REQUIRE(back.sent == c.sent);
+    }
+    OrderCommand back{};
+    REQUIRE(fromWire(toWire(limit),9,back));
+    REQUIRE(back.participant == 9);
+}
+
+//Edge case - Messages no client could have meant are refused
+TEST_CASE("fromWire: Rejects unknown kinds, sides, NaN prices and oversized quantities","[Gateway]"){
+    const WireOrder good = toWire(OrderCommand::limit(1,Side::BUY,10,5.0));
+    OrderCommand c = OrderCommand::cancel(42);
+
+    WireOrder m = good;
+    m.kind = static_cast<WireKind>(9);
+    REQUIRE_FALSE(fromWire(m,0,c));
+    m = good;
+    m.side = 2;
+    REQUIRE_FALSE(fromWire(m,0,c));
+    m = good;
+    m.price = std::numeric_limits<double>::quiet_NaN();
+    REQUIRE_FALSE(fromWire(m,0,c));
+    //Would wrap negative as an Order's int
+    m = good;
+    m.qty = 3'000'000'000U;
+    REQUIRE_FALSE(fromWire(m,0,c));
+    REQUIRE(c.orderID == 42); //Left as it was
+
+    m.qty = INT32_MAX;
+    REQUIRE(fromWire(m,0,c));
+    REQUIRE(c.qty == INT32_MAX);
+    REQUIRE(toWire(OrderCommand::limit(1,Side::BUY,int64_t{1} << 40,5.0)).qty == INT32_MAX);
+}
+
+//Happy path test - Orders from two sessions reach the ring, including one split across two writes
+TEST_CASE("Gateway: Sessions' orders reach the ring","[Gateway]"){
+    if (!Uring::supported()) {WARN("io_uring unavailable, skipped"); return;}
+    Server s({.path = tempPath("testGateway.sock")});
+
+    const int a = connectTo(tempPath("testGateway.sock"));
+    const int b = connectTo(tempPath("testGateway.sock"));
+    const WireOrder first = toWire(OrderCommand::limit(1,Side::SELL,100,5.25));
+    const WireOrder split = toWire(OrderCommand::market(2,Side::BUY,40));
+    const WireOrder other = toWire(OrderCommand::limit(3,Side::BUY,10,5.0));
+
+    REQUIRE(sendBytes(a,&first,sizeof(first)));
+    REQUIRE(sendBytes(a,&split,10));
+    REQUIRE(sendBytes(b,&other,sizeof(other)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(sendBytes(a,reinterpret_cast<const char*>(&split) + 10,sizeof(split) - 10));
+
+    const std::vector<OrderCommand> got = take(*s.q,3);
+    REQUIRE(got.size() == 3);
+    uint16_t aParticipant = 0, bParticipant = 0;
+    for (const OrderCommand& c : got) {
+        if (c.orderID == 1) {REQUIRE(c.qty == 100); REQUIRE(c.price == 5.25); aParticipant = c.participant;}
+        else if (c.orderID == 2) {REQUIRE(c.type == OrderType::MARKET); REQUIRE(c.participant == aParticipant);}
+        else {REQUIRE(c.orderID == 3); bParticipant = c.participant;}
+    }
+    REQUIRE(aParticipant != bParticipant);
+    REQUIRE(s.gw.openSessions() == 2);
+
+    ::close(a);
+    ::close(b);
+    REQUIRE(waitFor([&] {return s.gw.idlePeriods() == 1;}));
+    REQUIRE(s.gw.openSessions() == 0);
+    const GatewayStats st = s.gw.stats();
+    REQUIRE(st.accepted == 2);
+    REQUIRE(st.closed == 2);
+    REQUIRE(st.messages == 3);
+    REQUIRE(st.bytes == 3 * sizeof(WireOrder));
+    REQUIRE(st.malformed == 0);
+    REQUIRE(s.failed == nullptr);
+}
+
+//Happy path test - Long streams through small buffers and a ring the consumer drains slower than it fills
+TEST_CASE("Gateway: Streams arrive whole through small buffers and a full ring","[Gateway]"){
+    if (!Uring::supported()) {WARN("io_uring unavailable, skipped"); return;}
+    //64 byte buffers cut messages at every receive, 8 of them run out under three sessions
+    Server s({.path = tempPath("testGatewayStream.sock"), .buffers = 8, .bufferSize = 64});
+
+    constexpr int perSession = 5'000;
+    std::vector<std::jthread> clients;
+    for (int k = 0; k < 3; ++k) {
+        clients.emplace_back([k] {
+            const int fd = connectTo(tempPath("testGatewayStream.sock"));
+            std::vector<WireOrder> msgs;
+            for (int i = 0; i < perSession; ++i) {
+                msgs.push_back(toWire(OrderCommand::limit(k * perSession + i + 1,Side::BUY,i + 1,5.0)));
+            }
+            sendBytes(fd,msgs.data(),msgs.size() * sizeof(WireOrder));
+            ::close(fd);
+        });
+    }
+
+    const std::vector<OrderCommand> got = take(*s.q,3 * perSession);
+    REQUIRE(got.size() == 3 * perSession);
+    //Each session's orders arrive in the order it sent them
+    std::vector<int> next(3,1);
+    for (const OrderCommand& c : got) {
+        const int k = (c.orderID - 1) / perSession;
+        REQUIRE(c.qty == next[static_cast<std::size_t>(k)]++);
+    }
+    REQUIRE(waitFor([&] {return s.gw.idlePeriods() >= 1 && s.gw.openSessions() == 0;}));
+    REQUIRE(s.gw.stats().messages == 3 * perSession);
+    REQUIRE(s.failed == nullptr);
+}
+
+//Edge case - A malformed message ends its session, nothing after it is delivered
+TEST_CASE("Gateway: A malformed message closes the session","[Gateway]"){
+    if (!Uring::supported()) {WARN("io_uring unavailable, skipped"); return;}
+    Server s({.path = tempPath("testGatewayBad.sock")});
+
+    const int fd = connectTo(tempPath("testGatewayBad.sock"));
+    WireOrder msgs[3] = {toWire(OrderCommand::limit(1,Side::BUY,10,5.0)), toWire(OrderCommand::limit(2,Side::BUY,10,5.0)),
+                         toWire(OrderCommand::limit(3,Side::BUY,10,5.0))};
+    msgs[1].kind = static_cast<WireKind>(7);
+    REQUIRE(sendBytes(fd,msgs,sizeof(msgs)));
+
+    REQUIRE(readByte(fd) == 0); //Shut down by the gateway
+    ::close(fd);
+
+    REQUIRE(waitFor([&] {return s.gw.openSessions() == 0 && s.gw.stats().closed == 1;}));
+    const std::vector<OrderCommand> got = take(*s.q,1);
+    REQUIRE(got.size() == 1);
+    REQUIRE(got[0].orderID == 1);
+    REQUIRE(s.q->peek() == nullptr);
+    REQUIRE(s.gw.stats().malformed == 1);
+}
+
+//Edge case - Connections beyond maxSessions are closed straight away
+TEST_CASE("Gateway: Refuses sessions beyond maxSessions","[Gateway]"){
+    if (!Uring::supported()) {WARN("io_uring unavailable, skipped"); return;}
+    Server s({.path = tempPath("testGatewayFull.sock"), .maxSessions = 1});
+
+    const int first = connectTo(tempPath("testGatewayFull.sock"));
+    REQUIRE(waitFor([&] {return s.gw.openSessions() == 1;}));
+    const int second = connectTo(tempPath("testGatewayFull.sock"));
+    REQUIRE(readByte(second) == 0);
+    REQUIRE(s.gw.stats().refused == 1);
+
+    //The first is still served
+    const WireOrder m = toWire(OrderCommand::limit(1,Side::BUY,10,5.0));
+    REQUIRE(sendBytes(first,&m,sizeof(m)));
+    REQUIRE(take(*s.q,1).size() == 1);
+    ::close(first);
+    ::close(second);
+}
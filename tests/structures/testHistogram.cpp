@@ -0,0 +1,123 @@
+// Unit tests for the LatencyHistogram class and TscClock, bucketing precision, percentiles and reading while recording
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include "structures/LatencyHistogram.hpp"
+#include "structures/TscClock.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+//Happy path test - Small values are exact, larger ones land in a bucket within 1/128 of them
+TEST_CASE("bucketOf: Buckets are contiguous and within 1/128","[Histogram]"){
+    for (uint64_t v = 0; v < 256; ++v) {
+        REQUIRE(LatencyHistogram::bucketOf(v) == v);
+        REQUIRE(LatencyHistogram::highestIn(v) == v);
+    }
+
+    for (const uint64_t v : {uint64_t{256}, uint64_t{257}, uint64_t{1'000}, uint64_t{123'456'789}, uint64_t{1} << 40}) {
+        const std::size_t b = LatencyHistogram::bucketOf(v);
+        const uint64_t top = LatencyHistogram::highestIn(b);
+        REQUIRE(top >= v);
+        REQUIRE(static_cast<double>(top - v) <= static_cast<double>(v) / 128.0);
+        //The next value past a bucket's top starts the next bucket
+        REQUIRE(LatencyHistogram::bucketOf(top + 1) == b + 1);
+    }
+
+    //The whole range fits
+    REQUIRE(LatencyHistogram::bucketOf(UINT64_MAX) == LatencyHistogram::buckets - 1);
+    REQUIRE(LatencyHistogram::highestIn(LatencyHistogram::buckets - 1) == UINT64_MAX);
+}
+
+//Happy path test - Percentiles, mean and max of a known distribution
+TEST_CASE("percentile: Reads a uniform distribution","[Histogram]"){
+    auto h = std::make_unique<LatencyHistogram>();
+    REQUIRE(h->percentile(99) == 0);
+
+    for (uint64_t v = 1; v <= 10'000; ++v) {h->record(v);}
+
+    REQUIRE(h->count() == 10'000);
+    REQUIRE(h->max() == 10'000);
+    REQUIRE(h->mean() == Catch::Approx(5'000.5));
+    REQUIRE(h->percentile(0) == 1);
+    REQUIRE(h->percentile(100) == 10'000);
+    REQUIRE(static_cast<double>(h->percentile(50)) == Catch::Approx(5'000).epsilon(1.0 / 128));
+    REQUIRE(static_cast<double>(h->percentile(99)) == Catch::Approx(9'900).epsilon(1.0 / 128));
+
+    h->reset();
+    REQUIRE(h->count() == 0);
+    REQUIRE(h->percentile(50) == 0);
+}
+
+//Happy path test - Merging two histograms reads the same as recording both into one
+TEST_CASE("merge: Adds another histogram's values","[Histogram]"){
+    auto low = std::make_unique<LatencyHistogram>();
+    auto high = std::make_unique<LatencyHistogram>();
+    auto both = std::make_unique<LatencyHistogram>();
+    for (uint64_t v = 1; v <= 5'000; ++v) {low->record(v); both->record(v);}
+    for (uint64_t v = 5'001; v <= 10'000; ++v) {high->record(v); both->record(v);}
+
+    low->merge(*high);
+    REQUIRE(low->count() == 10'000);
+    REQUIRE(low->max() == 10'000);
+    REQUIRE(low->mean() == Catch::Approx(5'000.5));
+    for (const double p : {0.0, 50.0, 90.0, 99.0, 100.0}) {REQUIRE(low->percentile(p) == both->percentile(p));}
+
+    //The max is kept when the other's is smaller, merging an empty one changes nothing
+    high->merge(*std::make_unique<LatencyHistogram>());
+    REQUIRE(high->count() == 5'000);
+    REQUIRE(high->max() == 10'000);
+}
+
+//Happy path test - PipelineLatency splits a command's time into queue wait and Book time
+TEST_CASE("PipelineLatency: Records queue wait, Book and end to end","[Histogram]"){
+    auto p = std::make_unique<PipelineLatency>();
+
+    //Stamped at 100, picked up at 150, applied by 170
+    p->record(100, 150, 170);
+    REQUIRE(p->queueWait.max() == 50);
+    REQUIRE(p->book.max() == 20);
+    REQUIRE(p->endToEnd.max() == 70);
+
+    //The 32 bit stamp wraps before the pickup
+    p->record(UINT32_MAX - 9, (uint64_t{1} << 32) + 10, (uint64_t{1} << 32) + 15);
+    REQUIRE(p->queueWait.max() == 50);
+    REQUIRE(p->queueWait.percentile(0) == 20);
+}
+
+//Happy path test - The TSC rate is plausible and ticks move forward
+TEST_CASE("TscClock: Calibrates and counts up","[Histogram]"){
+    REQUIRE(TscClock::nsPerTick() > 0);
+    REQUIRE(TscClock::nsPerTick() < 10);
+    const uint64_t a = TscClock::now();
+    const uint64_t b = TscClock::now();
+    REQUIRE(b >= a);
+}
+
+//Happy path test - Another thread reads percentiles while one records
+TEST_CASE("percentile: Readable while another thread records","[Histogram][Threads]"){
+    auto h = std::make_unique<LatencyHistogram>();
+    std::atomic<bool> done = false;
+    constexpr uint64_t n = 200'000;
+
+    std::jthread writer([&] {
+        for (uint64_t i = 0; i < n; ++i) {h->record(i % 1'000);}
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        const uint64_t p = h->percentile(99.9);
+        REQUIRE(p < 1'000);
+        REQUIRE(h->count() >= last);
+        last = h->count();
+        std::this_thread::yield();
+    }
+    writer.join();
+
+    REQUIRE(h->count() == n);
+    REQUIRE(h->percentile(100) == 999);
+}
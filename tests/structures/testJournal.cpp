@@ -0,0 +1,135 @@
+// Unit tests for the Journal, appending, recovering a Book and surviving a torn tail
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include "structures/Journal.hpp"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string tempPath(const std::string& name){
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::remove(path.c_str());
+    return path;
+}
+
+std::vector<OrderCommand> randomFlow(const int n){
+    // Limits around 100 with some markets, cancels and amends of earlier orders
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> kind(0,9);
+    std::uniform_int_distribution<int> qty(1,50);
+    std::normal_distribution<double> price(100.0,1.0);
+    std::vector<OrderCommand> flow;
+    for (int i = 0; i < n; ++i) {
+        const Side side = i % 2 ? Side::BUY : Side::SELL;
+        const int k = kind(gen);
+        if (k < 6 || i == 0) {flow.push_back(OrderCommand::limit(i,side,qty(gen),price(gen)));}
+        else if (k < 8) {flow.push_back(OrderCommand::market(i,side,qty(gen)));}
+        else if (k < 9) {flow.push_back(OrderCommand::cancel(i / 2));}
+        else {flow.push_back(OrderCommand::amend(i / 3,qty(gen),price(gen)));}
+    }
+    return flow;
+}
+
+template<std::size_t N>
+std::array<Book::DepthLevel,N> top(const Book& b, const Side s){
+    std::array<Book::DepthLevel,N> levels{};
+    b.depth(s,levels);
+    return levels;
+}
+
+void requireSameBook(const Book& a, const Book& b){
+    REQUIRE(a.size() == b.size());
+    for (const Side s : {Side::BUY, Side::SELL}) {
+        const auto x = top<32>(a,s);
+        const auto y = top<32>(b,s);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            REQUIRE(x[i].price == Catch::Approx(y[i].price));
+            REQUIRE(x[i].quantity == y[i].quantity);
+            REQUIRE(x[i].orders == y[i].orders);
+        }
+    }
+}
+
+}
+
+TEST_CASE("Journal: recovery rebuilds the same book","[Journal]"){
+    const std::string path = tempPath("testJournalRecover.log");
+    const auto flow = randomFlow(5'000);
+
+    Book live;
+    {
+        Journal j(path);
+        for (const auto& c : flow) {
+            j.append(c);
+            live.apply(c);
+        }
+        j.flush();
+        REQUIRE(j.durableSeq() == flow.size());
+        REQUIRE(!j.failed());
+    }
+
+    Book rebuilt;
+    REQUIRE(recover(path,rebuilt) == flow.size());
+    requireSameBook(live,rebuilt);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Journal: a torn tail is ignored and cut off on reopen","[Journal]"){
+    const std::string path = tempPath("testJournalTorn.log");
+    const auto flow = randomFlow(100);
+    {
+        Journal j(path,false);
+        for (const auto& c : flow) {j.append(c);}
+    }
+
+    // Simulate a crash half way through writing entry 101, and a corrupted entry 100
+    {
+        std::fstream f(path,std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(0,std::ios::end);
+        f << std::string(20,'\x7f');
+        f.seekp(-20 - static_cast<long>(sizeof(JournalEntry)) + 12,std::ios::end);
+        f.put('\x01');
+    }
+    REQUIRE(JournalReader(path).size() == 99);
+
+    // Reopening continues from the last good entry
+    {
+        Journal j(path,false);
+        REQUIRE(j.nextSeq() == 100);
+        j.append(flow[99]);
+        j.flush();
+        REQUIRE(j.durableSeq() == 100);
+    }
+    const JournalReader r(path);
+    REQUIRE(r.size() == 100);
+    REQUIRE(r.validBytes() == std::filesystem::file_size(path));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Journal: rejects files that aren't journals","[Journal]"){
+    const std::string path = tempPath("testJournalForeign.log");
+    {
+        std::ofstream f(path,std::ios::binary);
+        f << std::string(64,'x');
+    }
+    REQUIRE_THROWS_AS(JournalReader(path),std::runtime_error);
+    REQUIRE_THROWS_AS(Journal(path),std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("crc32c: matches the standard check value","[Journal]"){
+    REQUIRE(crc32c("123456789",9) == 0xE3069283U);
+    REQUIRE(crc32c("",0) == 0);
+    //32 zero bytes, from the iSCSI test vectors (RFC 3720), runs whole words through the crc32 instruction if present
+    const std::array<unsigned char,32> zeros{};
+    REQUIRE(crc32c(zeros.data(),zeros.size()) == 0x8A9136AAU);
+}
@@ -0,0 +1,217 @@
+// Unit tests for the PriceLadder class — tick indexing, best price scans and window moves
+
+#include "structures/PriceLadder.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace {
+// Minimal level type, PriceLadder only needs reset()
+struct IntLevel {
+    int value = 0;
+    void reset() noexcept {value = 0;}
+};
+}
+
+template<typename L>
+class TestLadderHelper {
+public:
+    //Getters
+    static std::size_t window(const PriceLadder<L>& l) {return l.window();}
+    static long long base(const PriceLadder<L>& l) {return l.base;}
+};
+
+using TLH = TestLadderHelper<IntLevel>;
+
+TEST_CASE("occupy: tracks lowest and highest ticks", "[Ladder]"){
+    PriceLadder<IntLevel> l(64);
+
+    l.occupy(10)->value = 1;
+    l.occupy(3)->value = 2;
+    l.occupy(20)->value = 3;
+
+    REQUIRE(l.size() == 3);
+    REQUIRE(l.lowest() == 3);
+    REQUIRE(l.highest() == 20);
+    REQUIRE(l.find(10)->value == 1);
+    REQUIRE(l.find(11) == nullptr);
+}
+
+TEST_CASE("vacate: bit scan finds the next best tick", "[Ladder]"){
+    PriceLadder<IntLevel> l(256);
+
+    // Spread across several bitmap words
+    l.occupy(1);
+    l.occupy(70);
+    l.occupy(130);
+    l.occupy(200);
+
+    l.vacate(1);
+    REQUIRE(l.lowest() == 70);
+    l.vacate(200);
+    REQUIRE(l.highest() == 130);
+    l.vacate(70);
+    REQUIRE(l.lowest() == 130);
+    REQUIRE(l.highest() == 130);
+    l.vacate(130);
+    REQUIRE(l.empty());
+}
+
+TEST_CASE("occupy: recenters without growing when the range fits", "[Ladder]"){
+    PriceLadder<IntLevel> l(256);
+
+    l.occupy(200)->value = 7;
+    l.occupy(300)->value = 8; // Outside [0, 256)
+
+    REQUIRE(TLH::window(l) == 256);
+    REQUIRE(TLH::base(l) > 0);
+    REQUIRE(l.find(200)->value == 7);
+    REQUIRE(l.find(300)->value == 8);
+    REQUIRE(l.lowest() == 200);
+    REQUIRE(l.highest() == 300);
+
+    // Slide back the other way
+    l.vacate(300);
+    l.occupy(100)->value = 9;
+    REQUIRE(TLH::window(l) == 256);
+    REQUIRE(l.find(100)->value == 9);
+    REQUIRE(l.find(200)->value == 7);
+}
+
+TEST_CASE("occupy: grows when the occupied range is too wide", "[Ladder]"){
+    PriceLadder<IntLevel> l(64);
+
+    l.occupy(5)->value = 1;
+    l.occupy(-1'000)->value = 2;
+    l.occupy(10'000)->value = 3;
+
+    REQUIRE(TLH::window(l) >= 11'001);
+    REQUIRE(l.find(5)->value == 1);
+    REQUIRE(l.find(-1'000)->value == 2);
+    REQUIRE(l.find(10'000)->value == 3);
+
+    std::vector<long long> ticks;
+    l.forEachDescending([&](long long t, const IntLevel&){ticks.push_back(t);});
+    REQUIRE(ticks == std::vector<long long>{10'000, 5, -1'000});
+}
+
+TEST_CASE("occupy: returns nullptr rather than growing past maxTicks", "[Ladder]"){
+    PriceLadder<IntLevel> l(64, 16, 1'024);
+
+    l.occupy(5)->value = 1;
+    REQUIRE(l.occupy(1'028) != nullptr); // Spans exactly 1'024 ticks
+    REQUIRE(l.occupy(1'029) == nullptr);
+    REQUIRE(l.occupy(-1'000) == nullptr);
+    REQUIRE(l.occupy(std::numeric_limits<long long>::max()) == nullptr);
+    REQUIRE(l.occupy(std::numeric_limits<long long>::min()) == nullptr);
+    REQUIRE(TLH::window(l) == 1'024);
+    REQUIRE(l.size() == 2);
+    REQUIRE(l.find(5)->value == 1);
+
+    // Once the low level is gone the window can follow the price up
+    l.vacate(5);
+    REQUIRE(l.occupy(2'000) != nullptr);
+    REQUIRE(l.lowest() == 1'028);
+    REQUIRE(l.highest() == 2'000);
+}
+
+TEST_CASE("vacate: level is reset for reuse", "[Ladder]"){
+    PriceLadder<IntLevel> l(64);
+
+    l.occupy(4)->value = 9;
+    l.vacate(4);
+    REQUIRE(l.find(4) == nullptr);
+    REQUIRE(l.occupy(4)->value == 0);
+}
+
+TEST_CASE("TickBitmap: scans across empty summary words", "[Ladder]"){
+    TickBitmap bm(1 << 20);
+
+    REQUIRE(bm.scanUp(0) == TickBitmap::npos);
+
+    bm.set(3);
+    bm.set(500'000);
+    bm.set(1'000'000);
+
+    REQUIRE(bm.scanUp(4) == 500'000);
+    REQUIRE(bm.scanUp(500'001) == 1'000'000);
+    REQUIRE(bm.scanDown(999'999) == 500'000);
+    REQUIRE(bm.scanDown(499'999) == 3);
+    REQUIRE(bm.scanDown(2) == TickBitmap::npos);
+
+    bm.clear(500'000);
+    REQUIRE(bm.scanUp(4) == 1'000'000);
+    REQUIRE(bm.scanDown(999'999) == 3);
+    REQUIRE(bm.scanUp(1'000'001) == TickBitmap::npos);
+}
+
+TEST_CASE("occupy: returns nullptr when the level pool is exhausted", "[Ladder]"){
+    PriceLadder<IntLevel> l(64, 2);
+
+    REQUIRE(l.occupy(1) != nullptr);
+    REQUIRE(l.occupy(2) != nullptr);
+    REQUIRE(l.full());
+    REQUIRE(l.occupy(2) != nullptr); // Already occupied, no new level needed
+    REQUIRE(l.occupy(3) == nullptr);
+    REQUIRE(l.occupy(10'000) == nullptr);
+
+    // A vacated level can be reused
+    l.vacate(1);
+    REQUIRE(l.occupy(3) != nullptr);
+    REQUIRE(l.size() == 2);
+}
+
+TEST_CASE("forEach: stops when the visitor returns false", "[Ladder]"){
+    PriceLadder<IntLevel> l(64);
+    for (const long long t : {3, 8, 12, 20}) {l.occupy(t);}
+
+    std::vector<long long> ticks;
+    l.forEachAscending([&](long long t, const IntLevel&){ticks.push_back(t); return ticks.size() < 2;});
+    REQUIRE(ticks == std::vector<long long>{3, 8});
+
+    ticks.clear();
+    l.forEachDescending([&](long long t, const IntLevel&){ticks.push_back(t); return t > 10;});
+    REQUIRE(ticks == std::vector<long long>{20, 12, 8});
+}
+
+TEST_CASE("bestTicks: best first up to a stop tick", "[Ladder]"){
+    PriceLadder<IntLevel> l(64);
+    std::array<long long, 3> out{};
+    REQUIRE(l.bestTicks<true>(out, 100) == 0);
+
+    for (const long long t : {3, 8, 12, 20}) {l.occupy(t);}
+
+    REQUIRE(l.bestTicks<true>(out, 100) == 3);
+    REQUIRE(out == std::array<long long, 3>{3, 8, 12});
+    REQUIRE(l.bestTicks<false>(out, 0) == 3);
+    REQUIRE(out == std::array<long long, 3>{20, 12, 8});
+
+    //Vacating the two best in one go moves the best tick past them
+    REQUIRE(l.bestTicks<true>(std::span<long long>(out).first(2), 100) == 2);
+    l.vacateBest<true>(std::span<const long long>(out).first(2));
+    REQUIRE(l.size() == 2);
+    REQUIRE(l.lowest() == 12);
+    REQUIRE(l.find(3) == nullptr);
+    l.occupy(3);
+    l.occupy(8);
+
+    //The stop tick itself is included, nothing past it
+    REQUIRE(l.bestTicks<true>(out, 8) == 2);
+    REQUIRE(l.bestTicks<false>(out, 13) == 1);
+    REQUIRE(l.bestTicks<true>(std::span<long long>(out).first(1), 100) == 1);
+    REQUIRE(l.bestTicks<true>(out, 2) == 0);
+
+    //Vacating every tick empties the ladder
+    REQUIRE(l.bestTicks<false>(out, 0) == 3);
+    l.vacateBest<false>(out);
+    REQUIRE(l.highest() == 3);
+    l.vacateBest<false>(std::span<const long long>()); //Nothing to vacate
+    REQUIRE(l.size() == 1);
+    const std::array<long long,1> last{3};
+    l.vacateBest<false>(last);
+    REQUIRE(l.empty());
+}
@@ -0,0 +1,152 @@
+// Unit tests for the MpscQ and FanInQ classes, single threaded behaviour and concurrent producers
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/MpscQ.hpp"
+#include "structures/FanInQ.hpp"
+#include "structures/Order.hpp"
+
+#include <array>
+#include <thread>
+#include <vector>
+
+template<typename O, std::size_t N>
+class TestMpscHelper {
+public:
+    static std::size_t getHead(const MpscQ<O, N>& q) {return q.head;}
+    static std::size_t getTail(const MpscQ<O, N>& q) {return q.tail;}
+
+    // Takes a position the way a producer does, without writing or publishing the slot
+    static void claimOnly(MpscQ<O, N>& q) {q.tail.fetch_add(1);}
+};
+
+TEST_CASE("MpscQ: push/pop in order and fails when full", "[MpscQ]") {
+    MpscQ<Order,4> q;
+    REQUIRE(!q.pop().has_value());
+
+    // Holds all N
+    for (int i = 0; i < 4; ++i) {
+        Order o(i,Side::BUY,OrderType::LIMIT,10);
+        REQUIRE(q.push(o));
+    }
+    Order extra(4,Side::BUY,OrderType::LIMIT,10);
+    REQUIRE(!q.push(extra));
+
+    REQUIRE(q.pop()->getID() == 0);
+    REQUIRE(q.push(extra));
+    for (int i = 1; i < 5; ++i) {REQUIRE(q.pop()->getID() == i);}
+    REQUIRE(!q.pop().has_value());
+}
+
+TEST_CASE("MpscQ: wraps many laps", "[MpscQ]") {
+    MpscQ<Order,2> q;
+    for (int i = 0; i < 10; ++i) {
+        Order o(i,Side::SELL,OrderType::MARKET,1);
+        REQUIRE(q.push(o));
+        REQUIRE(q.pop()->getID() == i);
+    }
+    REQUIRE(TestMpscHelper<Order,2>::getHead(q) == 10);
+    REQUIRE(TestMpscHelper<Order,2>::getTail(q) == 10);
+}
+
+TEST_CASE("MpscQ: consumer waits on a claimed slot that isn't written yet", "[MpscQ]") {
+    MpscQ<Order,4> q;
+    using TMH = TestMpscHelper<Order,4>;
+
+    // A producer holds position 0, another finishes position 1
+    TMH::claimOnly(q);
+    Order o(1,Side::BUY,OrderType::LIMIT,10);
+    REQUIRE(q.push(o));
+
+    // Order is by position, so nothing comes out until position 0 is published
+    REQUIRE(!q.pop().has_value());
+    REQUIRE(TMH::getHead(q) == 0);
+}
+
+TEST_CASE("MpscQ: concurrent producers deliver every order once, in order per producer", "[MpscQ][Threads]") {
+    MpscQ<Order,64> q;
+    constexpr int producers = 4;
+    constexpr int perProducer = 5'000;
+
+    // Producer p sends ids p*perProducer ...
+    std::vector<std::jthread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                Order o(p * perProducer + i,Side::BUY,OrderType::LIMIT,1);
+                while (!q.push(o)) {std::this_thread::yield();}
+            }
+        });
+    }
+
+    std::array<int,producers> nextID{};
+    for (int p = 0; p < producers; ++p) {nextID[p] = p * perProducer;}
+    bool inOrder = true;
+    for (int received = 0; received < producers * perProducer;) {
+        if (auto o = q.pop()) {
+            const int p = o->getID() / perProducer;
+            inOrder = inOrder && o->getID() == nextID[p];
+            ++nextID[p];
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : threads) {t.join();}
+
+    REQUIRE(inOrder);
+    REQUIRE(!q.pop().has_value());
+}
+
+TEST_CASE("FanInQ: round robin across producers", "[FanInQ]") {
+    FanInQ<Order,8,3> q;
+
+    // A busy ring 0 and a single order on ring 2
+    for (int i = 0; i < 4; ++i) {
+        Order o(i,Side::BUY,OrderType::LIMIT,1);
+        REQUIRE(q.push(0,o));
+    }
+    Order quiet(100,Side::SELL,OrderType::LIMIT,1);
+    REQUIRE(q.push(2,quiet));
+
+    // The quiet producer is served after one order from the busy one, not after all of them
+    REQUIRE(q.pop()->getID() == 0);
+    REQUIRE(q.pop()->getID() == 100);
+    REQUIRE(q.pop()->getID() == 1);
+    REQUIRE(q.pop()->getID() == 2);
+    REQUIRE(q.pop()->getID() == 3);
+    REQUIRE(!q.pop().has_value());
+}
+
+TEST_CASE("FanInQ: concurrent producers deliver every order once", "[FanInQ][Threads]") {
+    constexpr int producers = 4;
+    constexpr int perProducer = 5'000;
+    FanInQ<Order,64,producers> q;
+
+    std::vector<std::jthread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                Order o(p * perProducer + i,Side::BUY,OrderType::LIMIT,1);
+                while (!q.push(p,o)) {std::this_thread::yield();}
+            }
+        });
+    }
+
+    std::array<int,producers> nextID{};
+    for (int p = 0; p < producers; ++p) {nextID[p] = p * perProducer;}
+    bool inOrder = true;
+    for (int received = 0; received < producers * perProducer;) {
+        if (auto o = q.pop()) {
+            const int p = o->getID() / perProducer;
+            inOrder = inOrder && o->getID() == nextID[p];
+            ++nextID[p];
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : threads) {t.join();}
+
+    REQUIRE(inOrder);
+}
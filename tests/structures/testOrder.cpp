@@ -54,40 +54,20 @@ TEST_CASE("exec: Partial Exec", "[Order]"){
 
 }
 
-TEST_CASE("exec: limit buy rejects execution above target price", "[Order]"){
 
-    Order o(4,Side::BUY,OrderType::LIMIT,25,25.2);
+TEST_CASE("exec: Prices are whole ticks and the notional is exact", "[Order]"){
 
-    int qty = 20;
-    double prc = 26;
+    Order o(3, Side::BUY, OrderType::LIMIT, 3,0.31);
 
-    // Limit BUY at 25.2 should not allow execution at 26.0
-    REQUIRE_THROWS_AS(OrderTestHelper::exec(o,qty,prc),std::logic_error);
-}
-
-TEST_CASE("exec: negative price throws exception", "[Order]"){
-    Order o(3,Side::BUY,OrderType::MARKET,1,10);
+    //Rounded to the 0.05 tick on construction
+    REQUIRE(OrderTestHelper::ticks(o) == 6);
+    REQUIRE(OrderTestHelper::tgtPrice(o) == Catch::Approx(0.3));
 
-    int qty = 1;
-    double prc = -10;
+    //0.1 + 0.2 + 0.3 isn't exact in floating point, in ticks it is
+    OrderTestHelper::exec(o,1,0.1);
+    OrderTestHelper::exec(o,1,0.2);
+    OrderTestHelper::exec(o,1,0.3);
 
-    REQUIRE_THROWS_AS(OrderTestHelper::exec(o,qty,prc),std::logic_error);
+    REQUIRE(OrderTestHelper::notional(o) == 12);
+    REQUIRE(OrderTestHelper::execPrice(o) == Catch::Approx(0.2));
 }
-
-TEST_CASE("exec: quantity greater than order throws exception", "[Order]"){
-    Order o(3,Side::BUY,OrderType::MARKET,1,10);
-
-    int qty = 2;
-    double prc = 10;
-
-    REQUIRE_THROWS_AS(OrderTestHelper::exec(o,qty,prc),std::logic_error);
-}
-
-TEST_CASE("exec: zero quantity throws exception", "[Order]") {
-    Order o(6, Side::SELL, OrderType::LIMIT, 10, 1.0);
-
-    int qty = 0;
-    double prc = 1.0;
-
-    REQUIRE_THROWS_AS(OrderTestHelper::exec(o, qty, prc), std::logic_error);
-}
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Unit tests for flow files, writing, mapping back and replaying into a ring
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/OrderFlow.hpp"
+#include "structures/SpscQ.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string tempPath(const std::string& name){
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+const std::array<OrderCommand,4> flow{{
+    OrderCommand::limit(1,Side::SELL,100,5.25,7,3),
+    OrderCommand::market(2,Side::BUY,40),
+    OrderCommand::amend(1,30,5.5,7),
+    OrderCommand::cancel(1,7),
+}};
+
+}
+
+TEST_CASE("FlowWriter/FlowReader: records round trip","[OrderFlow]"){
+    const std::string path = tempPath("testFlowRoundTrip.bin");
+    {
+        FlowWriter w(path);
+        for (const auto& c : flow) {w.write(c);}
+        REQUIRE(w.written() == 4);
+    }
+
+    const FlowReader r(path);
+    REQUIRE(r.size() == 4);
+    REQUIRE(r[0].event == FlowEvent::ADD);
+    REQUIRE(r[1].event == FlowEvent::MARKET);
+    REQUIRE(r[2].event == FlowEvent::AMEND);
+    REQUIRE(r[3].event == FlowEvent::CANCEL);
+
+    for (std::size_t i = 0; i < flow.size(); ++i) {
+        OrderCommand c{};
+        REQUIRE(decode(r[i],c));
+        REQUIRE(c.orderID == flow[i].orderID);
+        REQUIRE(c.instrument == flow[i].instrument);
+        REQUIRE(c.participant == flow[i].participant);
+        REQUIRE(c.command == flow[i].command);
+        REQUIRE(c.type == flow[i].type);
+        REQUIRE(c.qty == flow[i].qty);
+        REQUIRE(c.price == flow[i].price);
+    }
+    REQUIRE(r[0].side == 1);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("FlowReader: replay decodes into ring slots","[OrderFlow]"){
+    const std::string path = tempPath("testFlowReplay.bin");
+    {
+        FlowWriter w(path);
+        for (const auto& c : flow) {w.write(c);}
+    }
+
+    const FlowReader r(path);
+    SpscQ<OrderCommand,8> q;
+    REQUIRE(r.replay(q,1) == 3);
+
+    REQUIRE(q.peek()->orderID == 2);
+    REQUIRE(q.peek()->type == OrderType::MARKET);
+    q.release();
+    REQUIRE(q.peek()->command == CommandType::AMEND);
+    q.release();
+    REQUIRE(q.peek()->command == CommandType::CANCEL);
+    q.release();
+    REQUIRE(q.peek() == nullptr);
+    std::remove(path.c_str());
+}
+
+//Edge case - A corrupt event or side byte is skipped rather than replaying the slot's old command
+TEST_CASE("FlowReader: replay skips corrupt records","[OrderFlow]"){
+    const std::string path = tempPath("testFlowCorrupt.bin");
+    {
+        FlowWriter w(path);
+        for (const auto& c : flow) {w.write(c);}
+    }
+    {
+        //Record 1's event byte and record 2's side byte
+        std::fstream f(path,std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(sizeof(FlowHeader) + sizeof(FlowRecord) + offsetof(FlowRecord,event));
+        f.put(9);
+        f.seekp(sizeof(FlowHeader) + 2 * sizeof(FlowRecord) + offsetof(FlowRecord,side));
+        f.put(2);
+    }
+
+    const FlowReader r(path);
+    OrderCommand c = OrderCommand::cancel(99);
+    REQUIRE(!decode(r[1],c));
+    REQUIRE(!decode(r[2],c));
+    REQUIRE(c.orderID == 99);
+
+    SpscQ<OrderCommand,8> q;
+    REQUIRE(r.replay(q) == 2);
+    REQUIRE(q.peek()->command == CommandType::NEW);
+    q.release();
+    REQUIRE(q.peek()->command == CommandType::CANCEL);
+    q.release();
+    REQUIRE(q.peek() == nullptr);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("FlowReader: rejects missing and foreign files","[OrderFlow]"){
+    REQUIRE_THROWS_AS(FlowReader(tempPath("testFlowMissing.bin")),std::runtime_error);
+
+    const std::string path = tempPath("testFlowForeign.bin");
+    {
+        std::ofstream f(path,std::ios::binary);
+        f << std::string(64,'x');
+    }
+    REQUIRE_THROWS_AS(FlowReader(path),std::runtime_error);
+    std::remove(path.c_str());
+}
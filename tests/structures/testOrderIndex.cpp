@@ -0,0 +1,75 @@
+// Unit tests for the OrderIndex class — insert, lookup and backward shift deletes
+
+#include "structures/OrderIndex.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <unordered_map>
+
+TEST_CASE("insert: find returns the handle", "[OrderIndex]"){
+    OrderIndex idx(4);
+
+    idx.insert(10,1);
+    idx.insert(-3,2);
+    idx.insert(10,5); // Overwrites
+
+    REQUIRE(idx.size() == 2);
+    REQUIRE(idx.find(10) == 5);
+    REQUIRE(idx.find(-3) == 2);
+    REQUIRE(idx.find(11) == OrderIndex::npos);
+}
+
+TEST_CASE("erase: removes key and keeps colliding keys reachable", "[OrderIndex]"){
+    OrderIndex idx(4);
+
+    // Enough keys in a small table to force probe chains and a grow
+    for (int k = 0; k < 100; ++k) {idx.insert(k,static_cast<uint32_t>(k));}
+    for (int k = 0; k < 100; k += 2) {idx.erase(k);}
+    idx.erase(1'000); // Not present
+
+    REQUIRE(idx.size() == 50);
+    for (int k = 0; k < 100; ++k) {
+        REQUIRE(idx.find(k) == (k % 2 ? static_cast<uint32_t>(k) : OrderIndex::npos));
+    }
+}
+
+TEST_CASE("erase: with a handle only removes the key while it maps to that handle", "[OrderIndex]"){
+    OrderIndex idx;
+    idx.insert(5,1);
+    idx.insert(6,2);
+
+    idx.erase(5,7);
+    REQUIRE(idx.find(5) == 1);
+    idx.erase(8,1);
+    REQUIRE(idx.size() == 2);
+
+    idx.erase(5,1);
+    REQUIRE(idx.find(5) == OrderIndex::npos);
+    REQUIRE(idx.find(6) == 2);
+    REQUIRE(idx.size() == 1);
+}
+
+TEST_CASE("OrderIndex: matches std::unordered_map under random churn", "[OrderIndex]"){
+    OrderIndex idx;
+    std::unordered_map<int,uint32_t> ref;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> key(0,2'000);
+
+    for (uint32_t i = 0; i < 50'000; ++i) {
+        const int k = key(gen);
+        if (i % 3 == 0) {
+            idx.erase(k);
+            ref.erase(k);
+        } else {
+            idx.insert(k,i);
+            ref[k] = i;
+        }
+    }
+
+    REQUIRE(idx.size() == ref.size());
+    for (int k = 0; k <= 2'000; ++k) {
+        const auto it = ref.find(k);
+        REQUIRE(idx.find(k) == (it == ref.end() ? OrderIndex::npos : it->second));
+    }
+}
@@ -0,0 +1,39 @@
+// Unit tests for the Pool class — handing out, recycling and exhausting slots
+
+#include "structures/Pool.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("acquire: hands out every slot once then reports exhaustion", "[Pool]"){
+    Pool<int> p(3);
+
+    const uint32_t a = p.acquire();
+    const uint32_t b = p.acquire();
+    const uint32_t c = p.acquire();
+
+    REQUIRE(a == 0);
+    REQUIRE(b == 1);
+    REQUIRE(c == 2);
+    REQUIRE(p.full());
+    REQUIRE(p.inUse() == 3);
+    REQUIRE(p.acquire() == Pool<int>::npos);
+}
+
+TEST_CASE("release: slot is reused", "[Pool]"){
+    Pool<int> p(2);
+
+    const uint32_t a = p.acquire();
+    p[a] = 42;
+    (void)p.acquire();
+    p.release(a);
+
+    REQUIRE(p.inUse() == 1);
+    REQUIRE(p.acquire() == a);
+    REQUIRE(p[a] == 42); // Contents aren't touched, the owner resets them
+}
+
+TEST_CASE("Pool: zero capacity is always exhausted", "[Pool]"){
+    Pool<int> p(0);
+    REQUIRE(p.full());
+    REQUIRE(p.acquire() == Pool<int>::npos);
+}
@@ -0,0 +1,105 @@
+// Unit tests for the PreTradeCheck stage, each reject reason and the Book state it reads
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/Book.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/PreTrade.hpp"
+
+#include <limits>
+#include <string>
+
+//Happy path test - Well formed commands pass with the default limits
+TEST_CASE("check: Default limits pass well formed commands","[PreTrade]"){
+    const Book b;
+    const PreTradeCheck risk;
+
+    REQUIRE(risk.check(OrderCommand::limit(1,Side::BUY,10,5.0),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::market(2,Side::SELL,10),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::amend(1,5,5.0),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::cancel(1),b) == RejectReason::NONE);
+}
+
+//Edge case - Malformed quantities and prices never reach the book
+TEST_CASE("check: Rejects bad quantities and prices","[PreTrade]"){
+    const Book b;
+    const PreTradeCheck risk({.maxQty = 1'000, .minPrice = 1, .maxPrice = 100});
+
+    REQUIRE(risk.check(OrderCommand::limit(1,Side::BUY,0,5.0),b) == RejectReason::BAD_QUANTITY);
+    REQUIRE(risk.check(OrderCommand::market(2,Side::BUY,-5),b) == RejectReason::BAD_QUANTITY);
+    REQUIRE(risk.check(OrderCommand::limit(3,Side::BUY,1'001,5.0),b) == RejectReason::BAD_QUANTITY);
+    REQUIRE(risk.check(OrderCommand::amend(3,0,5.0),b) == RejectReason::BAD_QUANTITY);
+
+    REQUIRE(risk.check(OrderCommand::limit(4,Side::SELL,10,-10),b) == RejectReason::BAD_PRICE);
+    REQUIRE(risk.check(OrderCommand::limit(5,Side::SELL,10,0.5),b) == RejectReason::BAD_PRICE);
+    REQUIRE(risk.check(OrderCommand::limit(6,Side::SELL,10,100.05),b) == RejectReason::BAD_PRICE);
+    REQUIRE(risk.check(OrderCommand::limit(7,Side::SELL,10,std::numeric_limits<double>::quiet_NaN()),b)
+            == RejectReason::BAD_PRICE);
+    REQUIRE(risk.check(OrderCommand::amend(3,10,200),b) == RejectReason::BAD_PRICE);
+
+    //Even with no collar, a price whose tick count would overflow int64
+    const PreTradeCheck open;
+    REQUIRE(open.check(OrderCommand::limit(9,Side::SELL,10,1e20),b) == RejectReason::BAD_PRICE);
+    REQUIRE(open.check(OrderCommand::amend(9,10,1e20),b) == RejectReason::BAD_PRICE);
+    REQUIRE(open.check(OrderCommand::limit(10,Side::SELL,10,std::numeric_limits<double>::infinity()),b)
+            == RejectReason::BAD_PRICE);
+    REQUIRE(open.check(OrderCommand::limit(11,Side::SELL,10,1e8),b) == RejectReason::NONE);
+
+    //Participants beyond what the book counts
+    REQUIRE(risk.check(OrderCommand::limit(8,Side::BUY,10,5.0,0,256),b) == RejectReason::UNKNOWN_PARTICIPANT);
+}
+
+//Happy path test - The band follows the last trade, and markets are valued at it for the notional limit
+TEST_CASE("check: Band and notional use the last trade","[PreTrade]"){
+    Book b;
+    const PreTradeCheck risk({.band = 0.1, .maxNotional = 10'000});
+
+    //No trade yet, so no band. Markets are valued at the touch, and with nothing to take from they're worth nothing
+    REQUIRE(risk.check(OrderCommand::limit(1,Side::SELL,10,500),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::market(2,Side::BUY,1'000'000),b) == RejectReason::NONE);
+
+    b.apply(OrderCommand::limit(3,Side::SELL,10,100));
+    REQUIRE(risk.check(OrderCommand::market(2,Side::BUY,100),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::market(2,Side::BUY,101),b) == RejectReason::FAT_FINGER);
+    REQUIRE(risk.check(OrderCommand::market(2,Side::SELL,1'000'000),b) == RejectReason::NONE);
+    b.apply(OrderCommand::market(4,Side::BUY,5));
+    REQUIRE(b.lastPrice() == 100);
+
+    REQUIRE(risk.check(OrderCommand::limit(5,Side::BUY,10,90),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::limit(6,Side::BUY,10,89.95),b) == RejectReason::OUTSIDE_BAND);
+    REQUIRE(risk.check(OrderCommand::amend(3,5,111),b) == RejectReason::OUTSIDE_BAND);
+
+    REQUIRE(risk.check(OrderCommand::limit(7,Side::BUY,101,100),b) == RejectReason::FAT_FINGER);
+    REQUIRE(risk.check(OrderCommand::market(8,Side::BUY,100),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::market(9,Side::BUY,101),b) == RejectReason::FAT_FINGER);
+}
+
+//Happy path test - Open order limits count each participant's resting orders as they rest, fill and cancel
+TEST_CASE("check: Open order limit per participant","[PreTrade]"){
+    Book b;
+    const PreTradeCheck risk({.maxOpenOrders = 2});
+
+    b.apply(OrderCommand::limit(1,Side::SELL,10,100,0,7));
+    b.apply(OrderCommand::limit(2,Side::SELL,10,101,0,7));
+    REQUIRE(b.openOrders(7) == 2);
+    REQUIRE(risk.check(OrderCommand::limit(3,Side::SELL,10,102,0,7),b) == RejectReason::OPEN_ORDER_LIMIT);
+    //Other participants and market orders aren't affected
+    REQUIRE(risk.check(OrderCommand::limit(3,Side::SELL,10,102,0,8),b) == RejectReason::NONE);
+    REQUIRE(risk.check(OrderCommand::market(3,Side::BUY,5,0,7),b) == RejectReason::NONE);
+
+    //A fill takes order 1 out of the book, freeing a slot
+    b.apply(OrderCommand::market(4,Side::BUY,10,0,8));
+    REQUIRE(b.openOrders(7) == 1);
+    REQUIRE(risk.check(OrderCommand::limit(5,Side::SELL,10,102,0,7),b) == RejectReason::NONE);
+
+    //Amending to a new price keeps the owner, cancelling frees the slot
+    b.amend(2,10,103);
+    REQUIRE(b.openOrders(7) == 1);
+    b.cancel(2);
+    REQUIRE(b.openOrders(7) == 0);
+}
+
+TEST_CASE("toString: Every reason has a name","[PreTrade]"){
+    REQUIRE(std::string(toString(RejectReason::FAT_FINGER)) == "FAT_FINGER");
+    REQUIRE(std::string(toString(RejectReason::NONE)) == "NONE");
+}
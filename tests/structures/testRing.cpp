@@ -2,6 +2,7 @@
 
 #include "structures/SpscQ.hpp"
 #include "structures/Order.hpp"
+#include "structures/OrderCommand.hpp"
 #include "TestHelpers.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -108,3 +109,134 @@ TEST_CASE("Ring edge cases: behaves correctly with size-1 and size-2 ring","[Rin
     REQUIRE(OTH::tgtPrice(*popped) == 5);
     REQUIRE(!TRH2::doPop(r2).has_value());
 }
+
+TEST_CASE("push_n: fills up to capacity and wraps", "[Ring]") {
+    Ring<Order,8> r;
+    using TRH = TestRingHelper<Order,8>;
+
+    TRH::setHead(r,6);
+    TRH::setTail(r,6);
+
+    std::array<Order,10> in;
+    for (int i = 0; i < 10; ++i) {in[i] = {i, Side::BUY, OrderType::LIMIT, 10};}
+
+    // Capacity is N - 1
+    REQUIRE(TRH::doPushN(r,in) == 7);
+    REQUIRE(TRH::getTail(r) == 5);
+    REQUIRE(TRH::getBuffer(r)[6].getID() == 0);
+    REQUIRE(TRH::getBuffer(r)[0].getID() == 2);
+    REQUIRE(TRH::doPushN(r,in) == 0);
+}
+
+TEST_CASE("pop_n: drains in order across the wrap", "[Ring]") {
+    Ring<Order,8> r;
+    using TRH = TestRingHelper<Order,8>;
+
+    TRH::setHead(r,5);
+    TRH::setTail(r,5);
+    for (int i = 0; i < 6; ++i) {
+        Order o = {i, Side::SELL, OrderType::LIMIT, 10};
+        REQUIRE(TRH::doPush(r,o));
+    }
+
+    std::array<Order,4> out;
+    REQUIRE(TRH::doPopN(r,out) == 4);
+    for (int i = 0; i < 4; ++i) {REQUIRE(out[i].getID() == i);}
+
+    REQUIRE(TRH::doPopN(r,out) == 2);
+    REQUIRE(out[0].getID() == 4);
+    REQUIRE(out[1].getID() == 5);
+    REQUIRE(TRH::doPopN(r,out) == 0);
+    REQUIRE(TRH::getHead(r) == 3);
+}
+
+TEST_CASE("claim/commit: writes in place and publishes on commit", "[Ring]") {
+    Ring<OrderCommand,4> r;
+    using TRH = TestRingHelper<OrderCommand,4>;
+
+    TRH::setHead(r,3);
+    TRH::setTail(r,3);
+
+    OrderCommand* slot = TRH::doClaim(r);
+    REQUIRE(slot == &TRH::getBuffer(r)[3]);
+    *slot = OrderCommand::limit(7, Side::SELL, 10, 5.0);
+
+    // Claimed but not committed, so the consumer can't see it
+    REQUIRE(TRH::doPeek(r) == nullptr);
+    TRH::doCommit(r);
+    REQUIRE(TRH::getTail(r) == 0);
+
+    // Capacity is N - 1
+    for (int i = 0; i < 2; ++i) {
+        REQUIRE(TRH::doClaim(r) != nullptr);
+        TRH::doCommit(r);
+    }
+    REQUIRE(TRH::doClaim(r) == nullptr);
+}
+
+TEST_CASE("peek/release: reads in place and frees the slot on release", "[Ring]") {
+    Ring<OrderCommand,4> r;
+    using TRH = TestRingHelper<OrderCommand,4>;
+
+    REQUIRE(TRH::doPeek(r) == nullptr);
+
+    for (int i = 0; i < 3; ++i) {
+        *TRH::doClaim(r) = OrderCommand::cancel(i);
+        TRH::doCommit(r);
+    }
+    REQUIRE(TRH::doClaim(r) == nullptr);
+
+    const OrderCommand* front = TRH::doPeek(r);
+    REQUIRE(front == &TRH::getBuffer(r)[0]);
+    REQUIRE(front->orderID == 0);
+    REQUIRE(front->command == CommandType::CANCEL);
+
+    // Peeking again without releasing gives the same slot
+    REQUIRE(TRH::doPeek(r) == front);
+    TRH::doRelease(r);
+    REQUIRE(TRH::getHead(r) == 1);
+    REQUIRE(TRH::doClaim(r) != nullptr);
+    REQUIRE(TRH::doPeek(r)->orderID == 1);
+}
+
+TEST_CASE("peek_n/release_n: reads contiguous batches in place across the wrap", "[Ring]") {
+    Ring<OrderCommand,8> r;
+    using TRH = TestRingHelper<OrderCommand,8>;
+
+    REQUIRE(TRH::doPeekN(r,4).empty());
+
+    TRH::setHead(r,5);
+    TRH::setTail(r,5);
+    for (int i = 0; i < 6; ++i) {
+        *TRH::doClaim(r) = OrderCommand::cancel(i);
+        TRH::doCommit(r);
+    }
+
+    // Capped by max
+    std::span<const OrderCommand> batch = TRH::doPeekN(r,2);
+    REQUIRE(batch.size() == 2);
+    REQUIRE(batch.data() == &TRH::getBuffer(r)[5]);
+    REQUIRE(batch[1].orderID == 1);
+
+    // Stops at the end of the array, release only what was used
+    batch = TRH::doPeekN(r,16);
+    REQUIRE(batch.size() == 3);
+    TRH::doReleaseN(r,2);
+    REQUIRE(TRH::getHead(r) == 7);
+
+    batch = TRH::doPeekN(r,16);
+    REQUIRE(batch.size() == 1);
+    REQUIRE(batch[0].orderID == 2);
+    TRH::doReleaseN(r,1);
+
+    // Then carries on from the front
+    batch = TRH::doPeekN(r,16);
+    REQUIRE(batch.size() == 3);
+    REQUIRE(batch[0].orderID == 3);
+    TRH::doReleaseN(r,3);
+    REQUIRE(TRH::doPeekN(r,16).empty());
+}
+
+TEST_CASE("Ring: head and tail sit on separate cache lines", "[Ring]") {
+    REQUIRE(TestRingHelper<Order,8>::indexDistance() >= cacheLine);
+}
@@ -0,0 +1,181 @@
+// Unit tests for the PipelineRuntime, thread pinning, node local memory and the per thread counters
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/Book.hpp"
+#include "structures/OrderCommand.hpp"
+#include "structures/PerfCounters.hpp"
+#include "structures/PreTrade.hpp"
+#include "structures/Runtime.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Happy path test - A thread pinned to CPU 0 runs there, CPUs that don't exist are refused
+TEST_CASE("pinCurrentThread: Pins to an allowed CPU and refuses others","[Runtime]"){
+    //Results are recorded on the thread and checked here, assertions aren't thread safe
+    bool pinned = false, refusedNegative = false, refusedMissing = false;
+    int cpu = -1, node = -1, cpuAfterRefusal = -1;
+    std::jthread([&] {
+        pinned = pinCurrentThread(0);
+        cpu = currentCpu();
+        node = currentNode();
+        refusedNegative = !pinCurrentThread(-1);
+        refusedMissing = !pinCurrentThread(1'000'000);
+        cpuAfterRefusal = currentCpu();
+    }).join();
+
+    REQUIRE(pinned);
+    REQUIRE(cpu == 0);
+    REQUIRE(node >= 0);
+    REQUIRE(refusedNegative);
+    REQUIRE(refusedMissing);
+    //A refused pin leaves the old one in place
+    REQUIRE(cpuAfterRefusal == 0);
+}
+
+//Happy path test - Regions are page aligned and writable whichever pages they got
+TEST_CASE("NodeRegion: Maps writable memory, falling back from huge pages","[Runtime]"){
+    const std::size_t bytes = (std::size_t{3} << 20) + 100;
+    const NodeRegion huge(bytes, currentNode(), true);
+    const NodeRegion small(bytes, -1, false);
+
+    REQUIRE(small.pages() == PageKind::SMALL);
+    REQUIRE(reinterpret_cast<uintptr_t>(small.data()) % 4096 == 0);
+    if (huge.pages() != PageKind::SMALL) {REQUIRE(reinterpret_cast<uintptr_t>(huge.data()) % (1 << 21) == 0);}
+
+    for (const NodeRegion* r : {&huge, &small}) {
+        REQUIRE(r->size() == bytes);
+        auto* p = static_cast<unsigned char*>(r->data());
+        REQUIRE(p[0] == 0);
+        REQUIRE(p[bytes - 1] == 0);
+        p[0] = 1;
+        p[bytes - 1] = 2;
+        REQUIRE(p[0] + p[bytes - 1] == 3);
+    }
+}
+
+//Happy path test - Commands through the runtime's threads leave the Book as applying them directly does
+TEST_CASE("PipelineRuntime: Matches as a Book on one thread does","[Runtime][Threads]"){
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> pick(0,9);
+    std::uniform_int_distribution<int> level(0,20);
+    std::uniform_int_distribution<int> size(1,50);
+    std::vector<OrderCommand> cmds;
+    for (int id = 0; id < 5'000; ++id) {
+        const Side side = id % 2 ? Side::SELL : Side::BUY;
+        const double price = 5 + (side == Side::SELL ? 0.01 : -0.01) * (level(gen) - 3);
+        const int k = pick(gen);
+        if (k < 6) {cmds.push_back(OrderCommand::limit(id,side,size(gen),price));}
+        else if (k < 7) {cmds.push_back(OrderCommand::market(id,side,size(gen)));}
+        else {cmds.push_back(OrderCommand::cancel(id / 2));}
+    }
+
+    Book direct({.maxOrders = 1'024});
+    for (const OrderCommand& c : cmds) {direct.apply(c);}
+
+    PipelineRuntime<DefaultPolicy, BusySpin, 64> rt({.ingestCpu = 0, .matchCpu = 0, .book = {.maxOrders = 1'024}});
+    REQUIRE(rt.book() == nullptr);
+    const RuntimeReport report = rt.run(
+        [&](auto& q) {
+            for (const OrderCommand& c : cmds) {q.push_wait(c);}
+        },
+        [&](auto& q, Book& b) {
+            for (std::size_t received = 0; received < cmds.size();) {
+                const auto batch = q.peek_n_wait(16);
+                b.apply(batch);
+                q.release_n(batch.size());
+                received += batch.size();
+            }
+        });
+
+    REQUIRE(report.ingestPinned);
+    REQUIRE(report.matchPinned);
+    REQUIRE(report.matchNode >= 0);
+    REQUIRE(rt.book() != nullptr);
+    REQUIRE(rt.book()->size() == direct.size());
+    REQUIRE(rt.book()->lastSeq() == direct.lastSeq());
+    REQUIRE(rt.book()->lastPrice() == direct.lastPrice());
+}
+
+//Happy path test - The matching thread journals only what passes pre-trade, and the next run starts from the journal
+TEST_CASE("PipelineRuntime: Journals accepted commands and recovers them","[Runtime][Threads][Journal]"){
+    const std::string path = (std::filesystem::temp_directory_path() / "testRuntimeJournal.log").string();
+    std::remove(path.c_str());
+
+    //Every third command has a quantity the check refuses
+    std::vector<OrderCommand> cmds;
+    for (int id = 0; id < 300; ++id) {
+        const Side side = id % 2 ? Side::SELL : Side::BUY;
+        const double price = 5 + (side == Side::SELL ? 0.01 : -0.01) * (1 + id % 7);
+        cmds.push_back(OrderCommand::limit(id,side,id % 3 ? 10 : 0,price));
+    }
+
+    const PreTradeCheck risk;
+    Book direct({.maxOrders = 1'024});
+    uint64_t accepted = 0;
+    for (const OrderCommand& c : cmds) {
+        if (risk.check(c,direct) != RejectReason::NONE) {continue;}
+        direct.apply(c);
+        ++accepted;
+    }
+
+    const RuntimeConfig cfg{.book = {.maxOrders = 1'024}, .journal = path, .journalSync = false};
+    PipelineRuntime<DefaultPolicy, BusySpin, 64> rt(cfg);
+    bool gotJournal = false;
+    const RuntimeReport first = rt.run(
+        [&](auto& q) {
+            for (const OrderCommand& c : cmds) {q.push_wait(c);}
+        },
+        [&](auto& q, Book& b, Journal* journal) {
+            gotJournal = journal != nullptr;
+            for (std::size_t received = 0; received < cmds.size(); ++received) {
+                const OrderCommand c = *q.peek_wait();
+                q.release();
+                if (risk.check(c,b) != RejectReason::NONE) {continue;}
+                if (journal) {journal->append(c);}
+                b.apply(c);
+            }
+        });
+    REQUIRE(gotJournal);
+    REQUIRE(first.recovered == 0);
+    REQUIRE(rt.book()->size() == direct.size());
+    REQUIRE(JournalReader(path).size() == accepted);
+
+    //Nothing new comes in, the Book is rebuilt from the journal alone
+    const RuntimeReport second = rt.run([](auto&) {}, [](auto&, Book&) {});
+    REQUIRE(second.recovered == accepted);
+    REQUIRE(rt.book()->size() == direct.size());
+    REQUIRE(rt.book()->lastSeq() == direct.lastSeq());
+    for (const Side side : {Side::BUY, Side::SELL}) {
+        std::array<Book::DepthLevel,8> got{}, want{};
+        REQUIRE(rt.book()->depth(side,got) == direct.depth(side,want));
+        for (std::size_t i = 0; i < got.size(); ++i) {
+            REQUIRE(got[i].price == want[i].price);
+            REQUIRE(got[i].quantity == want[i].quantity);
+            REQUIRE(got[i].orders == want[i].orders);
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+//Edge case - Counters that can't be opened read -1, the ones that can count this thread only
+TEST_CASE("ThreadCounters: Count the thread or read -1","[Runtime]"){
+    ThreadCounters counters;
+    counters.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5)); //Sleeping switches the thread out at least once
+    const CounterValues v = counters.stop();
+
+    REQUIRE(v.dtlbMisses >= -1);
+    REQUIRE(v.migrations >= -1);
+    if (v.contextSwitches != -1) {REQUIRE(v.contextSwitches >= 1);}
+    REQUIRE(counters.available() == (v.dtlbMisses != -1 || v.migrations != -1 || v.contextSwitches != -1));
+}
@@ -0,0 +1,191 @@
+// Unit tests for SharedSpscQ, orders passing between mappings, layout checks, role claims and crashed peers
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/OrderCommand.hpp"
+#include "structures/SharedQ.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Shared = SharedSpscQ<OrderCommand,1'024>;
+
+std::string segmentName(const std::string& test){
+    //Unique per run so a failed run's leftovers don't get in the way
+    return "testSharedQ" + test + std::to_string(::getpid());
+}
+
+}
+
+//Happy path test - Both sides map the segment at different addresses and orders pass through in order
+TEST_CASE("SharedSpscQ: Orders pass from producer to consumer","[SharedQ]"){
+    const std::string name = segmentName("Pass");
+    Shared producer(name,SharedRole::PRODUCER);
+    Shared consumer(name,SharedRole::CONSUMER);
+    REQUIRE(&producer.queue() != &consumer.queue());
+    REQUIRE(producer.peer() == PeerState::ALIVE);
+    REQUIRE(consumer.peer() == PeerState::ALIVE);
+
+    for (int id = 1; id <= 2'000; ++id) {
+        if (id % 2) {
+            OrderCommand* slot = producer.queue().claim();
+            REQUIRE(slot != nullptr);
+            *slot = OrderCommand::limit(id,Side::BUY,id,5.0);
+            producer.queue().commit();
+        } else {
+            REQUIRE(producer.queue().push(OrderCommand::market(id,Side::SELL,id)));
+        }
+        const OrderCommand* c = consumer.queue().peek();
+        REQUIRE(c != nullptr);
+        REQUIRE(c->orderID == id);
+        REQUIRE(c->qty == id);
+        consumer.queue().release();
+    }
+    REQUIRE(consumer.queue().peek() == nullptr);
+
+    consumer.detach();
+    REQUIRE(producer.peer() == PeerState::DETACHED);
+    SharedSegment::remove(name);
+}
+
+//Edge case - A segment built for another queue type, or another version, is refused
+TEST_CASE("SharedSpscQ: Refuses a segment of another layout or version","[SharedQ]"){
+    const std::string name = segmentName("Layout");
+    {
+        Shared producer(name,SharedRole::PRODUCER);
+        REQUIRE_THROWS_AS((SharedSpscQ<OrderCommand,2'048>(name,SharedRole::CONSUMER)), std::runtime_error);
+        REQUIRE_THROWS_AS((SharedSpscQ<OrderCommand,1'024,SharedFutexWait<>>(name,SharedRole::CONSUMER)),
+                          std::runtime_error);
+    }
+    {
+        SharedSegment raw(name,sizeof(SharedQHeader));
+        REQUIRE_FALSE(raw.created());
+        static_cast<SharedQHeader*>(raw.data())->version = sharedQVersion + 1;
+    }
+    REQUIRE_THROWS_AS(Shared(name,SharedRole::CONSUMER), std::runtime_error);
+    SharedSegment::remove(name);
+}
+
+//Edge case - Each role is held once, and is free again after a detach
+TEST_CASE("SharedSpscQ: A role can only be attached once","[SharedQ]"){
+    const std::string name = segmentName("Role");
+    {
+        Shared first(name,SharedRole::PRODUCER);
+        REQUIRE_THROWS_AS(Shared(name,SharedRole::PRODUCER), std::runtime_error);
+        first.detach();
+        Shared second(name,SharedRole::PRODUCER);
+        Shared consumer(name,SharedRole::CONSUMER);
+        REQUIRE(consumer.peerAttaches() == 2);
+    }
+    SharedSegment::remove(name);
+}
+
+//Happy path test - A producer process that exits without detaching shows as crashed, what it sent is still there,
+//and a new producer can take over
+TEST_CASE("SharedSpscQ: Detects a crashed peer","[SharedQ]"){
+    const std::string name = segmentName("Crash");
+    Shared consumer(name,SharedRole::CONSUMER);
+    REQUIRE(consumer.peer() == PeerState::DETACHED);
+
+    const pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        //Attach, send three orders and die without detaching
+        Shared producer(name,SharedRole::PRODUCER);
+        for (int id = 1; id <= 3; ++id) {producer.queue().push(OrderCommand::limit(id,Side::BUY,10,5.0));}
+        ::_exit(0);
+    }
+    int status = 0;
+    REQUIRE(::waitpid(child,&status,0) == child);
+
+    REQUIRE(consumer.peer() == PeerState::CRASHED);
+    for (int id = 1; id <= 3; ++id) {
+        const std::optional<OrderCommand> c = consumer.queue().pop();
+        REQUIRE(c.has_value());
+        REQUIRE(c->orderID == id);
+    }
+
+    Shared replacement(name,SharedRole::PRODUCER);
+    REQUIRE(consumer.peer() == PeerState::ALIVE);
+    REQUIRE(consumer.peerAttaches() == 2);
+    SharedSegment::remove(name);
+}
+
+//Edge case - Processes racing to replace a crashed peer: exactly one gets the role
+TEST_CASE("SharedSpscQ: One of several takeovers wins","[SharedQ]"){
+    const std::string name = segmentName("Takeover");
+    Shared consumer(name,SharedRole::CONSUMER);
+    const pid_t crashed = ::fork();
+    REQUIRE(crashed >= 0);
+    if (crashed == 0) {
+        Shared producer(name,SharedRole::PRODUCER);
+        ::_exit(0);
+    }
+    REQUIRE(::waitpid(crashed,nullptr,0) == crashed);
+    REQUIRE(consumer.peer() == PeerState::CRASHED);
+
+    //Each child waits for go, tries the role, then holds whatever it got until done closes
+    int go[2];
+    int done[2];
+    REQUIRE(::pipe(go) == 0);
+    REQUIRE(::pipe(done) == 0);
+    constexpr int racers = 6;
+    pid_t children[racers];
+    for (pid_t& child : children) {
+        child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            ::close(go[1]);
+            ::close(done[1]);
+            char c = 0;
+            while (::read(go[0],&c,1) < 0) {}
+            int won = 0;
+            try {
+                Shared producer(name,SharedRole::PRODUCER);
+                won = 1;
+                while (::read(done[0],&c,1) < 0) {}
+                producer.detach();
+            } catch (const std::runtime_error&) {}
+            ::_exit(won);
+        }
+    }
+    ::close(go[0]);
+    ::close(done[0]);
+    const char start[racers] = {};
+    REQUIRE(::write(go[1],start,racers) == racers);
+    ::usleep(200'000);
+    ::close(done[1]);
+    ::close(go[1]);
+
+    int winners = 0;
+    for (const pid_t child : children) {
+        int status = 0;
+        REQUIRE(::waitpid(child,&status,0) == child);
+        REQUIRE(WIFEXITED(status));
+        winners += WEXITSTATUS(status);
+    }
+    REQUIRE(winners == 1);
+    REQUIRE(consumer.peer() == PeerState::DETACHED);
+    REQUIRE(consumer.peerAttaches() == 2);
+    SharedSegment::remove(name);
+}
+
+TEST_CASE("processAlive: Tells this process from a stale ID","[SharedQ]"){
+    const ProcessId self = currentProcess();
+    REQUIRE(processAlive(self));
+    REQUIRE_FALSE(processAlive({self.pid, self.started + 1}));
+    REQUIRE_FALSE(processAlive({0, 0}));
+
+    //Packed into one claim word
+    REQUIRE(processAlive(packProcess(self)));
+    REQUIRE_FALSE(processAlive(packProcess({self.pid, self.started + 1})));
+    REQUIRE_FALSE(processAlive(uint64_t{0}));
+    REQUIRE(packProcess(self) >> 32 == static_cast<uint64_t>(self.pid));
+    REQUIRE(std::string(toString(PeerState::CRASHED)) == "CRASHED");
+}
@@ -0,0 +1,48 @@
+// Unit tests for levelsCleared, the prefix sum that sizes a sweep across price levels
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/Sweep.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+//Happy path test - Levels taken in full are counted, the one an order only part fills is not
+TEST_CASE("levelsCleared: Counts the levels an order takes in full","[Sweep]"){
+    const std::vector<int64_t> qty = {10, 20, 5, 40, 1, 1, 7, 3, 9};
+
+    REQUIRE(levelsCleared({}, 100) == 0);
+    REQUIRE(levelsCleared(qty, 0) == 0);
+    REQUIRE(levelsCleared(qty, 9) == 0);
+    //Exactly a level's worth clears it
+    REQUIRE(levelsCleared(qty, 10) == 1);
+    REQUIRE(levelsCleared(qty, 34) == 2);
+    REQUIRE(levelsCleared(qty, 35) == 3);
+    //Across the four level blocks
+    REQUIRE(levelsCleared(qty, 76) == 5);
+    REQUIRE(levelsCleared(qty, 77) == 6);
+    REQUIRE(levelsCleared(qty, 86) == 7);
+    REQUIRE(levelsCleared(qty, 87) == 8);
+    REQUIRE(levelsCleared(qty, 96) == 9);
+    REQUIRE(levelsCleared(qty, 1'000'000) == 9);
+}
+
+//Happy path test - Matches a running total level by level, for any length and any block alignment
+TEST_CASE("levelsCleared: Agrees with a running total","[Sweep]"){
+    std::mt19937_64 gen(3);
+    std::uniform_int_distribution<int64_t> size(1, 1'000'000);
+    for (int trial = 0; trial < 2'000; ++trial) {
+        std::vector<int64_t> qty(gen() % 20);
+        for (auto& q : qty) {q = size(gen);}
+        const auto want = static_cast<int64_t>(gen() % (1'000'000 * qty.size() + 1));
+
+        std::size_t expected = 0;
+        for (int64_t total = 0; expected < qty.size() && (total += qty[expected]) <= want;) {++expected;}
+        REQUIRE(levelsCleared(qty, want) == expected);
+        REQUIRE(levelsClearedScalar(qty, want) == expected);
+#if defined(__x86_64__)
+        if (hasAvx2) {REQUIRE(levelsClearedAvx2(qty, want) == expected);}
+#endif
+    }
+}
@@ -5,11 +5,15 @@
 
 #include "structures/SpscQ.hpp"
 #include "structures/Order.hpp"
+#include "structures/OrderCommand.hpp"
 
 #include <iostream>
 #include <random>
 #include <optional>
 #include <thread>
+#include <array>
+#include <algorithm>
+#include <span>
 
 TEST_CASE("SpscQ: handles concurrent push/pop correctly", "[SpscQ][Threads]") {
     SpscQ<Order,1024> sq;
@@ -40,4 +44,68 @@ TEST_CASE("SpscQ: handles concurrent push/pop correctly", "[SpscQ][Threads]") {
 
     // Expect total quantity to be a multiple of 10  since (10 units × n pushes)
     REQUIRE(realSum%10 == 0);
-}
\ No newline at end of file
+}
+TEST_CASE("SpscQ: batch push/pop keeps every order in sequence", "[SpscQ][Threads]") {
+    SpscQ<Order,64> sq;
+    constexpr int n = 20'000;
+
+    //Producer pushes ids 0..n-1 in batches of up to 16
+    std::jthread producer([&] {
+        std::array<Order,16> batch;
+        int next = 0;
+        while (next < n) {
+            const int size = std::min(16, n - next);
+            for (int i = 0; i < size; ++i) {batch[i] = {next + i, Side::BUY, OrderType::LIMIT, 1};}
+            int sent = 0;
+            while (sent < size) {
+                sent += static_cast<int>(sq.push_n(std::span<const Order>(batch.data() + sent, size - sent)));
+            }
+            next += size;
+        }
+    });
+
+    //Consumer checks ids arrive exactly once and in order
+    int expected = 0;
+    bool inOrder = true;
+    std::array<Order,16> out;
+    while (expected < n) {
+        const size_t got = sq.pop_n(out);
+        for (size_t i = 0; i < got; ++i) {
+            inOrder = inOrder && out[i].getID() == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+
+    REQUIRE(inOrder);
+    REQUIRE(!sq.pop().has_value());
+}
+TEST_CASE("SpscQ: claim/commit and peek/release pass commands in place", "[SpscQ][Threads]") {
+    SpscQ<OrderCommand,64> sq;
+    constexpr int n = 20'000;
+
+    //Producer writes each command straight into its slot
+    std::jthread producer([&] {
+        for (int i = 0; i < n; ++i) {
+            OrderCommand* slot = nullptr;
+            while ((slot = sq.claim()) == nullptr) {}
+            *slot = OrderCommand::limit(i, Side::BUY, i, 5.0);
+            sq.commit();
+        }
+    });
+
+    //Consumer reads each slot in place before handing it back
+    int expected = 0;
+    bool inOrder = true;
+    while (expected < n) {
+        if (const OrderCommand* c = sq.peek()) {
+            inOrder = inOrder && c->orderID == expected && c->qty == expected;
+            sq.release();
+            ++expected;
+        }
+    }
+    producer.join();
+
+    REQUIRE(inOrder);
+    REQUIRE(sq.peek() == nullptr);
+}
@@ -0,0 +1,104 @@
+// Unit tests for the queue wait strategies, the blocking SpscQ calls under each one and the futex sleep
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "structures/OrderCommand.hpp"
+#include "structures/SpscQ.hpp"
+#include "structures/WaitStrategy.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+namespace {
+    double threadCpuSeconds() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+    }
+}
+
+//Happy path test - Every strategy passes each order exactly once and in order, through a ring small enough that
+//both sides wait, the producer for space and the consumer for orders
+TEMPLATE_TEST_CASE("SpscQ: Blocking calls pass every order under each wait strategy", "[Wait][Threads]",
+                   BusySpin, PauseSpin, SpinThenYield<>, FutexWait<>, FutexWait<0>, SharedFutexWait<>) {
+    SpscQ<OrderCommand,64,TestType> sq;
+    constexpr int n = 20'000;
+
+    //Alternates the copying and in place calls
+    std::jthread producer([&] {
+        for (int i = 0; i < n; ++i) {
+            if (i % 2 == 0) {sq.push_wait(OrderCommand::limit(i, Side::BUY, i, 5.0));}
+            else {
+                *sq.claim_wait() = OrderCommand::limit(i, Side::BUY, i, 5.0);
+                sq.commit();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool inOrder = true;
+    while (expected < n) {
+        if (expected % 3 == 0) {
+            inOrder = inOrder && sq.pop_wait().orderID == expected;
+            ++expected;
+        } else if (expected % 3 == 1) {
+            inOrder = inOrder && sq.peek_wait()->orderID == expected;
+            sq.release();
+            ++expected;
+        } else {
+            const auto batch = sq.peek_n_wait(8);
+            for (const OrderCommand& c : batch) {inOrder = inOrder && c.orderID == expected++;}
+            sq.release_n(batch.size());
+        }
+    }
+    producer.join();
+
+    REQUIRE(inOrder);
+    REQUIRE(expected == n);
+    REQUIRE(sq.peek() == nullptr);
+}
+
+//Happy path test - A futex waiter with nothing to do sleeps rather than spins, and the next push wakes it
+TEST_CASE("FutexWait: An idle consumer sleeps until a push wakes it", "[Wait][Threads]") {
+    SpscQ<OrderCommand,64,FutexWait<>> sq;
+    double cpu = 0;
+    int got = -1;
+
+    std::jthread consumer([&] {
+        const double before = threadCpuSeconds();
+        got = sq.pop_wait().orderID;
+        cpu = threadCpuSeconds() - before;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    sq.push(OrderCommand::cancel(42));
+    consumer.join();
+
+    REQUIRE(got == 42);
+    //A spinning consumer would use most of the 200ms
+    REQUIRE(cpu < 0.05);
+}
+
+//Happy path test - A full ring parks the producer the same way, and release wakes it
+TEST_CASE("FutexWait: A producer blocked on a full ring wakes when the consumer frees a slot", "[Wait][Threads]") {
+    SpscQ<OrderCommand,4,FutexWait<>> sq;
+    for (int i = 0; i < 3; ++i) {REQUIRE(sq.push(OrderCommand::cancel(i)));}
+    REQUIRE(!sq.push(OrderCommand::cancel(3)));
+
+    double cpu = 0;
+    std::jthread producer([&] {
+        const double before = threadCpuSeconds();
+        sq.push_wait(OrderCommand::cancel(3));
+        cpu = threadCpuSeconds() - before;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    REQUIRE(sq.peek()->orderID == 0);
+    sq.release();
+    producer.join();
+
+    REQUIRE(cpu < 0.05);
+    for (int i = 1; i < 4; ++i) {REQUIRE(sq.pop()->orderID == i);}
+}